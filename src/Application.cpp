@@ -6,30 +6,34 @@
 #include <imgui_internal.h>
 
 #include <backends/imgui_impl_sdl3.h>
+#include <algorithm>
 #include <backends/imgui_impl_sdlrenderer3.h>
-#include <httplib.h>
 #include <iostream>
 #include <string>
 
 #include "IconsFontAwesome6.h"
-#include "ai/ElevenLabsAudioProvider.h"
-#include "ai/GoogleTextProvider.h"
-#include "ai/MiniMaxAudioProvider.h"
-#include "ai/NativeAudioProvider.h"
-#include "ai/XAiTextProvider.h"
+#include "ai/IAudioAIProvider.h"
+#include "ai/ITextAIProvider.h"
 #include "api/AnkiConnectClient.h"
+#include "api/CardOutbox.h"
+#include "api/DuplicateIndex.h"
+#include "api/OutboxSync.h"
 #include "config/ConfigManager.h"
+#include "config/ServiceFactory.h"
 #include "core/Logger.h"
+#include "core/MainThreadDispatcher.h"
+#include "core/TaskExecutor.h"
+#include "core/Trace.h"
 #include "core/sdl/SDLWrappers.h"
 #include "language/JapaneseLanguage.h"
 #include "language/analyzer/SentenceAnalyzer.h"
 #include "language/audio/ForvoClient.h"
-#include "language/services/AITranslationService.h"
-#include "language/services/DeepLService.h"
-#include "language/services/GoogleTranslateService.h"
-#include "language/services/NoneTranslationService.h"
+#include "language/services/ILanguageService.h"
 #include "ocr/NativeOCRProvider.h"
+#include "ocr/OCRCache.h"
 #include "ocr/TesseractOCRProvider.h"
+#include "pipeline/CardPipeline.h"
+#include "pipeline/StageMemo.h"
 #include "stb_image.h"
 #include "ui/AnkiCardSettingsSection.h"
 #include "ui/ConfigurationSection.h"
@@ -40,6 +44,13 @@
 namespace Image2Card
 {
 
+  namespace
+  {
+    // Upper bounds for a whole scan or processing run, including every request it makes.
+    constexpr auto ScanTimeout = std::chrono::seconds(120);
+    constexpr auto ProcessTimeout = std::chrono::seconds(300);
+  } // namespace
+
   Application::Application(std::string title, int width, int height)
       : m_Title(std::move(title))
       , m_Width(width)
@@ -48,6 +59,7 @@ namespace Image2Card
       , m_Window(nullptr)
       , m_Renderer(nullptr)
       , m_BasePath("")
+      , m_MainThreadDispatcher(std::make_unique<Core::MainThreadDispatcher>())
   {}
 
   Application::~Application()
@@ -196,12 +208,12 @@ namespace Image2Card
     io.Fonts->AddFontFromFileTTF(iconFontPath.c_str(), iconFontSize, &icons_config, icons_ranges);
 
     char* prefPath = SDL_GetPrefPath("Image2Card", "AnkiImage2Card");
-    std::string configPath = "config.json";
+    std::string prefDirectory;
     if (prefPath) {
-      configPath = std::string(prefPath) + "config.json";
+      prefDirectory = prefPath;
       SDL_free(prefPath);
     }
-    m_ConfigManager = std::make_unique<Config::ConfigManager>(configPath);
+    m_ConfigManager = std::make_unique<Config::ConfigManager>(prefDirectory + "config.json");
 
     m_Languages.push_back(std::make_unique<Language::JapaneseLanguage>());
     std::string selectedLang = m_ConfigManager->GetConfig().SelectedLanguage;
@@ -215,74 +227,15 @@ namespace Image2Card
       m_ActiveLanguage = m_Languages[0].get();
     }
 
-    m_TextAIProviders.push_back(std::make_shared<AI::GoogleTextProvider>());
-    m_TextAIProviders.push_back(std::make_shared<AI::XAiTextProvider>());
-
-    for (auto& provider : m_TextAIProviders) {
-      nlohmann::json providerConfig;
-      if (provider->GetId() == "xai") {
-        providerConfig["api_key"] = m_ConfigManager->GetConfig().TextApiKey;
-        providerConfig["available_models"] = m_ConfigManager->GetConfig().TextAvailableModels;
-      } else if (provider->GetId() == "google") {
-        providerConfig["api_key"] = m_ConfigManager->GetConfig().GoogleApiKey;
-        providerConfig["available_models"] = m_ConfigManager->GetConfig().GoogleAvailableModels;
-      }
-      provider->LoadConfig(providerConfig);
-    }
-
     auto& config = m_ConfigManager->GetConfig();
-    if (config.AudioProvider == "native") {
-      m_AudioAIProvider = std::make_unique<AI::NativeAudioProvider>();
-    } else if (config.AudioProvider == "minimax") {
-      m_AudioAIProvider = std::make_unique<AI::MiniMaxAudioProvider>();
-    } else {
-      m_AudioAIProvider = std::make_unique<AI::ElevenLabsAudioProvider>();
-    }
-
-    m_TesseractOCRProvider = std::make_unique<OCR::TesseractOCRProvider>();
-    std::string tessDataPath = m_BasePath + "tessdata";
-    std::string tessLanguage = "jpn";
-    if (!m_TesseractOCRProvider->Initialize(tessDataPath, tessLanguage)) {
-      AF_WARN("Failed to initialize Tesseract OCR. AI OCR will be used as fallback.");
-    }
-
-    m_NativeOCRProvider = std::make_unique<OCR::NativeOCRProvider>();
-    if (m_NativeOCRProvider->IsInitialized()) {
-      AF_INFO("Native OCR provider initialized successfully");
-    } else {
-      AF_WARN("Native OCR provider not available on this platform");
-    }
-
-    {
-      nlohmann::json audioConfig;
-      auto& config = m_ConfigManager->GetConfig();
-
-      if (config.AudioProvider == "minimax") {
-        audioConfig["api_key"] = config.MiniMaxApiKey;
-        audioConfig["voice_id"] = config.MiniMaxVoiceId;
-        audioConfig["model"] = config.MiniMaxModel;
-
-        nlohmann::json voicesJson = nlohmann::json::array();
-        for (const auto& voice : config.MiniMaxAvailableVoices) {
-          voicesJson.push_back({voice.first, voice.second});
-        }
-        audioConfig["available_voices"] = voicesJson;
-      } else {
-        audioConfig["api_key"] = config.ElevenLabsApiKey;
-        audioConfig["voice_id"] = config.ElevenLabsVoiceId;
-
-        nlohmann::json voicesJson = nlohmann::json::array();
-        for (const auto& voice : config.ElevenLabsAvailableVoices) {
-          voicesJson.push_back({voice.first, voice.second});
-        }
-        audioConfig["available_voices"] = voicesJson;
-      }
+    m_TextAIProviders = Config::ServiceFactory::CreateTextProviders(config);
+    m_AudioAIProvider = Config::ServiceFactory::CreateAudioProvider(config, config.AudioProvider);
 
-      m_AudioAIProvider->LoadConfig(audioConfig);
-    }
+    // Only created here; its engines are loaded in the background (see StartBackgroundInitialization).
+    m_TesseractOCRProvider =
+        std::make_unique<OCR::TesseractOCRProvider>((size_t) std::max(0, config.TesseractEngineCount));
 
-    if (m_ConfigManager->GetConfig().SelectedVoiceModel.empty()) {
-      auto& config = m_ConfigManager->GetConfig();
+    if (config.SelectedVoiceModel.empty()) {
       if (config.AudioProvider == "minimax") {
         config.SelectedVoiceModel = "MiniMax/" + config.MiniMaxVoiceId;
       } else {
@@ -290,30 +243,7 @@ namespace Image2Card
       }
     }
 
-    auto noneService = std::make_unique<Language::Services::NoneTranslationService>();
-    m_LanguageServices.push_back(std::move(noneService));
-
-    auto deeplService = std::make_unique<Language::Services::DeepLService>();
-    nlohmann::json deeplConfig;
-    deeplConfig["api_key"] = m_ConfigManager->GetConfig().DeepLApiKey;
-    deeplConfig["use_free_api"] = m_ConfigManager->GetConfig().DeepLUseFreeAPI;
-    deeplConfig["source_lang"] = m_ConfigManager->GetConfig().DeepLSourceLang;
-    deeplConfig["target_lang"] = m_ConfigManager->GetConfig().DeepLTargetLang;
-    deeplService->LoadConfig(deeplConfig);
-    m_LanguageServices.push_back(std::move(deeplService));
-
-    auto googleTranslateService = std::make_unique<Language::Services::GoogleTranslateService>();
-    nlohmann::json googleConfig;
-    googleConfig["source_lang"] = "ja";
-    googleConfig["target_lang"] = "en";
-    googleTranslateService->LoadConfig(googleConfig);
-    m_LanguageServices.push_back(std::move(googleTranslateService));
-
-    for (auto& provider : m_TextAIProviders) {
-      auto aiTranslationService =
-          std::make_unique<Language::Services::AITranslationService>(provider, *m_ActiveLanguage);
-      m_LanguageServices.push_back(std::move(aiTranslationService));
-    }
+    m_LanguageServices = Config::ServiceFactory::CreateLanguageServices(config, m_TextAIProviders, *m_ActiveLanguage);
 
     AF_INFO("Language services initialized");
 
@@ -326,11 +256,7 @@ namespace Image2Card
     }
     m_SentenceAnalyzer->SetPreferredTranslator(selectedTranslator);
 
-    if (m_SentenceAnalyzer->Initialize(m_BasePath)) {
-      AF_INFO("Sentence analyzer initialized successfully");
-    } else {
-      AF_ERROR("Failed to initialize sentence analyzer");
-    }
+    StartBackgroundInitialization(prefDirectory);
 
     m_ForvoClient = std::make_unique<Language::Audio::ForvoClient>("ja", 10, 1);
     AF_INFO("Forvo audio client initialized");
@@ -339,6 +265,21 @@ namespace Image2Card
     if (ankiUrl.empty())
       ankiUrl = "http://localhost:8765";
     m_AnkiConnectClient = std::make_unique<API::AnkiConnectClient>(ankiUrl);
+    m_AnkiConnectClient->SetLocalMediaPaths(m_ConfigManager->GetConfig().AnkiLocalMediaPaths);
+    m_DuplicateIndex = std::make_unique<API::DuplicateIndex>(prefDirectory + "duplicate_index.json");
+    try {
+      m_OfflineOutbox = std::make_unique<API::CardOutbox>(prefDirectory + "outbox.db");
+    } catch (const std::exception& e) {
+      AF_WARN("{}; cards queued while Anki is unreachable will not survive a restart", e.what());
+      m_OfflineOutbox = std::make_unique<API::CardOutbox>();
+    }
+    try {
+      m_StagingOutbox = std::make_unique<API::CardOutbox>(prefDirectory + "staged.db");
+    } catch (const std::exception& e) {
+      AF_WARN("{}; staged cards will not survive a restart", e.what());
+      m_StagingOutbox = std::make_unique<API::CardOutbox>();
+    }
+    m_OutboxSync = std::make_unique<API::OutboxSync>(m_AnkiConnectClient.get(), m_OfflineOutbox.get());
 
     m_ImageSection =
         std::make_unique<UI::ImageSection>(m_Renderer, &m_Languages, &m_ActiveLanguage, m_ConfigManager.get());
@@ -356,47 +297,32 @@ namespace Image2Card
       }
     });
 
-    m_ConfigurationSection->SetOnAudioProviderChangedCallback([this](const std::string& providerId) {
-      if (providerId == "native") {
-        m_AudioAIProvider = std::make_unique<AI::NativeAudioProvider>();
-      } else if (providerId == "minimax") {
-        m_AudioAIProvider = std::make_unique<AI::MiniMaxAudioProvider>();
-      } else {
-        m_AudioAIProvider = std::make_unique<AI::ElevenLabsAudioProvider>();
-      }
-
-      nlohmann::json audioConfig;
-      auto& config = m_ConfigManager->GetConfig();
-
-      if (providerId == "minimax") {
-        audioConfig["api_key"] = config.MiniMaxApiKey;
-        audioConfig["voice_id"] = config.MiniMaxVoiceId;
-        audioConfig["model"] = config.MiniMaxModel;
-
-        nlohmann::json voicesJson = nlohmann::json::array();
-        for (const auto& voice : config.MiniMaxAvailableVoices) {
-          voicesJson.push_back({voice.first, voice.second});
-        }
-        audioConfig["available_voices"] = voicesJson;
-      } else if (providerId == "elevenlabs") {
-        audioConfig["api_key"] = config.ElevenLabsApiKey;
-        audioConfig["voice_id"] = config.ElevenLabsVoiceId;
-
-        nlohmann::json voicesJson = nlohmann::json::array();
-        for (const auto& voice : config.ElevenLabsAvailableVoices) {
-          voicesJson.push_back({voice.first, voice.second});
-        }
-        audioConfig["available_voices"] = voicesJson;
+    m_ConfigurationSection->SetOnClearOCRCacheCallback([this]() {
+      // A cache that is still opening has nothing to clear yet.
+      if (!m_OCRCacheReadiness.IsReady()) {
+        return;
       }
+      Core::TaskExecutor::Get().Post(Core::TaskPriority::Batch, [this]() {
+        m_OCRCache->Clear();
+        AF_INFO("OCR cache cleared");
+      });
+      if (m_StatusSection)
+        m_StatusSection->SetStatus("OCR cache cleared.");
+    });
 
-      m_AudioAIProvider->LoadConfig(audioConfig);
+    m_ConfigurationSection->SetOnAudioProviderChangedCallback([this](const std::string& providerId) {
+      m_AudioAIProvider = Config::ServiceFactory::CreateAudioProvider(m_ConfigManager->GetConfig(), providerId);
       m_ConfigurationSection->SetAudioProvider(m_AudioAIProvider.get());
 
-      std::thread([this]() { m_AudioAIProvider->LoadRemoteVoices(); }).detach();
+      Core::TaskExecutor::Get().Post(Core::TaskPriority::Interactive,
+                                     [this]() { m_AudioAIProvider->LoadRemoteVoices(); });
     });
 
     m_AnkiCardSettingsSection =
         std::make_unique<UI::AnkiCardSettingsSection>(m_Renderer, m_AnkiConnectClient.get(), m_ConfigManager.get());
+    m_AnkiCardSettingsSection->SetDuplicateIndex(m_DuplicateIndex.get());
+    m_AnkiCardSettingsSection->SetOfflineOutbox(m_OfflineOutbox.get());
+    m_AnkiCardSettingsSection->SetStagingOutbox(m_StagingOutbox.get());
 
     m_ConfigurationSection->SetOnNoteTypeOrDeckChangedCallback([this]() {
       if (m_AnkiCardSettingsSection) {
@@ -410,38 +336,124 @@ namespace Image2Card
         m_StatusSection->SetStatus(msg);
     });
 
-    m_ConfigurationSection->SetOnConnectCallback([this]() {
-      if (m_AnkiCardSettingsSection) {
-        m_AnkiCardSettingsSection->RefreshData();
+    m_AnkiCardSettingsSection->SetOnProgressCallback([this](float progress) {
+      if (m_StatusSection)
+        m_StatusSection->SetProgress(progress);
+    });
+
+    m_AnkiCardSettingsSection->SetOnCardCommittedCallback([this]() {
+      if (m_WaitingForCardCommit) {
+        m_WaitingForCardCommit = false;
+        ShowNextScan();
       }
+    });
+
+    // Runs on the worker that pinged AnkiConnect; the section, outbox sync and status are main-thread state.
+    m_ConfigurationSection->SetOnConnectCallback([this]() {
       m_AnkiConnected.store(true);
-      if (m_StatusSection)
-        m_StatusSection->SetStatus("AnkiConnect: Connected");
+      m_MainThreadDispatcher->Post([this]() {
+        if (m_AnkiCardSettingsSection) {
+          m_AnkiCardSettingsSection->RefreshData();
+        }
+        if (m_OutboxSync)
+          m_OutboxSync->Wake();
+        if (m_StatusSection)
+          m_StatusSection->SetStatus("AnkiConnect: Connected");
+      });
     });
 
     m_ImageSection->SetOnScanCallback([this]() { OnScan(); });
-
-    std::thread([this]() {
-      if (m_AnkiConnectClient && m_AnkiConnectClient->Ping()) {
-        m_AnkiConnected.store(true);
+    m_ImageSection->SetOnScanPageCallback([this]() { OnScanPage(); });
+
+    Core::TaskExecutor::Get().Post(Core::TaskPriority::Interactive, [this]() {
+      bool connected = m_AnkiConnectClient && m_AnkiConnectClient->Ping();
+      m_AnkiConnected.store(connected);
+      m_MainThreadDispatcher->Post([this, connected]() {
+        if (!connected) {
+          if (m_StatusSection)
+            m_StatusSection->SetStatus("AnkiConnect: Not connected, cards will be queued until it is");
+          return;
+        }
         if (m_StatusSection)
           m_StatusSection->SetStatus("AnkiConnect: Connected");
         if (m_AnkiCardSettingsSection) {
           m_AnkiCardSettingsSection->RefreshData();
         }
-      } else {
-        m_AnkiConnected.store(false);
-        if (m_StatusSection)
-          m_StatusSection->SetStatus("AnkiConnect: Not connected (click Connect to retry)");
-      }
-    }).detach();
+      });
+    });
 
     return true;
   }
 
+  void Application::StartBackgroundInitialization(const std::string& prefDirectory)
+  {
+    // Each subsystem loads on its own worker while the window is already up, so
+    // startup takes as long as the slowest of them instead of their sum.
+    m_TesseractReadiness.Start([this]() -> std::string {
+      std::string tessDataPath = m_BasePath + "tessdata";
+      if (!m_TesseractOCRProvider->Initialize(tessDataPath, "jpn")) {
+        return "no jpn traineddata in " + tessDataPath + ", AI OCR will be used as fallback";
+      }
+      return "";
+    });
+
+    m_NativeOCRReadiness.Start([this]() -> std::string {
+      auto provider = std::make_unique<OCR::NativeOCRProvider>();
+      bool available = provider->IsInitialized();
+      m_NativeOCRProvider = std::move(provider);
+      return available ? "" : "not available on this platform";
+    });
+
+    size_t cacheBytes = (size_t) std::max(1, m_ConfigManager->GetConfig().OCRCacheSizeMB) * 1024 * 1024;
+    m_OCRCacheReadiness.Start([this, path = prefDirectory + "ocr_cache.db", cacheBytes]() -> std::string {
+      m_OCRCache = std::make_unique<OCR::OCRCache>(path, cacheBytes);
+      return "";
+    });
+
+    // MeCab's dictionary and both SQLite databases.
+    m_AnalyzerReadiness.Start([this]() -> std::string {
+      return m_SentenceAnalyzer->Initialize(m_BasePath) ? "" : "MeCab could not be loaded, the AI model will analyze";
+    });
+  }
+
+  void Application::LogStartupProgress()
+  {
+    if (m_StartupLogged) {
+      return;
+    }
+
+    double sinceLaunch =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_LaunchTime).count();
+    if (!m_ScanReadyLogged) {
+      const std::string& ocrMethod = m_ConfigManager->GetConfig().OCRMethod;
+      Core::Readiness* engine = ocrMethod == "AI"       ? nullptr
+                                : ocrMethod == "Native" ? &m_NativeOCRReadiness
+                                                        : &m_TesseractReadiness;
+      if (!engine || engine->GetState() != Core::ReadyState::Loading) {
+        AF_INFO("Startup: scan ready {:.0f} ms after launch ({} OCR)", sinceLaunch, ocrMethod);
+        m_ScanReadyLogged = true;
+      }
+    }
+
+    const Core::Readiness* subsystems[] = {
+        &m_TesseractReadiness, &m_NativeOCRReadiness, &m_OCRCacheReadiness, &m_AnalyzerReadiness};
+    std::string summary;
+    for (const Core::Readiness* subsystem : subsystems) {
+      if (subsystem->GetState() == Core::ReadyState::Loading) {
+        return;
+      }
+      summary += (summary.empty() ? "" : ", ") + subsystem->GetName() + " " +
+                 std::to_string((int) subsystem->GetMilliseconds()) + " ms" +
+                 (subsystem->IsFailed() ? " (failed)" : "");
+    }
+    AF_INFO("Startup: everything loaded {:.0f} ms after launch ({})", sinceLaunch, summary);
+    m_StartupLogged = true;
+  }
+
   void Application::Shutdown()
   {
     CancelAsyncTasks();
+    Core::TaskExecutor::Get().Shutdown();
 
     m_StatusSection.reset();
     m_AnkiCardSettingsSection.reset();
@@ -452,8 +464,14 @@ namespace Image2Card
     m_TextAIProviders.clear();
     m_Languages.clear();
     m_ConfigManager.reset();
+    m_OutboxSync.reset();
+    m_OfflineOutbox.reset();
+    m_StagingOutbox.reset();
+    m_DuplicateIndex.reset();
     m_AnkiConnectClient.reset();
 
+    ReleaseScanTexture();
+
     ImGui_ImplSDLRenderer3_Shutdown();
     ImGui_ImplSDL3_Shutdown();
     ImGui::DestroyContext();
@@ -500,6 +518,22 @@ namespace Image2Card
   void Application::Update()
   {
     UpdateAsyncTasks();
+    if (m_AnkiCardSettingsSection) {
+      m_AnkiCardSettingsSection->Update();
+    }
+    if (m_OutboxSync) {
+      auto attempt = m_OutboxSync->Poll();
+      if (attempt) {
+        m_AnkiConnected.store(attempt->reachable);
+        if (attempt->report.rejected > 0 && m_StatusSection) {
+          m_StatusSection->SetStatus("Anki rejected " + std::to_string(attempt->report.rejected) +
+                                     " queued card(s): " + attempt->report.rejectedError);
+        } else if (attempt->report.added > 0 && m_StatusSection) {
+          m_StatusSection->SetStatus("Sent " + std::to_string(attempt->report.added) + " queued card(s) to Anki");
+        }
+      }
+    }
+    LogStartupProgress();
   }
 
   void Application::Render()
@@ -519,6 +553,12 @@ namespace Image2Card
 
     ImGui_ImplSDLRenderer3_RenderDrawData(ImGui::GetDrawData(), m_Renderer);
     SDL_RenderPresent(m_Renderer);
+
+    if (!m_FirstFrameShown) {
+      m_FirstFrameShown = true;
+      AF_INFO("Startup: first frame {:.0f} ms after launch",
+              std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_LaunchTime).count());
+    }
   }
 
   void Application::RenderUI()
@@ -631,160 +671,237 @@ namespace Image2Card
 
   AI::ITextAIProvider* Application::GetTextProviderForModel(const std::string& modelLabel)
   {
-    if (modelLabel.empty()) {
-      if (!m_TextAIProviders.empty())
-        return m_TextAIProviders[0].get();
-      return nullptr;
-    }
-
-    std::string providerName;
-    size_t slashPos = modelLabel.find('/');
-    if (slashPos != std::string::npos) {
-      providerName = modelLabel.substr(0, slashPos);
-    }
-
-    for (auto& provider : m_TextAIProviders) {
-      if (providerName == "xAI" && provider->GetId() == "xai")
-        return provider.get();
-      if (providerName == "Google" && provider->GetId() == "google")
-        return provider.get();
-    }
-
-    if (!m_TextAIProviders.empty())
-      return m_TextAIProviders[0].get();
-    return nullptr;
+    return Config::ServiceFactory::FindTextProvider(m_TextAIProviders, modelLabel);
   }
 
-  void Application::OnScan()
+  void Application::OnScanPage()
   {
-    if (m_IsScanning.load()) {
-      AF_WARN("Scan already in progress, ignoring request.");
+    size_t regions = m_ImageSection->DetectTextRegions();
+    AF_INFO("Scan Page: {} text region(s) detected", regions);
+    if (regions == 0) {
       if (m_StatusSection)
-        m_StatusSection->SetStatus("Scan already in progress.");
+        m_StatusSection->SetStatus("Error: No text found on the page.");
       return;
     }
+    OnScan(true);
+  }
 
+  void Application::OnScan(bool wholePage)
+  {
     AF_INFO("Starting Scan...");
     if (m_StatusSection)
       m_StatusSection->SetStatus("Scanning image...");
 
-    {
-      std::lock_guard<std::mutex> lock(m_ResultMutex);
-      m_LastError.clear();
-      m_OCRResult.clear();
-    }
-
     if (!m_AnkiConnected.load()) {
-      if (m_StatusSection)
-        m_StatusSection->SetStatus("Error: Anki is not connected.");
-      AF_ERROR("Anki is not connected.");
-      return;
+      AF_WARN("Anki is not connected, cards from this scan will be queued");
     }
 
-    std::vector<unsigned char> imageBytes = m_ImageSection->GetSelectedImageBytes();
-    AF_INFO("Image selected, size: {} bytes", imageBytes.size());
+    std::string tesseractOrientation = m_ImageSection->GetTesseractOrientation();
+    auto crops = std::make_shared<std::vector<Utils::ImageBuffer>>(
+        m_ImageSection->GetSelectionImages(m_ImageSection->IsVerticalText()));
+    AF_INFO("{} region(s) selected", crops->size());
 
-    if (imageBytes.empty()) {
+    if (crops->empty()) {
       if (m_StatusSection)
         m_StatusSection->SetStatus("Error: No image selected.");
       AF_ERROR("No image selected.");
       return;
     }
 
-    m_IsScanning.store(true);
-    m_OCRComplete = false;
+    // Engine selection and provider configuration happen here, once, so the
+    // per-region OCR tasks below only read shared state.
+    auto& config = m_ConfigManager->GetConfig();
+    std::string ocrMethod = config.OCRMethod;
+    AI::ITextAIProvider* visionProvider = nullptr;
+
+    // Engines still loading in the background are waited for by the scan task; only
+    // one that failed to load is passed over.
+    bool tesseractReady = !m_TesseractReadiness.IsFailed();
+    bool nativeReady = !m_NativeOCRReadiness.IsFailed();
+    if (wholePage && ocrMethod == "AI" && tesseractReady) {
+      // A page has dozens of blocks; one vision request each would be slow and costly.
+      AF_INFO("Reading a whole page with Tesseract instead of the vision model");
+      ocrMethod = "Tesseract";
+    }
+    Core::Readiness* engine = nullptr;
+    OCR::TesseractOptions tesseractOptions;
+    if (ocrMethod == "Native" && nativeReady) {
+      AF_INFO("Using Native OS OCR");
+      engine = &m_NativeOCRReadiness;
+    } else if ((ocrMethod == "Tesseract" || ocrMethod == "Cascade") && tesseractReady) {
+      AF_INFO("Using {} OCR with orientation: {}", ocrMethod, tesseractOrientation);
+      engine = &m_TesseractReadiness;
+      tesseractOptions.orientation = OCR::ParseTesseractOrientation(tesseractOrientation);
+      tesseractOptions.preprocess = config.TesseractPreprocess;
+    } else {
+      ocrMethod = "AI";
+    }
+
+    if (ocrMethod == "AI" || ocrMethod == "Cascade") {
+      std::string selectedVisionModel = config.SelectedVisionModel;
+      visionProvider = GetTextProviderForModel(selectedVisionModel);
+      if (!visionProvider || !m_ActiveLanguage) {
+        if (m_StatusSection)
+          m_StatusSection->SetStatus("Error: No Text AI Provider found for selected vision model.");
+        AF_ERROR("No Text AI Provider found for selected vision model.");
+        return;
+      }
+
+      std::string modelName = selectedVisionModel;
+      size_t slashPos = modelName.find('/');
+      if (slashPos != std::string::npos) {
+        modelName = modelName.substr(slashPos + 1);
+      }
+      if (visionProvider->SaveConfig().value("vision_model", "") != modelName) {
+        nlohmann::json providerConfig;
+        providerConfig["vision_model"] = modelName;
+        visionProvider->LoadConfig(providerConfig);
+      }
+      if (ocrMethod == "AI") {
+        AF_INFO("Sending image to Text AI Provider for OCR...");
+      }
+    }
+
+    m_ImageUpload.SetOptimize(config.AIUploadOptimize);
+
+    OCR::CascadeOptions cascadeOptions;
+    cascadeOptions.minConfidence = config.CascadeMinConfidence;
+    cascadeOptions.hedgeDelay = std::chrono::milliseconds(config.CascadeHedgeDelayMs);
+
+    // Everything that changes what the regions are read as goes into the cache key.
+    // A cache that is still opening is skipped rather than waited for.
+    OCR::OCRCache* ocrCache = config.OCRCacheEnabled && m_OCRCacheReadiness.IsReady() ? m_OCRCache.get() : nullptr;
+    std::string cacheSettings = ocrMethod;
+    if (ocrMethod == "Tesseract" || ocrMethod == "Cascade") {
+      cacheSettings += ":" + tesseractOrientation + (config.TesseractPreprocess ? ":preprocessed" : ":raw");
+    }
+    if (ocrMethod == "AI" || ocrMethod == "Cascade") {
+      // A downscaled WebP/JPEG upload can read differently from the full-size PNG.
+      cacheSettings += ":" + config.SelectedVisionModel + (config.AIUploadOptimize ? ":optimized" : ":png");
+    }
+    if (ocrMethod == "Cascade") {
+      cacheSettings += ":" + std::to_string((int) config.CascadeMinConfidence);
+    }
+    if (ocrCache) {
+      ocrCache->SetMaxBytes((size_t) std::max(1, config.OCRCacheSizeMB) * 1024 * 1024);
+    }
+
+    m_ActiveScans.fetch_add(1);
 
     AF_INFO("Launching async OCR task...");
     if (m_StatusSection)
       m_StatusSection->SetProgress(0.0f);
 
-    std::vector<unsigned char> scanImage = imageBytes;
-
-    auto& config = m_ConfigManager->GetConfig();
-    std::string ocrMethod = config.OCRMethod;
-    std::string tesseractOrientation = m_ImageSection->GetTesseractOrientation();
-    std::string selectedVisionModel = config.SelectedVisionModel;
+    // Scans can overlap, so each one carries its own results and error.
+    auto texts = std::make_shared<std::vector<std::string>>(crops->size());
+    auto layouts = std::make_shared<std::vector<OCR::OCRResult>>(crops->size());
+    auto images = std::make_shared<std::vector<std::vector<unsigned char>>>(crops->size());
+    auto scanError = std::make_shared<std::string>();
 
     AsyncTask task;
     task.description = "OCR Image Processing";
-    task.future = std::async(
-        std::launch::async,
-        [this, imageBytes = std::move(imageBytes), ocrMethod, tesseractOrientation, selectedVisionModel]() {
-          try {
-            if (m_CancelRequested.load()) {
-              AF_INFO("OCR task cancelled before starting.");
-              return;
-            }
-
-            std::string text;
-
-            if (ocrMethod == "Native" && m_NativeOCRProvider && m_NativeOCRProvider->IsInitialized()) {
-              AF_INFO("Using Native OS OCR");
-              text = m_NativeOCRProvider->ExtractTextFromImage(imageBytes);
-            } else if (ocrMethod == "Tesseract" && m_TesseractOCRProvider && m_TesseractOCRProvider->IsInitialized()) {
-              AF_INFO("Using Tesseract OCR with orientation: {}", tesseractOrientation);
+    task.timeout = ScanTimeout;
+    task.work = [this,
+                 crops,
+                 texts,
+                 layouts,
+                 images,
+                 scanError,
+                 ocrMethod,
+                 visionProvider,
+                 engine,
+                 tesseractOptions,
+                 cascadeOptions,
+                 ocrCache,
+                 cacheSettings](const Core::CancellationToken& cancellation) {
+      if (cancellation.IsCancelled()) {
+        AF_INFO("OCR task cancelled before starting.");
+        return;
+      }
 
-              if (tesseractOrientation == "vertical") {
-                m_TesseractOCRProvider->SetOrientation(OCR::TesseractOrientation::Vertical);
-              } else {
-                m_TesseractOCRProvider->SetOrientation(OCR::TesseractOrientation::Horizontal);
-              }
+      if (engine && !engine->IsReady()) {
+        AF_INFO("Waiting for {} to finish loading", engine->GetName());
+        m_MainThreadDispatcher->Post([this, name = engine->GetName()]() {
+          if (m_StatusSection)
+            m_StatusSection->SetStatus("Waiting for " + name + " to load...");
+        });
+        if (!engine->Wait(cancellation)) {
+          if (!cancellation.IsCancelled()) {
+            *scanError = engine->GetName() + " failed to load: " + engine->GetFailureReason();
+          }
+          return;
+        }
+      }
 
-              text = m_TesseractOCRProvider->ExtractTextFromImage(imageBytes);
+      // Regions are independent, so they are recognized in parallel; a failed
+      // region is logged and skipped rather than failing the whole scan.
+      std::vector<std::string> errors(crops->size());
+      Pipeline::StageGraph graph;
+      for (size_t i = 0; i < crops->size(); ++i) {
+        graph.AddStage("ocr_" + std::to_string(i), {}, {"text_" + std::to_string(i)}, [&, i]() {
+          try {
+            auto region = (*crops)[i].View();
+            std::string cacheKey = ocrCache ? OCR::OCRCache::Key(region, cacheSettings) : "";
+            if (auto cached = ocrCache ? ocrCache->Get(cacheKey) : std::nullopt) {
+              (*layouts)[i] = std::move(*cached);
+              AF_INFO("OCR cache hit for region {}", i + 1);
             } else {
-              AF_INFO("Sending image to Text AI Provider for OCR...");
-              auto* provider = GetTextProviderForModel(selectedVisionModel);
-              if (!provider) {
-                throw std::runtime_error("No Text AI Provider found for selected vision model.");
+              // A low-confidence result kept only because the fallback failed is not worth remembering.
+              bool cacheable = true;
+              if (ocrMethod == "Cascade") {
+                auto outcome =
+                    RecognizeWithCascade(region, tesseractOptions, visionProvider, cascadeOptions, cancellation);
+                (*layouts)[i] = std::move(outcome.result);
+                cacheable = !outcome.provisional;
+              } else {
+                (*layouts)[i] = RecognizeText(region, ocrMethod, tesseractOptions, visionProvider, cancellation);
               }
-
-              std::string modelName = selectedVisionModel;
-              size_t slashPos = modelName.find('/');
-              if (slashPos != std::string::npos) {
-                modelName = modelName.substr(slashPos + 1);
+              if (ocrCache && cacheable && !(*layouts)[i].IsEmpty() && !cancellation.IsCancelled()) {
+                ocrCache->Put(cacheKey, (*layouts)[i]);
               }
-              nlohmann::json config;
-              config["vision_model"] = modelName;
-              provider->LoadConfig(config);
-
-              text = provider->ExtractTextFromImage(imageBytes, "image/png", *m_ActiveLanguage);
             }
-
+            (*texts)[i] = (*layouts)[i].Text();
             if (m_ActiveLanguage) {
-              text = m_ActiveLanguage->PostProcessOCR(text);
+              (*texts)[i] = m_ActiveLanguage->PostProcessOCR((*texts)[i]);
             }
-
-            AF_INFO("OCR Result: {}", text);
-
-            {
-              std::lock_guard<std::mutex> lock(m_ResultMutex);
-              m_OCRResult = std::move(text);
-              m_OCRComplete = true;
+            AF_INFO("OCR Result ({}/{}): {}", i + 1, crops->size(), (*texts)[i]);
+            // Only regions that become cards need a PNG.
+            if (!(*texts)[i].empty()) {
+              (*images)[i] = Utils::ImageProcessor::EncodePNG((*crops)[i].View());
             }
           } catch (const std::exception& e) {
-            AF_ERROR("OCR task failed with exception: {}", e.what());
-            std::lock_guard<std::mutex> lock(m_ResultMutex);
-            m_LastError = std::string("OCR failed: ") + e.what();
-          } catch (...) {
-            AF_ERROR("OCR task failed with unknown exception.");
-            std::lock_guard<std::mutex> lock(m_ResultMutex);
-            m_LastError = "OCR failed with unknown error.";
+            AF_ERROR("OCR failed for region {}: {}", i + 1, e.what());
+            errors[i] = e.what();
           }
         });
+      }
+      graph.SetCancellationCheck([&cancellation]() { return cancellation.IsCancelled(); });
+      graph.SetOnStageComplete([this](const std::string&, size_t completed, size_t total) {
+        m_MainThreadDispatcher->Post([this, progress = (float) completed / (float) total]() {
+          if (m_StatusSection)
+            m_StatusSection->SetProgress(progress);
+        });
+      });
+      graph.Run();
 
-    task.onComplete = [this, scanImage = std::move(scanImage)]() {
-      m_IsScanning.store(false);
-      if (m_StatusSection)
+      size_t failed = std::count_if(errors.begin(), errors.end(), [](const auto& e) { return !e.empty(); });
+      if (failed == errors.size()) {
+        *scanError = std::string("OCR failed: ") + errors.front();
+      }
+    };
+
+    task.onComplete = [this, crops, texts, layouts, images, scanError, ocrCache, wholePage]() {
+      if (m_ActiveScans.fetch_sub(1) == 1 && m_StatusSection)
         m_StatusSection->SetProgress(-1.0f);
 
-      std::string ocrResult;
-      std::string error;
-      {
-        std::lock_guard<std::mutex> lock(m_ResultMutex);
-        ocrResult = m_OCRResult;
-        error = m_LastError;
+      if (ocrCache) {
+        AF_INFO("OCR cache: {} hits, {} misses, {} KB",
+                ocrCache->GetHitCount(),
+                ocrCache->GetMissCount(),
+                ocrCache->GetSizeBytes() / 1024);
       }
 
+      const std::string& error = *scanError;
       if (!error.empty()) {
         if (m_StatusSection)
           m_StatusSection->SetStatus("Error: " + error);
@@ -792,56 +909,162 @@ namespace Image2Card
         return;
       }
 
-      if (ocrResult.empty()) {
-        if (m_StatusSection)
-          m_StatusSection->SetStatus("Error: OCR returned no text.");
-        AF_ERROR("OCR returned no text.");
-        return;
+      // A scan finishing while another one's regions are being reviewed joins that queue.
+      bool reviewing = m_ShowScanModal || m_OpenScanModal || m_WaitingForCardCommit || !m_PendingScans.empty();
+      if (!reviewing) {
+        m_PendingScans.clear();
+        m_ScanQueueSize = 0;
       }
 
-      m_ScanSentence = ocrResult;
-      m_ScanTargetWord = "";
+      // Results stay in reading order; each region becomes its own card, or for a
+      // whole page each sentence of a region does.
+      size_t added = 0;
+      for (size_t i = 0; i < texts->size(); ++i) {
+        if ((*texts)[i].empty()) {
+          continue;
+        }
 
-      auto& config = m_ConfigManager->GetConfig();
-      if (config.AudioProvider == "minimax") {
-        m_ScanVoice = config.MiniMaxVoiceId;
-      } else {
-        m_ScanVoice = config.ElevenLabsVoiceId;
+        PendingScan scan{std::move((*texts)[i]),
+                         std::move((*images)[i]),
+                         std::make_shared<const Utils::ImageBuffer>(std::move((*crops)[i])),
+                         std::make_shared<const OCR::OCRResult>(std::move((*layouts)[i]))};
+        std::vector<std::string> sentences = wholePage ? scan.ocr->Sentences() : std::vector<std::string>{};
+        if (sentences.size() < 2) {
+          m_PendingScans.push_back(std::move(scan));
+          ++added;
+          continue;
+        }
+        scan.split = true;
+        for (const std::string& sentence : sentences) {
+          scan.sentence = m_ActiveLanguage ? m_ActiveLanguage->PostProcessOCR(sentence) : sentence;
+          m_PendingScans.push_back(scan);
+          ++added;
+        }
       }
+      m_ScanQueueSize += added;
 
-      m_ScanSentence.reserve(256);
-      m_ScanTargetWord.reserve(64);
-      m_ScanVoice.reserve(64);
+      if (added == 0) {
+        if (m_StatusSection)
+          m_StatusSection->SetStatus("Error: OCR returned no text.");
+        AF_ERROR("OCR returned no text.");
+        return;
+      }
 
       if (m_StatusSection)
         m_StatusSection->SetStatus("Scan complete.");
-      AF_INFO("Scan complete.");
+      AF_INFO("Scan complete, {} region(s) with text.", added);
 
-      if (m_AnkiCardSettingsSection) {
-        m_AnkiCardSettingsSection->SetFieldByTool(7, scanImage, "image.png");
+      if (!reviewing) {
+        ShowNextScan();
       }
-
-      m_ShowScanModal = true;
-      m_OpenScanModal = true;
     };
 
     task.onError = [this](const std::string& error) {
-      m_IsScanning.store(false);
+      bool lastScan = m_ActiveScans.fetch_sub(1) == 1;
       if (m_StatusSection) {
         m_StatusSection->SetStatus("Error: " + error);
-        m_StatusSection->SetProgress(-1.0f);
+        if (lastScan)
+          m_StatusSection->SetProgress(-1.0f);
       }
       AF_ERROR("Scan error: {}", error);
     };
 
-    {
-      std::lock_guard<std::mutex> lock(m_TaskMutex);
-      m_ActiveTasks.push(std::move(task));
+    StartAsyncTask(std::move(task));
+  }
+
+  OCR::OCRResult Application::RecognizeText(const Utils::ImageView& image,
+                                            const std::string& ocrMethod,
+                                            const OCR::TesseractOptions& tesseractOptions,
+                                            AI::ITextAIProvider* visionProvider,
+                                            const Core::CancellationToken& cancellation)
+  {
+    // Local engines read the pixels; only the vision model needs an encoded image.
+    if (ocrMethod == "Native") {
+      return m_NativeOCRProvider->ExtractStructuredText(image);
     }
+    if (ocrMethod == "Tesseract") {
+      return m_TesseractOCRProvider->ExtractStructuredText(image, tesseractOptions);
+    }
+
+    // The vision model has no layout, so its text spans the whole region.
+    AI::PreparedImage upload = m_ImageUpload.PrepareFor(image, visionProvider->GetImageUploadLimits());
+    auto start = std::chrono::steady_clock::now();
+    std::string text =
+        visionProvider->ExtractTextFromImage(upload.bytes, upload.mimeType, *m_ActiveLanguage, cancellation);
+    m_ImageUpload.Record(upload,
+                         std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    return OCR::OCRResult::FromText(text, image.width, image.height);
+  }
+
+  OCR::OCRCascade::Outcome Application::RecognizeWithCascade(const Utils::ImageView& image,
+                                                             const OCR::TesseractOptions& tesseractOptions,
+                                                             AI::ITextAIProvider* visionProvider,
+                                                             const OCR::CascadeOptions& options,
+                                                             const Core::CancellationToken& cancellation)
+  {
+    auto local = [&](const Core::CancellationToken& token) {
+      return RecognizeText(image, "Tesseract", tesseractOptions, visionProvider, token);
+    };
+    auto fallback = [&](const Core::CancellationToken& token) {
+      return RecognizeText(image, "AI", tesseractOptions, visionProvider, token);
+    };
+    return m_OCRCascade.Recognize(local, fallback, options, cancellation);
+  }
+
+  void Application::ShowNextScan()
+  {
+    if (m_PendingScans.empty()) {
+      return;
+    }
+
+    ReleaseScanTexture();
+    m_CurrentScan = std::move(m_PendingScans.front());
+    m_PendingScans.pop_front();
+
+    m_ScanSentence = m_CurrentScan.sentence;
+    m_ScanTargetWord = "";
+    m_ScanSentences.clear();
+    if (!m_CurrentScan.split && m_CurrentScan.ocr) {
+      m_ScanSentences = m_CurrentScan.ocr->Sentences();
+    }
+
+    if (m_CurrentScan.pixels && !m_CurrentScan.pixels->IsEmpty()) {
+      const auto& pixels = *m_CurrentScan.pixels;
+      auto surface = SDL::MakeSurfaceFrom(pixels.width,
+                                          pixels.height,
+                                          SDL_PIXELFORMAT_RGBA32,
+                                          const_cast<unsigned char*>(pixels.pixels.data()),
+                                          pixels.Stride());
+      if (surface) {
+        m_ScanTexture = SDL_CreateTextureFromSurface(m_Renderer, surface.get());
+      }
+    }
+
+    auto& config = m_ConfigManager->GetConfig();
+    if (config.AudioProvider == "minimax") {
+      m_ScanVoice = config.MiniMaxVoiceId;
+    } else {
+      m_ScanVoice = config.ElevenLabsVoiceId;
+    }
+
+    m_ScanSentence.reserve(256);
+    m_ScanTargetWord.reserve(64);
+    m_ScanVoice.reserve(64);
+
+    StartSpeculativeProcessing();
+
+    if (m_AnkiCardSettingsSection) {
+      m_AnkiCardSettingsSection->SetFieldByTool(7, m_CurrentScan.image, "image.png");
+    }
+
+    m_ShowScanModal = true;
+    m_OpenScanModal = true;
   }
 
   void Application::RenderScanModal()
   {
+    bool wasShown = m_ShowScanModal;
+    bool processed = false;
     if (m_OpenScanModal) {
       ImGui::OpenPopup("Scan Result");
       m_OpenScanModal = false;
@@ -882,7 +1105,21 @@ namespace Image2Card
                                          (void*) str);
       };
 
+      if (m_ScanQueueSize > 1) {
+        ImGui::Text("Region %zu of %zu", m_ScanQueueSize - m_PendingScans.size(), m_ScanQueueSize);
+      }
+
+      RenderScanImage();
+
       InputTextMultiline("Sentence", &m_ScanSentence);
+
+      if (m_ScanSentences.size() > 1) {
+        std::string label = "Split into " + std::to_string(m_ScanSentences.size()) + " sentences";
+        if (ImGui::Button(label.c_str())) {
+          SplitScanIntoSentences();
+        }
+      }
+
       InputText("Target Word", &m_ScanTargetWord);
 
       if (m_AudioAIProvider) {
@@ -911,7 +1148,9 @@ namespace Image2Card
       ImGui::PushStyleColor(ImGuiCol_ButtonActive, ImVec4(0.15f, 0.50f, 0.15f, 1.0f));
 
       if (ImGui::Button("Process", ImVec2(120, 0))) {
+        processed = true;
         ProcessScan();
+        m_WaitingForCardCommit = !m_PendingScans.empty();
         m_ShowScanModal = false;
         ImGui::CloseCurrentPopup();
       }
@@ -930,9 +1169,10 @@ namespace Image2Card
         ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4(0.75f, 0.25f, 0.25f, 1.0f));
         ImGui::PushStyleColor(ImGuiCol_ButtonActive, ImVec4(0.50f, 0.15f, 0.15f, 1.0f));
 
-        if (ImGui::Button("Cancel", ImVec2(120, 0))) {
+        if (ImGui::Button(m_PendingScans.empty() ? "Cancel" : "Skip", ImVec2(120, 0))) {
           m_ShowScanModal = false;
           ImGui::CloseCurrentPopup();
+          ShowNextScan();
         }
 
         ImGui::PopStyleColor(3);
@@ -940,6 +1180,106 @@ namespace Image2Card
 
       ImGui::EndPopup();
     }
+
+    // Closed without Process (Cancel, or the title bar button), so the card being prepared is not wanted.
+    if (wasShown && !m_ShowScanModal && !processed) {
+      CancelSpeculativeProcessing();
+    }
+
+    // Closed with the title bar button: the rest of a multi-region scan is dropped.
+    if (!m_ShowScanModal && !m_OpenScanModal && !m_WaitingForCardCommit && !m_PendingScans.empty()) {
+      AF_INFO("Scan Result closed, dropping {} remaining region(s)", m_PendingScans.size());
+      m_PendingScans.clear();
+    }
+
+    if (!m_ShowScanModal && !m_OpenScanModal) {
+      ReleaseScanTexture();
+    }
+  }
+
+  void Application::RenderScanImage()
+  {
+    if (!m_ScanTexture || !m_CurrentScan.pixels) {
+      return;
+    }
+
+    // Fit the region into the modal without enlarging small crops.
+    const auto& pixels = *m_CurrentScan.pixels;
+    float scale = std::min({1.0f, 400.0f / pixels.width, 240.0f / pixels.height});
+    ImVec2 size(pixels.width * scale, pixels.height * scale);
+    ImGui::Image((ImTextureID) m_ScanTexture, size);
+
+    if (!m_CurrentScan.ocr) {
+      return;
+    }
+
+    ImVec2 origin = ImGui::GetItemRectMin();
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+    const OCR::OCRWord* hovered = nullptr;
+    if (ImGui::IsItemHovered()) {
+      ImVec2 mouse = ImGui::GetIO().MousePos;
+      hovered = m_CurrentScan.ocr->WordAt((int) ((mouse.x - origin.x) / scale), (int) ((mouse.y - origin.y) / scale));
+    }
+
+    // Providers without layout report no words, so only the image is shown for them.
+    for (const auto& block : m_CurrentScan.ocr->blocks) {
+      for (const auto& line : block.lines) {
+        for (const auto& word : line.words) {
+          ImVec2 min(origin.x + word.box.x * scale, origin.y + word.box.y * scale);
+          ImVec2 max(origin.x + word.box.Right() * scale, origin.y + word.box.Bottom() * scale);
+          if (&word == hovered) {
+            drawList->AddRectFilled(min, max, IM_COL32(255, 210, 0, 70));
+            drawList->AddRect(min, max, IM_COL32(255, 210, 0, 255), 0.0f, 0, 2.0f);
+          } else {
+            drawList->AddRect(min, max, IM_COL32(80, 160, 255, 160));
+          }
+        }
+      }
+    }
+
+    if (hovered) {
+      if (hovered->confidence >= 0.0f) {
+        ImGui::SetTooltip("%s (%.0f%%)", hovered->text.c_str(), hovered->confidence);
+      } else {
+        ImGui::SetTooltip("%s", hovered->text.c_str());
+      }
+      if (ImGui::IsMouseClicked(ImGuiMouseButton_Left)) {
+        m_ScanTargetWord = m_ActiveLanguage ? m_ActiveLanguage->PostProcessOCR(hovered->text) : hovered->text;
+      }
+    }
+  }
+
+  void Application::SplitScanIntoSentences()
+  {
+    std::vector<std::string> sentences = std::move(m_ScanSentences);
+    m_ScanSentences.clear();
+    if (sentences.size() < 2) {
+      return;
+    }
+
+    // The region is reviewed once per sentence, reusing its OCR result instead of recognizing it again.
+    for (size_t i = sentences.size() - 1; i > 0; --i) {
+      PendingScan scan = m_CurrentScan;
+      scan.sentence = m_ActiveLanguage ? m_ActiveLanguage->PostProcessOCR(sentences[i]) : sentences[i];
+      scan.split = true;
+      m_PendingScans.push_front(std::move(scan));
+    }
+    m_ScanQueueSize += sentences.size() - 1;
+
+    m_CurrentScan.split = true;
+    m_ScanSentence = m_ActiveLanguage ? m_ActiveLanguage->PostProcessOCR(sentences[0]) : sentences[0];
+    m_ScanSentence.reserve(256);
+    AF_INFO("Split scan into {} sentences", sentences.size());
+
+    StartSpeculativeProcessing();
+  }
+
+  void Application::ReleaseScanTexture()
+  {
+    if (m_ScanTexture) {
+      SDL_DestroyTexture(m_ScanTexture);
+      m_ScanTexture = nullptr;
+    }
   }
 
   void Application::ProcessScan()
@@ -957,10 +1297,6 @@ namespace Image2Card
       m_StatusSection->SetStatus("Processing scan...");
 
     // Capture needed data for async task
-    std::string sentence = m_ScanSentence;
-    std::string targetWord = m_ScanTargetWord;
-    std::string voice = m_ScanVoice;
-
     std::vector<unsigned char> fullImage;
     if (m_ImageSection) {
       fullImage = m_ImageSection->GetFullImageBytes();
@@ -973,219 +1309,63 @@ namespace Image2Card
     if (m_StatusSection)
       m_StatusSection->SetProgress(0.1f);
 
-    std::string languageCode = m_ActiveLanguage ? m_ActiveLanguage->GetLanguageCode() : "";
-    std::string selectedAnalysisModel = m_ConfigManager->GetConfig().SelectedAnalysisModel;
+    Pipeline::CardRequest request = BuildCardRequest();
+    Pipeline::CardPipelineServices services = BuildPipelineServices();
+
+    // Stages the speculative run already finished (or is still running) for the same inputs are reused.
+    if (!m_ScanMemo) {
+      m_ScanMemo = std::make_shared<Pipeline::StageMemo>();
+    }
+    auto memo = m_ScanMemo;
 
     {
       std::lock_guard<std::mutex> lock(m_ResultMutex);
       m_LastError.clear();
     }
 
+    auto result = std::make_shared<Pipeline::CardResult>();
+
     AsyncTask task;
     task.description = "Scan Processing";
-    task.future = std::async(
-        std::launch::async, [this, sentence, targetWord, voice, fullImage, languageCode, selectedAnalysisModel]() {
-          try {
-            if (m_CancelRequested.load()) {
-              AF_INFO("Processing task cancelled before starting.");
-              return;
-            }
-            AF_INFO("Analyzing sentence...");
-            AF_DEBUG("Sentence: '{}', Target Word: '{}'", sentence, targetWord);
-
-            if (!m_ActiveLanguage) {
-              throw std::runtime_error("No active language selected");
-            }
-
-            nlohmann::json analysis;
-
-            if (m_SentenceAnalyzer && m_SentenceAnalyzer->IsReady()) {
-              AF_INFO("Using local sentence analyzer");
-              analysis = m_SentenceAnalyzer->AnalyzeSentence(sentence, targetWord, m_ActiveLanguage);
-            } else {
-              AF_INFO("Using AI for sentence analysis");
-              auto* provider = GetTextProviderForModel(selectedAnalysisModel);
-              if (!provider) {
-                throw std::runtime_error("No Text AI Provider found for selected analysis model.");
-              }
-
-              // Update provider with selected model
-              std::string modelName = selectedAnalysisModel;
-              size_t slashPos = modelName.find('/');
-              if (slashPos != std::string::npos) {
-                modelName = modelName.substr(slashPos + 1);
-              }
-              nlohmann::json config;
-              config["sentence_model"] = modelName;
-              provider->LoadConfig(config);
-
-              analysis = provider->AnalyzeSentence(sentence, targetWord, *m_ActiveLanguage);
-            }
-
-            if (m_CancelRequested.load()) {
-              AF_INFO("Processing task cancelled after analysis.");
-              return;
-            }
-
-            AF_DEBUG("Analysis Response: {}", analysis.dump());
-            if (analysis.is_null()) {
-              AF_ERROR("Analysis returned null/empty response");
-              throw std::runtime_error("Text analysis failed.");
-            }
-
+    task.timeout = ProcessTimeout;
+    task.work = [this, request, services, memo, result](const Core::CancellationToken& cancellation) {
+      try {
+        if (cancellation.IsCancelled()) {
+          AF_INFO("Processing task cancelled before starting.");
+          return;
+        }
+        AF_INFO("Analyzing sentence...");
+        AF_DEBUG("Sentence: '{}', Target Word: '{}'", request.sentence, request.targetWord);
+
+        Pipeline::CardPipeline pipeline(services);
+        pipeline.SetCancellationToken(cancellation);
+        pipeline.SetMemo(memo);
+        pipeline.SetOnStageComplete([this](const std::string& stage, size_t completed, size_t total) {
+          AF_INFO("Stage '{}' complete ({}/{})", stage, completed, total);
+          m_MainThreadDispatcher->Post([this, progress = 0.1f + 0.9f * (float) completed / (float) total]() {
             if (m_StatusSection)
-              m_StatusSection->SetProgress(0.4f);
-
-            AF_INFO("Analysis Result: {}", analysis.dump());
-
-            std::string analyzedSentence = analysis.value("sentence", "");
-            std::string translation = analysis.value("translation", "");
-            std::string analyzedTargetWord = analysis.value("target_word", "");
-            std::string targetWordFurigana = analysis.value("target_word_furigana", "");
-            std::string furigana = analysis.value("furigana", "");
-            std::string definition = analysis.value("definition", "");
-            std::string pitch = analysis.value("pitch_accent", "");
-
-            auto updateFields = [this,
-                                 analyzedSentence,
-                                 translation,
-                                 analyzedTargetWord,
-                                 targetWordFurigana,
-                                 furigana,
-                                 definition,
-                                 pitch,
-                                 fullImage]() {
-              if (m_AnkiCardSettingsSection) {
-                AF_INFO("Setting fields in Anki Card Settings...");
-                m_AnkiCardSettingsSection->SetFieldByTool(0, analyzedSentence);
-                m_AnkiCardSettingsSection->SetFieldByTool(1, furigana);
-                m_AnkiCardSettingsSection->SetFieldByTool(2, translation);
-                m_AnkiCardSettingsSection->SetFieldByTool(3, analyzedTargetWord);
-                m_AnkiCardSettingsSection->SetFieldByTool(4, targetWordFurigana);
-                m_AnkiCardSettingsSection->SetFieldByTool(5, pitch);
-                m_AnkiCardSettingsSection->SetFieldByTool(6, definition);
-                if (!fullImage.empty()) {
-                  m_AnkiCardSettingsSection->SetFieldByTool(7, fullImage, "image.png");
-                }
-              } else {
-                AF_WARN("AnkiCardSettingsSection is null, cannot set fields.");
-              }
-            };
-
-            updateFields();
-            if (!analyzedTargetWord.empty() && !m_CancelRequested.load()) {
-              if (m_StatusSection)
-                m_StatusSection->SetProgress(0.6f);
-              AF_INFO("Generating Vocab Audio for: {}", analyzedTargetWord);
-              if (m_StatusSection)
-                m_StatusSection->SetStatus("Generating Vocab Audio...");
-
-              std::vector<unsigned char> vocabAudio;
-
-              if (m_ForvoClient && m_ForvoClient->IsAvailable()) {
-                AF_INFO("Searching audio from Forvo");
-                try {
-                  auto audioResults = m_ForvoClient->SearchAudio(analyzedTargetWord, analyzedTargetWord, "");
-
-                  if (!audioResults.empty()) {
-                    std::string audioUrl = audioResults[0].url;
-                    if (audioUrl.find("https://") == 0) {
-                      audioUrl = audioUrl.substr(8);
-                    }
-
-                    size_t slashPos = audioUrl.find('/');
-                    if (slashPos != std::string::npos) {
-                      std::string host = audioUrl.substr(0, slashPos);
-                      std::string path = audioUrl.substr(slashPos);
-
-                      httplib::SSLClient audioClient(host.c_str());
-                      audioClient.set_connection_timeout(10, 0);
-                      audioClient.set_read_timeout(10, 0);
-
-                      auto res = audioClient.Get(path.c_str());
-                      if (res && res->status == 200) {
-                        vocabAudio.assign(res->body.begin(), res->body.end());
-                        AF_INFO("Downloaded vocab audio from Forvo: {} ({} bytes)",
-                                audioResults[0].filename,
-                                vocabAudio.size());
-                      } else {
-                        AF_WARN("Failed to download vocab audio from: {}", audioUrl);
-                      }
-                    }
-                  }
-                } catch (const std::exception& e) {
-                  AF_WARN("Forvo audio search failed: {}, falling back to AI", e.what());
-                }
-              }
-
-              if (vocabAudio.empty() && m_AudioAIProvider) {
-                AF_INFO("Using AI for vocab audio generation");
-                std::string audioFormat = m_ConfigManager->GetConfig().AudioFormat;
-                vocabAudio = m_AudioAIProvider->GenerateAudio(analyzedTargetWord, voice, languageCode, audioFormat);
-                AF_INFO("Vocab Audio generated, size: {} bytes", vocabAudio.size());
-              }
-
-              if (m_AnkiCardSettingsSection && !vocabAudio.empty()) {
-                // 8: Vocab Audio
-                std::string filename = "vocab.mp3";
-                if (m_ForvoClient && !vocabAudio.empty()) {
-                  auto audioResults = m_ForvoClient->SearchAudio(analyzedTargetWord, analyzedTargetWord, "");
-                  if (!audioResults.empty()) {
-                    filename = audioResults[0].filename;
-                  }
-                } else {
-                  std::string audioFormat = m_ConfigManager->GetConfig().AudioFormat;
-                  std::string audioExt;
-                  if (audioFormat == "opus") {
-                    audioExt = (m_ConfigManager->GetConfig().AudioProvider == "minimax") ? "ogg" : "opus";
-                  } else {
-                    audioExt = "mp3";
-                  }
-                  filename = "vocab." + audioExt;
-                }
-                m_AnkiCardSettingsSection->SetFieldByTool(8, vocabAudio, filename);
-              }
-            }
+              m_StatusSection->SetProgress(progress);
+          });
+        });
 
-            if (!analyzedSentence.empty() && !m_CancelRequested.load()) {
-              if (m_StatusSection)
-                m_StatusSection->SetProgress(0.8f);
-              AF_INFO("Generating Sentence Audio for: {}", analyzedSentence);
-              if (m_StatusSection)
-                m_StatusSection->SetStatus("Generating Sentence Audio...");
-
-              std::string audioFormat = m_ConfigManager->GetConfig().AudioFormat;
-              std::vector<unsigned char> sentenceAudio =
-                  m_AudioAIProvider->GenerateAudio(analyzedSentence, voice, languageCode, audioFormat);
-              AF_INFO("Sentence Audio generated, size: {} bytes", sentenceAudio.size());
-
-              if (m_AnkiCardSettingsSection && !sentenceAudio.empty()) {
-                // 9: Sentence Audio
-                std::string audioExt;
-                if (audioFormat == "opus") {
-                  audioExt = (m_ConfigManager->GetConfig().AudioProvider == "minimax") ? "ogg" : "opus";
-                } else {
-                  audioExt = "mp3";
-                }
-                m_AnkiCardSettingsSection->SetFieldByTool(9, sentenceAudio, "sentence." + audioExt);
-              }
-            }
+        *result = pipeline.Run(request);
 
-            if (m_StatusSection)
-              m_StatusSection->SetProgress(1.0f);
-            AF_INFO("Processing complete.");
-          } catch (const std::exception& e) {
-            AF_ERROR("Processing task failed with exception: {}", e.what());
-            std::lock_guard<std::mutex> lock(m_ResultMutex);
-            m_LastError = std::string("Processing failed: ") + e.what();
-          } catch (...) {
-            AF_ERROR("Processing task failed with unknown exception.");
-            std::lock_guard<std::mutex> lock(m_ResultMutex);
-            m_LastError = "Processing failed with unknown error.";
-          }
-        });
+        for (const auto& timing : pipeline.GetTimings()) {
+          AF_INFO("  {} started at +{:.0f}ms, took {:.0f}ms", timing.name, timing.startMs, timing.durationMs);
+        }
+        AF_INFO("Processing complete.");
+      } catch (const std::exception& e) {
+        AF_ERROR("Processing task failed with exception: {}", e.what());
+        std::lock_guard<std::mutex> lock(m_ResultMutex);
+        m_LastError = std::string("Processing failed: ") + e.what();
+      } catch (...) {
+        AF_ERROR("Processing task failed with unknown exception.");
+        std::lock_guard<std::mutex> lock(m_ResultMutex);
+        m_LastError = "Processing failed with unknown error.";
+      }
+    };
 
-    task.onComplete = [this]() {
+    task.onComplete = [this, result, fullImage = std::move(fullImage)]() {
       m_IsProcessing.store(false);
 
       std::string error;
@@ -1198,11 +1378,44 @@ namespace Image2Card
         if (m_StatusSection)
           m_StatusSection->SetStatus("Error: " + error);
         AF_ERROR("Processing failed: {}", error);
+        if (m_WaitingForCardCommit) {
+          m_WaitingForCardCommit = false;
+          ShowNextScan();
+        }
         return;
       }
 
-      if (m_StatusSection)
-        m_StatusSection->SetStatus("Processing complete.");
+      if (m_AnkiCardSettingsSection) {
+        AF_INFO("Setting fields in Anki Card Settings...");
+        m_AnkiCardSettingsSection->SetFieldByTool(0, result->sentence);
+        m_AnkiCardSettingsSection->SetFieldByTool(1, result->furigana);
+        m_AnkiCardSettingsSection->SetFieldByTool(2, result->translation);
+        m_AnkiCardSettingsSection->SetFieldByTool(3, result->targetWord);
+        m_AnkiCardSettingsSection->SetFieldByTool(4, result->targetWordFurigana);
+        m_AnkiCardSettingsSection->SetFieldByTool(5, result->pitchAccent);
+        m_AnkiCardSettingsSection->SetFieldByTool(6, result->definition);
+        if (!fullImage.empty()) {
+          m_AnkiCardSettingsSection->SetFieldByTool(7, fullImage, "image.png");
+        }
+        if (!result->vocabAudio.empty()) {
+          m_AnkiCardSettingsSection->SetFieldByTool(8, result->vocabAudio, result->vocabAudioFilename);
+        }
+        if (!result->sentenceAudio.empty()) {
+          m_AnkiCardSettingsSection->SetFieldByTool(9, result->sentenceAudio, result->sentenceAudioFilename);
+        }
+      } else {
+        AF_WARN("AnkiCardSettingsSection is null, cannot set fields.");
+      }
+
+      if (m_StatusSection) {
+        if (m_WaitingForCardCommit) {
+          m_StatusSection->SetStatus("Processing complete. Add the card to continue (" +
+                                     std::to_string(m_PendingScans.size()) + " more region(s)).");
+        } else {
+          m_StatusSection->SetStatus("Processing complete.");
+        }
+        m_StatusSection->SetProgress(1.0f);
+      }
       AF_INFO("All processing tasks completed successfully.");
     };
 
@@ -1213,71 +1426,176 @@ namespace Image2Card
         m_StatusSection->SetProgress(-1.0f);
       }
       AF_ERROR("Processing error: {}", error);
+      if (m_WaitingForCardCommit) {
+        m_WaitingForCardCommit = false;
+        ShowNextScan();
+      }
     };
 
-    // Add task to queue
-    {
-      std::lock_guard<std::mutex> lock(m_TaskMutex);
-      m_ActiveTasks.push(std::move(task));
+    StartAsyncTask(std::move(task));
+  }
+
+  Pipeline::CardRequest Application::BuildCardRequest() const
+  {
+    auto& config = m_ConfigManager->GetConfig();
+
+    Pipeline::CardRequest request;
+    request.sentence = m_ScanSentence;
+    request.targetWord = m_ScanTargetWord;
+    request.voice = m_ScanVoice;
+    request.languageCode = m_ActiveLanguage ? m_ActiveLanguage->GetLanguageCode() : "";
+    request.audioFormat = config.AudioFormat;
+    request.audioExtension = Pipeline::CardPipeline::AudioExtension(config.AudioFormat, config.AudioProvider);
+    return request;
+  }
+
+  Pipeline::CardPipelineServices Application::BuildPipelineServices()
+  {
+    auto& config = m_ConfigManager->GetConfig();
+
+    Pipeline::CardPipelineServices services;
+    services.analyzer = m_SentenceAnalyzer.get();
+    services.language = m_ActiveLanguage;
+    services.forvoClient = m_ForvoClient.get();
+    services.audioProvider = m_AudioAIProvider.get();
+
+    services.analyzerReadiness = &m_AnalyzerReadiness;
+
+    // While the analyzer is still loading the provider is set up too, in case loading fails.
+    if (!m_SentenceAnalyzer || !m_AnalyzerReadiness.IsReady() || !m_SentenceAnalyzer->IsReady()) {
+      std::string selectedAnalysisModel = config.SelectedAnalysisModel;
+      services.analysisProvider = GetTextProviderForModel(selectedAnalysisModel);
+      if (services.analysisProvider) {
+        // Update provider with selected model
+        std::string modelName = selectedAnalysisModel;
+        size_t slashPos = modelName.find('/');
+        if (slashPos != std::string::npos) {
+          modelName = modelName.substr(slashPos + 1);
+        }
+        // Only write it when it changed, since a speculative run may be reading it on another thread.
+        if (services.analysisProvider->SaveConfig().value("sentence_model", "") != modelName) {
+          nlohmann::json providerConfig;
+          providerConfig["sentence_model"] = modelName;
+          services.analysisProvider->LoadConfig(providerConfig);
+        }
+      }
     }
+    return services;
   }
 
-  void Application::UpdateAsyncTasks()
+  void Application::CancelSpeculativeProcessing()
   {
-    std::lock_guard<std::mutex> lock(m_TaskMutex);
+    if (m_SpeculativeTaskId) {
+      auto it = m_ActiveTasks.find(*m_SpeculativeTaskId);
+      if (it != m_ActiveTasks.end()) {
+        it->second.cancellation.Cancel();
+      }
+      m_SpeculativeTaskId.reset();
+    }
+  }
 
-    // Process completed tasks
-    while (!m_ActiveTasks.empty()) {
-      auto& task = m_ActiveTasks.front();
+  void Application::StartSpeculativeProcessing()
+  {
+    // Results of the previous scan can never be used again, so stop its requests and start a fresh memo.
+    CancelSpeculativeProcessing();
+    m_ScanMemo = std::make_shared<Pipeline::StageMemo>();
 
-      // Check if task is complete
-      if (task.future.wait_for(std::chrono::milliseconds(0)) == std::future_status::ready) {
-        AF_INFO("Async task completed: {}", task.description);
+    if (!m_ActiveLanguage || m_ScanSentence.empty()) {
+      return;
+    }
 
-        // Get the result (this will also handle any exceptions)
-        try {
-          task.future.get();
+    Pipeline::CardRequest request = BuildCardRequest();
+    Pipeline::CardPipelineServices services = BuildPipelineServices();
+    if (!services.analysisProvider && (!services.analyzer || !services.analyzer->IsReady())) {
+      return;
+    }
 
-          // Call completion callback
-          if (task.onComplete) {
-            task.onComplete();
-          }
-        } catch (const std::exception& e) {
-          AF_ERROR("Async task '{}' threw exception: {}", task.description, e.what());
-          if (task.onError) {
-            task.onError(e.what());
-          }
-        } catch (...) {
-          AF_ERROR("Async task '{}' threw unknown exception", task.description);
-          if (task.onError) {
-            task.onError("Unknown error");
-          }
-        }
+    AF_INFO("Starting speculative processing while the scan result is reviewed");
 
-        // Remove completed task
-        m_ActiveTasks.pop();
-      } else {
-        // Task still running, keep it in queue and break
-        // (we only process the first task to maintain order)
-        break;
+    AsyncTask task;
+    task.description = "Speculative Processing";
+    task.timeout = ProcessTimeout;
+    task.priority = Core::TaskPriority::Batch;
+    task.work = [request, services, memo = m_ScanMemo](const Core::CancellationToken& cancellation) {
+      // Only the memo is of interest; the result is rebuilt from it when the user presses Process.
+      try {
+        Pipeline::CardPipeline pipeline(services);
+        pipeline.SetCancellationToken(cancellation);
+        pipeline.SetPriority(Core::TaskPriority::Batch);
+        pipeline.SetMemo(memo);
+        (void) pipeline.Run(request);
+      } catch (const std::exception& e) {
+        AF_DEBUG("Speculative processing stopped: {}", e.what());
       }
+    };
+
+    uint64_t id = StartAsyncTask(std::move(task));
+    m_SpeculativeTaskId = id;
+  }
+
+  uint64_t Application::StartAsyncTask(AsyncTask task)
+  {
+    uint64_t id = m_NextTaskId++;
+    auto shared = std::make_shared<AsyncTask>(std::move(task));
+
+    ActiveTask& active = m_ActiveTasks[id];
+    if (shared->timeout.count() > 0) {
+      active.cancellation.SetDeadline(Core::CancellationToken::Clock::now() + shared->timeout);
     }
+
+    Core::CancellationToken cancellation = active.cancellation.GetToken();
+    auto& executor = Core::TaskExecutor::Get();
+    active.future = executor.Submit(shared->priority, [this, id, shared, cancellation]() {
+      AF_TRACE_SCOPE("task", shared->description);
+      std::string error;
+      bool failed = false;
+      try {
+        shared->work(cancellation);
+      } catch (const std::exception& e) {
+        AF_ERROR("Async task '{}' threw exception: {}", shared->description, e.what());
+        error = e.what();
+        failed = true;
+      } catch (...) {
+        AF_ERROR("Async task '{}' threw unknown exception", shared->description);
+        error = "Unknown error";
+        failed = true;
+      }
+
+      m_MainThreadDispatcher->Post([this, id, shared, error, failed]() {
+        m_ActiveTasks.erase(id);
+        AF_INFO("Async task completed: {}", shared->description);
+
+        if (failed) {
+          if (shared->onError) {
+            shared->onError(error);
+          }
+        } else if (shared->onComplete) {
+          shared->onComplete();
+        }
+      });
+    });
+    return id;
+  }
+
+  void Application::UpdateAsyncTasks()
+  {
+    // Only continuations of tasks that have actually finished are queued, so a slow
+    // task never holds back the completion of tasks started after it.
+    m_MainThreadDispatcher->Drain();
   }
 
   void Application::CancelAsyncTasks()
   {
     AF_INFO("Cancelling all async tasks...");
-    m_CancelRequested.store(true);
 
-    std::lock_guard<std::mutex> lock(m_TaskMutex);
-
-    // Wait for all tasks to complete
-    while (!m_ActiveTasks.empty()) {
-      auto& task = m_ActiveTasks.front();
-
-      AF_INFO("Waiting for task to complete: {}", task.description);
+    // Cancel everything first so in-flight requests abort in parallel rather than one wait at a time.
+    for (auto& [id, task] : m_ActiveTasks) {
+      task.cancellation.Cancel();
+    }
+    if (m_OutboxSync)
+      m_OutboxSync->Cancel();
 
-      // Wait with timeout
+    for (auto& [id, task] : m_ActiveTasks) {
       if (task.future.wait_for(std::chrono::seconds(5)) == std::future_status::ready) {
         try {
           task.future.get();
@@ -1285,15 +1603,16 @@ namespace Image2Card
           // Ignore exceptions during shutdown
         }
       } else {
-        AF_WARN("Task '{}' did not complete within timeout, may still be running", task.description);
+        AF_WARN("Async task {} did not complete within timeout, may still be running", id);
       }
-
-      m_ActiveTasks.pop();
     }
+    m_ActiveTasks.clear();
+
+    // The UI is about to be torn down, so completions that have not run yet are dropped.
+    m_MainThreadDispatcher->Clear();
 
-    m_IsScanning.store(false);
+    m_ActiveScans.store(0);
     m_IsProcessing.store(false);
-    m_CancelRequested.store(false);
 
     AF_INFO("All async tasks cancelled/completed.");
   }
@@ -1,20 +1,36 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
 #include <functional>
 #include <future>
+#include <map>
 #include <memory>
 #include <mutex>
-#include <queue>
+#include <optional>
 #include <string>
+#include <vector>
+
+#include "core/CancellationToken.h"
+#include "ai/ImageUpload.h"
+#include "core/Readiness.h"
+#include "core/TaskExecutor.h"
+#include "ocr/OCRCascade.h"
+#include "ocr/OCRResult.h"
+#include "utils/ImageView.h"
 
 struct SDL_Window;
 struct SDL_Renderer;
+struct SDL_Texture;
 
 namespace Image2Card::OCR
 {
   class TesseractOCRProvider;
+  struct TesseractOptions;
   class NativeOCRProvider;
+  class OCRCache;
 } // namespace Image2Card::OCR
 
 namespace Image2Card::Language::Analyzer
@@ -43,6 +59,9 @@ namespace Image2Card::UI
 namespace Image2Card::API
 {
   class AnkiConnectClient;
+  class CardOutbox;
+  class DuplicateIndex;
+  class OutboxSync;
 }
 
 namespace Image2Card::AI
@@ -61,6 +80,18 @@ namespace Image2Card::Config
   class ConfigManager;
 }
 
+namespace Image2Card::Core
+{
+  class MainThreadDispatcher;
+}
+
+namespace Image2Card::Pipeline
+{
+  struct CardRequest;
+  struct CardPipelineServices;
+  class StageMemo;
+} // namespace Image2Card::Pipeline
+
 namespace Image2Card
 {
 
@@ -79,6 +110,17 @@ public:
 private:
 
     bool Initialize();
+
+    /**
+   * Load Tesseract, native OCR, the OCR cache and the sentence analyzer on worker
+   * threads. Each reports through its Readiness; nothing waits for them here.
+   */
+    void StartBackgroundInitialization(const std::string& prefDirectory);
+
+    /**
+   * Log time to scan-ready and to fully loaded once, as the subsystems settle.
+   */
+    void LogStartupProgress();
     void Shutdown();
 
     void HandleEvents();
@@ -86,9 +128,32 @@ private:
     void Render();
     void RenderUI();
 
-    void OnScan();
+    /**
+   * @param wholePage The selections are text blocks detected on a whole page: they are read
+   * locally where possible and queued sentence by sentence
+   */
+    void OnScan(bool wholePage = false);
+    void OnScanPage();
+    OCR::OCRResult RecognizeText(const Utils::ImageView& image,
+                                 const std::string& ocrMethod,
+                                 const OCR::TesseractOptions& tesseractOptions,
+                                 AI::ITextAIProvider* visionProvider,
+                                 const Core::CancellationToken& cancellation);
+    OCR::OCRCascade::Outcome RecognizeWithCascade(const Utils::ImageView& image,
+                                                  const OCR::TesseractOptions& tesseractOptions,
+                                                  AI::ITextAIProvider* visionProvider,
+                                                  const OCR::CascadeOptions& options,
+                                                  const Core::CancellationToken& cancellation);
+    void ShowNextScan();
     void RenderScanModal();
+    void RenderScanImage();
+    void SplitScanIntoSentences();
+    void ReleaseScanTexture();
     void ProcessScan();
+    void StartSpeculativeProcessing();
+    void CancelSpeculativeProcessing();
+    Pipeline::CardRequest BuildCardRequest() const;
+    Pipeline::CardPipelineServices BuildPipelineServices();
 
     void UpdateAsyncTasks();
     void CancelAsyncTasks();
@@ -111,6 +176,10 @@ private:
     std::unique_ptr<UI::StatusSection> m_StatusSection;
 
     std::unique_ptr<API::AnkiConnectClient> m_AnkiConnectClient;
+    std::unique_ptr<API::DuplicateIndex> m_DuplicateIndex;
+    std::unique_ptr<API::CardOutbox> m_OfflineOutbox; // Cards added while AnkiConnect does not answer
+    std::unique_ptr<API::CardOutbox> m_StagingOutbox; // Cards staged in the editor until they are flushed
+    std::unique_ptr<API::OutboxSync> m_OutboxSync;
     std::unique_ptr<Config::ConfigManager> m_ConfigManager;
 
     std::vector<std::shared_ptr<AI::ITextAIProvider>> m_TextAIProviders;
@@ -119,11 +188,24 @@ private:
 
     std::unique_ptr<OCR::TesseractOCRProvider> m_TesseractOCRProvider;
     std::unique_ptr<OCR::NativeOCRProvider> m_NativeOCRProvider;
+    OCR::OCRCascade m_OCRCascade; // Shared by every scan so its statistics cover the session
+    AI::ImageUpload m_ImageUpload;   // Prepares vision model uploads and tracks what they save
+    std::unique_ptr<OCR::OCRCache> m_OCRCache;
 
     std::vector<std::unique_ptr<Language::Services::ILanguageService>> m_LanguageServices;
     std::unique_ptr<Language::Analyzer::SentenceAnalyzer> m_SentenceAnalyzer;
     std::unique_ptr<Language::Audio::ForvoClient> m_ForvoClient;
 
+    // Subsystems loaded in the background after the window is shown.
+    Core::Readiness m_TesseractReadiness{"Tesseract"};
+    Core::Readiness m_NativeOCRReadiness{"Native OCR"};
+    Core::Readiness m_OCRCacheReadiness{"OCR cache"};
+    Core::Readiness m_AnalyzerReadiness{"Sentence analyzer"};
+    std::chrono::steady_clock::time_point m_LaunchTime = std::chrono::steady_clock::now();
+    bool m_FirstFrameShown = false;
+    bool m_ScanReadyLogged = false;
+    bool m_StartupLogged = false;
+
     std::vector<std::unique_ptr<Language::ILanguage>> m_Languages;
     Language::ILanguage* m_ActiveLanguage = nullptr;
 
@@ -133,25 +215,61 @@ private:
     std::string m_ScanTargetWord;
     std::string m_ScanVoice;
 
+    // Regions of a multi-selection scan waiting for the Scan Result modal, in reading order.
+    struct PendingScan
+    {
+      std::string sentence;
+      std::vector<unsigned char> image; // PNG of the region, for the card's image field
+      std::shared_ptr<const Utils::ImageBuffer> pixels; // Region shown under the word overlay
+      std::shared_ptr<const OCR::OCRResult> ocr;        // Layout and word boxes of the region
+      bool split = false;                               // Already one sentence of a split region
+    };
+    std::deque<PendingScan> m_PendingScans;
+    size_t m_ScanQueueSize = 0;
+
+    // Region and OCR layout of the scan in the Scan Result modal.
+    PendingScan m_CurrentScan;
+    std::vector<std::string> m_ScanSentences; // Sentences the current region can be split into
+    SDL_Texture* m_ScanTexture = nullptr;
+    bool m_WaitingForCardCommit = false; // Next region is shown once the processed card is added or staged
+
+    // Stage results for the current scan, warmed in the background while the Scan Result modal is open.
+    std::shared_ptr<Pipeline::StageMemo> m_ScanMemo;
+    std::optional<uint64_t> m_SpeculativeTaskId;
+
     struct AsyncTask
     {
-      std::future<void> future;
       std::string description;
-      std::function<void()> onComplete;
-      std::function<void(const std::string&)> onError;
+      std::chrono::seconds timeout{0};                               // Deadline for work, 0 for none
+      Core::TaskPriority priority = Core::TaskPriority::Interactive; // Executor lane for work
+      std::function<void(const Core::CancellationToken&)> work;      // Runs on the task executor
+      std::function<void()> onComplete;                              // Runs on the main thread
+      std::function<void(const std::string&)> onError;               // Runs on the main thread
     };
 
-    std::queue<AsyncTask> m_ActiveTasks;
-    std::mutex m_TaskMutex;
+    struct ActiveTask
+    {
+      std::future<void> future;
+      Core::CancellationSource cancellation;
+    };
+
+    /**
+   * Run task.work in the background; its continuation is posted to the
+   * main thread dispatcher as soon as it finishes, independent of other tasks.
+   * @return Id of the task in m_ActiveTasks while it is running
+   */
+    uint64_t StartAsyncTask(AsyncTask task);
+
+    std::unique_ptr<Core::MainThreadDispatcher> m_MainThreadDispatcher;
+    // In-flight tasks keyed by id, only touched on the main thread. Kept so shutdown can cancel and wait for them.
+    std::map<uint64_t, ActiveTask> m_ActiveTasks;
+    uint64_t m_NextTaskId = 0;
 
-    std::atomic<bool> m_IsScanning{false};
+    std::atomic<int> m_ActiveScans{0}; // Scans may overlap; each OCRs on its own pool engines
     std::atomic<bool> m_IsProcessing{false};
-    std::atomic<bool> m_CancelRequested{false};
     std::atomic<bool> m_AnkiConnected{false};
 
     std::mutex m_ResultMutex;
-    std::string m_OCRResult;
-    bool m_OCRComplete = false;
     std::string m_LastError;
   };
 
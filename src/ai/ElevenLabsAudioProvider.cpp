@@ -7,9 +7,10 @@
 #include <exception>
 #include <httplib.h>
 #include <iostream>
-#include <thread>
 
 #include "core/Logger.h"
+#include "core/TaskExecutor.h"
+#include "core/Trace.h"
 
 namespace Image2Card::AI
 {
@@ -31,7 +32,7 @@ namespace Image2Card::AI
     }
 
     if (ImGui::Button("Load Voices")) {
-      std::thread([this]() { LoadRemoteVoices(); }).detach();
+      Core::TaskExecutor::Get().Post(Core::TaskPriority::Interactive, [this]() { LoadRemoteVoices(); });
       changed = true;
     }
 
@@ -156,14 +157,20 @@ namespace Image2Card::AI
   std::vector<unsigned char> ElevenLabsAudioProvider::GenerateAudio(const std::string& text,
                                                                     const std::string& voiceId,
                                                                     const std::string& languageCode,
-                                                                    const std::string& format)
+                                                                    const std::string& format,
+                                                                    const Core::CancellationToken& cancellation)
   {
+    AF_TRACE_SCOPE("tts", "ElevenLabs");
     std::string targetVoiceId = voiceId.empty() ? m_VoiceId : voiceId;
 
     if (m_ApiKey.empty() || targetVoiceId.empty()) {
       AF_ERROR("ElevenLabsAudioProvider Error: API Key or Voice ID is missing.");
       return {};
     }
+    if (cancellation.IsCancelled()) {
+      AF_INFO("ElevenLabsAudioProvider: request cancelled before sending");
+      return {};
+    }
 
     std::string elevenLabsFormat;
     std::string acceptHeader;
@@ -178,8 +185,8 @@ namespace Image2Card::AI
 
     try {
       httplib::Client cli("https://api.elevenlabs.io");
-      cli.set_connection_timeout(120);
-      cli.set_read_timeout(120);
+      cli.set_connection_timeout(cancellation.ClampTimeout(std::chrono::seconds(120)));
+      cli.set_read_timeout(cancellation.ClampTimeout(std::chrono::seconds(120)));
 
       httplib::Headers headers = {{"xi-api-key", m_ApiKey}, {"Accept", acceptHeader}};
 
@@ -194,8 +201,14 @@ namespace Image2Card::AI
 
       std::string endpoint = "/v1/text-to-speech/" + targetVoiceId;
 
+      Core::ScopedCancellationCallback stopOnCancel(cancellation, [&cli]() { cli.stop(); });
       auto res = cli.Post(endpoint, headers, payload.dump(), "application/json");
 
+      if (!res && cancellation.IsCancelled()) {
+        AF_INFO("ElevenLabsAudioProvider: request cancelled");
+        return {};
+      }
+
       if (res && res->status == 200) {
         AF_INFO("Generated audio in {} format, size: {} bytes", format, res->body.size());
         return std::vector<unsigned char>(res->body.begin(), res->body.end());
@@ -8,9 +8,10 @@
 #include <httplib.h>
 #include <iostream>
 #include <sstream>
-#include <thread>
 
 #include "core/Logger.h"
+#include "core/TaskExecutor.h"
+#include "core/Trace.h"
 #include "language/ILanguage.h"
 #include "utils/Base64Utils.h"
 
@@ -42,7 +43,7 @@ namespace Image2Card::AI
     } else {
       if (ImGui::Button("Load Models")) {
         m_CancelLoadModels.store(false);
-        std::thread([this]() { LoadRemoteModels(); }).detach();
+        Core::TaskExecutor::Get().Post(Core::TaskPriority::Interactive, [this]() { LoadRemoteModels(); });
         changed = true;
       }
     }
@@ -129,24 +130,36 @@ namespace Image2Card::AI
     m_IsLoadingModels = false;
   }
 
-  nlohmann::json GoogleTextProvider::SendRequest(const std::string& endpoint, const nlohmann::json& payload)
+  nlohmann::json GoogleTextProvider::SendRequest(const std::string& endpoint,
+                                                 const nlohmann::json& payload,
+                                                 const Core::CancellationToken& cancellation)
   {
     if (m_ApiKey.empty()) {
       AF_ERROR("GoogleTextProvider Error: API Key is missing.");
       return nullptr;
     }
+    if (cancellation.IsCancelled()) {
+      AF_INFO("GoogleTextProvider: request cancelled before sending");
+      return nullptr;
+    }
 
     try {
       httplib::Client cli("https://generativelanguage.googleapis.com");
-      cli.set_connection_timeout(120);
-      cli.set_read_timeout(120);
+      cli.set_connection_timeout(cancellation.ClampTimeout(std::chrono::seconds(120)));
+      cli.set_read_timeout(cancellation.ClampTimeout(std::chrono::seconds(120)));
 
       std::string path = endpoint + "?key=" + m_ApiKey;
 
       httplib::Headers headers = {{"Content-Type", "application/json"}};
 
+      Core::ScopedCancellationCallback stopOnCancel(cancellation, [&cli]() { cli.stop(); });
       auto res = cli.Post(path, headers, payload.dump(), "application/json");
 
+      if (!res && cancellation.IsCancelled()) {
+        AF_INFO("GoogleTextProvider: request cancelled");
+        return nullptr;
+      }
+
       if (res && res->status == 200) {
         return nlohmann::json::parse(res->body);
       } else {
@@ -163,8 +176,10 @@ namespace Image2Card::AI
 
   std::string GoogleTextProvider::ExtractTextFromImage(const std::vector<unsigned char>& imageBuffer,
                                                        const std::string& mimeType,
-                                                       const Language::ILanguage& language)
+                                                       const Language::ILanguage& language,
+                                                       const Core::CancellationToken& cancellation)
   {
+    AF_TRACE_SCOPE("ocr", "Google vision OCR");
     if (imageBuffer.empty())
       return "";
 
@@ -198,7 +213,7 @@ namespace Image2Card::AI
 #endif
 
     std::string endpoint = "/v1beta/models/" + m_VisionModel + ":generateContent";
-    auto response = SendRequest(endpoint, payload);
+    auto response = SendRequest(endpoint, payload, cancellation);
 
     if (!response.is_null() && response.contains("candidates") && !response["candidates"].empty()) {
       auto& candidate = response["candidates"][0];
@@ -251,8 +266,10 @@ namespace Image2Card::AI
 
   nlohmann::json GoogleTextProvider::AnalyzeSentence(const std::string& sentence,
                                                      const std::string& targetWord,
-                                                     const Language::ILanguage& language)
+                                                     const Language::ILanguage& language,
+                                                     const Core::CancellationToken& cancellation)
   {
+    AF_TRACE_SCOPE("analysis", "Google sentence analysis");
     std::string prompt = language.GetAnalysisUserPrompt(sentence, targetWord);
 
     nlohmann::json payload = {{"system_instruction", {{"parts", {{{"text", language.GetAnalysisSystemPrompt()}}}}}},
@@ -264,7 +281,7 @@ namespace Image2Card::AI
 #endif
 
     std::string endpoint = "/v1beta/models/" + m_SentenceModel + ":generateContent";
-    auto response = SendRequest(endpoint, payload);
+    auto response = SendRequest(endpoint, payload, cancellation);
 
     if (!response.is_null() && response.contains("candidates") && !response["candidates"].empty()) {
       auto& candidate = response["candidates"][0];
@@ -4,6 +4,8 @@
 #include <string>
 #include <vector>
 
+#include "core/CancellationToken.h"
+
 namespace Image2Card::AI
 {
 
@@ -31,7 +33,8 @@ public:
     virtual std::vector<unsigned char> GenerateAudio(const std::string& text,
                                                      const std::string& voiceId = "",
                                                      const std::string& languageCode = "",
-                                                     const std::string& format = "mp3") = 0;
+                                                     const std::string& format = "mp3",
+                                                     const Core::CancellationToken& cancellation = {}) = 0;
   };
 
 } // namespace Image2Card::AI
@@ -4,6 +4,9 @@
 #include <string>
 #include <vector>
 
+#include "ai/ImageUpload.h"
+#include "core/CancellationToken.h"
+
 namespace Image2Card::Language
 {
   class ILanguage;
@@ -28,13 +31,20 @@ public:
 
     virtual void LoadRemoteModels() = 0;
 
+    /**
+   * Largest image and the format the vision model reads well; uploads are prepared to match.
+   */
+    virtual ImageUploadLimits GetImageUploadLimits() const { return {}; }
+
     virtual std::string ExtractTextFromImage(const std::vector<unsigned char>& imageBuffer,
                                              const std::string& mimeType,
-                                             const Language::ILanguage& language) = 0;
+                                             const Language::ILanguage& language,
+                                             const Core::CancellationToken& cancellation = {}) = 0;
 
     virtual nlohmann::json AnalyzeSentence(const std::string& sentence,
                                            const std::string& targetWord,
-                                           const Language::ILanguage& language) = 0;
+                                           const Language::ILanguage& language,
+                                           const Core::CancellationToken& cancellation = {}) = 0;
   };
 
 } // namespace Image2Card::AI
@@ -0,0 +1,142 @@
+#include "ai/ImageUpload.h"
+
+#include <chrono>
+
+#include "core/Logger.h"
+#include "core/Trace.h"
+#include "utils/ImageProcessor.h"
+
+namespace Image2Card::AI
+{
+
+  namespace
+  {
+    using Clock = std::chrono::steady_clock;
+
+    double MillisecondsSince(Clock::time_point begin)
+    {
+      return std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+    }
+
+    size_t SourceBytes(const Utils::ImageView& image)
+    {
+      return (size_t) image.width * image.height * Utils::BytesPerPixel(image.format);
+    }
+  } // namespace
+
+  PreparedImage ImageUpload::Prepare(const Utils::ImageView& image, const ImageUploadLimits& limits)
+  {
+    AF_TRACE_SCOPE("ai", "Prepare image upload");
+    auto start = Clock::now();
+
+    Utils::ImageBuffer scaled = Utils::ImageProcessor::DownscaleToFit(image, limits.maxDimension);
+    Utils::ImageView source = scaled.IsEmpty() ? image : scaled.View();
+
+    PreparedImage prepared;
+    prepared.width = source.width;
+    prepared.height = source.height;
+    prepared.sourceBytes = SourceBytes(image);
+    if (limits.mimeType == "image/jpeg") {
+      prepared.bytes = Utils::ImageProcessor::EncodeJPEG(source, limits.quality);
+      prepared.mimeType = "image/jpeg";
+    } else {
+      prepared.bytes = Utils::ImageProcessor::EncodeWebP(source, limits.quality);
+      prepared.mimeType = "image/webp";
+    }
+
+    // Never send nothing because a lossy encoder failed; the PNG is larger but readable.
+    if (prepared.bytes.empty()) {
+      AF_WARN("Encoding the upload as {} failed, sending PNG", limits.mimeType);
+      return PreparePNG(image);
+    }
+    prepared.encodeMs = MillisecondsSince(start);
+    return prepared;
+  }
+
+  PreparedImage ImageUpload::PreparePNG(const Utils::ImageView& image)
+  {
+    auto start = Clock::now();
+    PreparedImage prepared;
+    prepared.bytes = Utils::ImageProcessor::EncodePNG(image);
+    prepared.mimeType = "image/png";
+    prepared.width = image.width;
+    prepared.height = image.height;
+    prepared.sourceBytes = SourceBytes(image);
+    prepared.pngBytes = prepared.bytes.size();
+    prepared.encodeMs = MillisecondsSince(start);
+    return prepared;
+  }
+
+  PreparedImage ImageUpload::PrepareFor(const Utils::ImageView& image, const ImageUploadLimits& limits)
+  {
+    if (!m_Optimize.load()) {
+      return PreparePNG(image);
+    }
+
+    PreparedImage prepared = Prepare(image, limits);
+    if (prepared.pngBytes == 0 && TakePNGSample()) {
+      prepared.pngBytes = Utils::ImageProcessor::EncodePNG(image).size();
+    }
+    return prepared;
+  }
+
+  bool ImageUpload::TakePNGSample()
+  {
+    // Stops at zero, so the counter cannot wrap around after many uploads.
+    int left = m_PNGSamplesLeft.load();
+    while (left > 0) {
+      if (m_PNGSamplesLeft.compare_exchange_weak(left, left - 1)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void ImageUpload::Record(const PreparedImage& image, double requestMs)
+  {
+    bool optimized = image.mimeType != "image/png";
+    Totals optimizedTotals;
+    Totals pngTotals;
+    double pngRatio = 0.0;
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      Totals& totals = optimized ? m_Optimized : m_PNG;
+      ++totals.uploads;
+      totals.bytes += image.bytes.size();
+      totals.sourceBytes += image.sourceBytes;
+      totals.requestMs += requestMs;
+      if (image.pngBytes > 0) {
+        m_PNGSampleBytes += image.pngBytes;
+        m_PNGSampleSource += image.sourceBytes;
+      }
+      optimizedTotals = m_Optimized;
+      pngTotals = m_PNG;
+      pngRatio = m_PNGSampleSource ? (double) m_PNGSampleBytes / m_PNGSampleSource : 0.0;
+    }
+
+    AF_INFO("AI upload: {}x{} {} {} KB (PNG {} KB), encoded in {:.0f} ms, request {:.0f} ms",
+            image.width,
+            image.height,
+            image.mimeType,
+            image.bytes.size() / 1024,
+            image.pngBytes ? std::to_string(image.pngBytes / 1024) : "?",
+            image.encodeMs,
+            requestMs);
+
+    // PNG size of the other crops is estimated from the ones that were measured.
+    if (optimizedTotals.uploads > 0 && pngRatio > 0.0) {
+      double pngBytes = optimizedTotals.sourceBytes * pngRatio;
+      AF_INFO("AI uploads: {} optimized, {:.0f} KB saved against PNG ({:.0f}% smaller)",
+              optimizedTotals.uploads,
+              (pngBytes - optimizedTotals.bytes) / 1024.0,
+              pngBytes > 0.0 ? (1.0 - optimizedTotals.bytes / pngBytes) * 100.0 : 0.0);
+    }
+    if (optimizedTotals.uploads > 0 && pngTotals.uploads > 0) {
+      AF_INFO("AI uploads: average request {:.0f} ms optimized vs {:.0f} ms PNG ({:.0f} ms saved)",
+              optimizedTotals.AverageMs(),
+              pngTotals.AverageMs(),
+              pngTotals.AverageMs() - optimizedTotals.AverageMs());
+    }
+  }
+
+} // namespace Image2Card::AI
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "utils/ImageView.h"
+
+namespace Image2Card::AI
+{
+
+  /**
+   * What a vision provider accepts and still reads well: models resample large
+   * images anyway, so anything above maxDimension only costs upload time.
+   */
+  struct ImageUploadLimits
+  {
+    int maxDimension = 2048;
+    std::string mimeType = "image/webp"; // "image/webp" or "image/jpeg"
+    int quality = 90;                    // High enough to keep thin strokes and small kana sharp
+  };
+
+  struct PreparedImage
+  {
+    std::vector<unsigned char> bytes;
+    std::string mimeType;
+    int width = 0;
+    int height = 0;
+    size_t sourceBytes = 0; // Uncompressed size of the crop before downscaling
+    size_t pngBytes = 0;    // Full-size PNG of the same crop when it was measured, 0 if unknown
+    double encodeMs = 0.0;
+  };
+
+  /**
+ * Prepares crops for vision model requests: downscales them to the provider's
+ * limit and encodes them as lossy WebP or JPEG instead of full-size PNG, then
+ * keeps running totals of upload size and request time for optimized and PNG
+ * uploads so the savings can be logged. Safe to use from several threads.
+ */
+  class ImageUpload
+  {
+public:
+
+    /**
+   * Downscale and encode for the given provider limits.
+   */
+    [[nodiscard]] static PreparedImage Prepare(const Utils::ImageView& image, const ImageUploadLimits& limits);
+
+    /**
+   * Full-size PNG, as sent before uploads were optimized.
+   */
+    [[nodiscard]] static PreparedImage PreparePNG(const Utils::ImageView& image);
+
+    /**
+   * Prepare when optimization is enabled, PreparePNG otherwise. The first few optimized
+   * uploads are also encoded as PNG, to know how many bytes the optimization saves.
+   */
+    [[nodiscard]] PreparedImage PrepareFor(const Utils::ImageView& image, const ImageUploadLimits& limits);
+
+    void SetOptimize(bool optimize) { m_Optimize.store(optimize); }
+    [[nodiscard]] bool IsOptimizing() const { return m_Optimize.load(); }
+
+    /**
+   * Add a finished request to the totals and log the bytes and time saved so far.
+   * @param image What was uploaded
+   * @param requestMs Time the provider took to answer
+   */
+    void Record(const PreparedImage& image, double requestMs);
+
+private:
+
+    struct Totals
+    {
+      size_t uploads = 0;
+      size_t bytes = 0;
+      size_t sourceBytes = 0;
+      double requestMs = 0.0;
+
+      [[nodiscard]] double AverageMs() const { return uploads ? requestMs / uploads : 0.0; }
+    };
+
+    // Claim one of the remaining PNG size samples, if any are left.
+    bool TakePNGSample();
+
+    std::atomic<bool> m_Optimize{true};
+    std::atomic<int> m_PNGSamplesLeft{3};
+    std::mutex m_Mutex;
+    Totals m_Optimized;
+    Totals m_PNG;
+    size_t m_PNGSampleBytes = 0;  // PNG sizes measured for any upload
+    size_t m_PNGSampleSource = 0; // Uncompressed sizes of the same crops
+  };
+
+} // namespace Image2Card::AI
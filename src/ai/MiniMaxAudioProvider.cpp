@@ -9,9 +9,10 @@
 #include <iostream>
 #include <miniaudio.h>
 #include <sstream>
-#include <thread>
 
 #include "core/Logger.h"
+#include "core/TaskExecutor.h"
+#include "core/Trace.h"
 
 namespace Image2Card::AI
 {
@@ -33,7 +34,7 @@ namespace Image2Card::AI
     }
 
     if (ImGui::Button("Load Voices")) {
-      std::thread([this]() { LoadRemoteVoices(); }).detach();
+      Core::TaskExecutor::Get().Post(Core::TaskPriority::Interactive, [this]() { LoadRemoteVoices(); });
       changed = true;
     }
 
@@ -313,19 +314,25 @@ namespace Image2Card::AI
   std::vector<unsigned char> MiniMaxAudioProvider::GenerateAudio(const std::string& text,
                                                                  const std::string& voiceId,
                                                                  const std::string& languageCode,
-                                                                 const std::string& format)
+                                                                 const std::string& format,
+                                                                 const Core::CancellationToken& cancellation)
   {
+    AF_TRACE_SCOPE("tts", "MiniMax");
     std::string targetVoiceId = voiceId.empty() ? m_VoiceId : voiceId;
 
     if (m_ApiKey.empty() || targetVoiceId.empty()) {
       AF_ERROR("MiniMaxAudioProvider Error: API Key or Voice ID is missing.");
       return {};
     }
+    if (cancellation.IsCancelled()) {
+      AF_INFO("MiniMaxAudioProvider: request cancelled before sending");
+      return {};
+    }
 
     try {
       httplib::Client cli("https://api.minimax.io");
-      cli.set_connection_timeout(120);
-      cli.set_read_timeout(120);
+      cli.set_connection_timeout(cancellation.ClampTimeout(std::chrono::seconds(120)));
+      cli.set_read_timeout(cancellation.ClampTimeout(std::chrono::seconds(120)));
 
       httplib::Headers headers = {{"Authorization", "Bearer " + m_ApiKey}, {"Content-Type", "application/json"}};
 
@@ -344,8 +351,14 @@ namespace Image2Card::AI
         payload["language_boost"] = languageCode;
       }
 
+      Core::ScopedCancellationCallback stopOnCancel(cancellation, [&cli]() { cli.stop(); });
       auto res = cli.Post("/v1/t2a_v2", headers, payload.dump(), "application/json");
 
+      if (!res && cancellation.IsCancelled()) {
+        AF_INFO("MiniMaxAudioProvider: request cancelled");
+        return {};
+      }
+
       if (res && res->status == 200) {
         auto json = nlohmann::json::parse(res->body);
 
@@ -1,6 +1,7 @@
 #include "ai/NativeAudioProvider.h"
 
 #include "ai/native/NativeAudioProviderInternal.h"
+#include "core/Trace.h"
 
 namespace Image2Card::AI
 {
@@ -57,8 +58,14 @@ namespace Image2Card::AI
   std::vector<unsigned char> NativeAudioProvider::GenerateAudio(const std::string& text,
                                                                 const std::string& voiceId,
                                                                 const std::string& languageCode,
-                                                                const std::string& format)
+                                                                const std::string& format,
+                                                                const Core::CancellationToken& cancellation)
   {
+    AF_TRACE_SCOPE("tts", "Native TTS");
+    // Platform speech synthesis is local and short, so cancellation is only checked up front.
+    if (cancellation.IsCancelled()) {
+      return {};
+    }
     return m_Impl->m_PlatformImpl->GenerateAudio(text, voiceId, languageCode, format);
   }
 
@@ -34,7 +34,8 @@ public:
     std::vector<unsigned char> GenerateAudio(const std::string& text,
                                              const std::string& voiceId = "",
                                              const std::string& languageCode = "",
-                                             const std::string& format = "mp3") override;
+                                             const std::string& format = "mp3",
+                                             const Core::CancellationToken& cancellation = {}) override;
 
 private:
 
@@ -8,9 +8,10 @@
 #include <httplib.h>
 #include <iostream>
 #include <sstream>
-#include <thread>
 
 #include "core/Logger.h"
+#include "core/TaskExecutor.h"
+#include "core/Trace.h"
 #include "language/ILanguage.h"
 #include "utils/Base64Utils.h"
 
@@ -42,7 +43,7 @@ namespace Image2Card::AI
     } else {
       if (ImGui::Button("Load Models")) {
         m_CancelLoadModels.store(false);
-        std::thread([this]() { LoadRemoteModels(); }).detach();
+        Core::TaskExecutor::Get().Post(Core::TaskPriority::Interactive, [this]() { LoadRemoteModels(); });
         changed = true;
       }
     }
@@ -122,22 +123,34 @@ namespace Image2Card::AI
     m_IsLoadingModels = false;
   }
 
-  nlohmann::json XAiTextProvider::SendRequest(const std::string& endpoint, const nlohmann::json& payload)
+  nlohmann::json XAiTextProvider::SendRequest(const std::string& endpoint,
+                                              const nlohmann::json& payload,
+                                              const Core::CancellationToken& cancellation)
   {
     if (m_ApiKey.empty()) {
       AF_ERROR("XAiTextProvider Error: API Key is missing.");
       return nullptr;
     }
+    if (cancellation.IsCancelled()) {
+      AF_INFO("XAiTextProvider: request cancelled before sending");
+      return nullptr;
+    }
 
     try {
       httplib::Client cli("https://api.x.ai");
-      cli.set_connection_timeout(120);
-      cli.set_read_timeout(120);
+      cli.set_connection_timeout(cancellation.ClampTimeout(std::chrono::seconds(120)));
+      cli.set_read_timeout(cancellation.ClampTimeout(std::chrono::seconds(120)));
 
       httplib::Headers headers = {{"Authorization", "Bearer " + m_ApiKey}, {"Content-Type", "application/json"}};
 
+      Core::ScopedCancellationCallback stopOnCancel(cancellation, [&cli]() { cli.stop(); });
       auto res = cli.Post(endpoint, headers, payload.dump(), "application/json");
 
+      if (!res && cancellation.IsCancelled()) {
+        AF_INFO("XAiTextProvider: request cancelled");
+        return nullptr;
+      }
+
       if (res && res->status == 200) {
         return nlohmann::json::parse(res->body);
       } else {
@@ -154,8 +167,10 @@ namespace Image2Card::AI
 
   std::string XAiTextProvider::ExtractTextFromImage(const std::vector<unsigned char>& imageBuffer,
                                                     const std::string& mimeType,
-                                                    const Language::ILanguage& language)
+                                                    const Language::ILanguage& language,
+                                                    const Core::CancellationToken& cancellation)
   {
+    AF_TRACE_SCOPE("ocr", "xAI vision OCR");
     if (imageBuffer.empty())
       return "";
 
@@ -199,7 +214,7 @@ namespace Image2Card::AI
     }
 #endif
 
-    auto response = SendRequest("/v1/chat/completions", payload);
+    auto response = SendRequest("/v1/chat/completions", payload, cancellation);
     if (!response.is_null() && response.contains("choices") && !response["choices"].empty()) {
       if (response.contains("usage")) {
         AF_INFO("xAI Token Usage (OCR): Prompt={}, Completion={}, Total={}",
@@ -256,8 +271,10 @@ namespace Image2Card::AI
 
   nlohmann::json XAiTextProvider::AnalyzeSentence(const std::string& sentence,
                                                   const std::string& targetWord,
-                                                  const Language::ILanguage& language)
+                                                  const Language::ILanguage& language,
+                                                  const Core::CancellationToken& cancellation)
   {
+    AF_TRACE_SCOPE("analysis", "xAI sentence analysis");
     std::string prompt = language.GetAnalysisUserPrompt(sentence, targetWord);
 
     AF_INFO("AnalyzeSentence Prompt: {}", prompt);
@@ -274,7 +291,7 @@ namespace Image2Card::AI
     AF_DEBUG("Sending Analysis Request: {}", payload.dump(2));
 #endif
 
-    auto response = SendRequest("/v1/chat/completions", payload);
+    auto response = SendRequest("/v1/chat/completions", payload, cancellation);
     if (!response.is_null() && response.contains("choices") && !response["choices"].empty()) {
       if (response.contains("usage")) {
         AF_INFO("xAI Token Usage (Analysis): Prompt={}, Completion={}, Total={}",
@@ -26,16 +26,23 @@ public:
 
     void LoadRemoteModels() override;
 
+    // Grok vision accepts JPEG and PNG only.
+    ImageUploadLimits GetImageUploadLimits() const override { return {2048, "image/jpeg", 90}; }
+
     std::string ExtractTextFromImage(const std::vector<unsigned char>& imageBuffer,
                                      const std::string& mimeType,
-                                     const Language::ILanguage& language) override;
+                                     const Language::ILanguage& language,
+                                     const Core::CancellationToken& cancellation = {}) override;
     nlohmann::json AnalyzeSentence(const std::string& sentence,
                                    const std::string& targetWord,
-                                   const Language::ILanguage& language) override;
+                                   const Language::ILanguage& language,
+                                   const Core::CancellationToken& cancellation = {}) override;
 
 private:
 
-    nlohmann::json SendRequest(const std::string& endpoint, const nlohmann::json& payload);
+    nlohmann::json SendRequest(const std::string& endpoint,
+                               const nlohmann::json& payload,
+                               const Core::CancellationToken& cancellation);
 
     std::string m_ApiKey;
     std::string m_VisionModel = "grok-2-vision-1212";
@@ -1,33 +1,268 @@
 #include "api/AnkiConnectClient.h"
 
+#include <fcntl.h>
+#include <future>
 #include <httplib.h>
 #include <iostream>
+#include <set>
+
+#ifdef _WIN32
+#include <io.h>
+#include <process.h>
+#include <sys/stat.h>
+#else
+#include <cerrno>
+#include <cstdlib>
+#include <unistd.h>
+#endif
 
 #include "core/Logger.h"
+#include "core/TaskExecutor.h"
+#include "core/Trace.h"
+#include "utils/Base64Utils.h"
 
 namespace Image2Card::API
 {
 
+  namespace
+  {
+    // Enough for the requests a scan, a card add and a background refresh make at once.
+    constexpr size_t MaxIdleConnections = 4;
+
+    // Concurrent media uploads to a remote AnkiConnect, one connection each.
+    constexpr size_t MaxConcurrentUploads = MaxIdleConnections;
+
+    bool IsLoopbackUrl(const std::string& url)
+    {
+      std::string host = url;
+      size_t scheme = host.find("://");
+      if (scheme != std::string::npos) {
+        host = host.substr(scheme + 3);
+      }
+      host = host.substr(0, host.find('/'));
+      if (host.starts_with('[')) {
+        host = host.substr(1, host.find(']') - 1);
+      } else {
+        host = host.substr(0, host.find(':'));
+      }
+      return host == "localhost" || host == "::1" || host.starts_with("127.");
+    }
+
+    // A fresh directory only this user can enter, so no one else can read the media, or plant
+    // files and links where it is written.
+    std::filesystem::path CreatePrivateMediaDirectory()
+    {
+      std::error_code error;
+      std::filesystem::path base = std::filesystem::temp_directory_path(error);
+      if (error) {
+        return {};
+      }
+#ifdef _WIN32
+      // The temporary directory is inside the user's profile already.
+      std::filesystem::path directory = base / ("image2card-media-" + std::to_string(_getpid()));
+      std::filesystem::create_directory(directory, error);
+      return error ? std::filesystem::path() : directory;
+#else
+      std::string pattern = (base / "image2card-media-XXXXXX").string();
+      if (!mkdtemp(pattern.data())) {
+        return {};
+      }
+      return pattern;
+#endif
+    }
+
+    // Fails instead of following a link or writing into a file that exists already.
+    bool WriteNewFile(const std::filesystem::path& path, const std::vector<unsigned char>& data)
+    {
+#ifdef _WIN32
+      int fd = _wopen(path.c_str(), _O_WRONLY | _O_CREAT | _O_EXCL | _O_BINARY, _S_IREAD | _S_IWRITE);
+      if (fd < 0) {
+        return false;
+      }
+      bool ok = _write(fd, data.data(), (unsigned int) data.size()) == (int) data.size();
+      return _close(fd) == 0 && ok;
+#else
+      int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC, 0600);
+      if (fd < 0) {
+        return false;
+      }
+      size_t written = 0;
+      while (written < data.size()) {
+        ssize_t count = write(fd, data.data() + written, data.size() - written);
+        if (count < 0 && errno == EINTR) {
+          continue;
+        }
+        if (count <= 0) {
+          break;
+        }
+        written += (size_t) count;
+      }
+      return close(fd) == 0 && written == data.size();
+#endif
+    }
+
+    // Uploads no worker has picked up yet run here instead of being waited for.
+    void WaitForUploads(Core::TaskGroup& group, std::vector<std::future<void>>& uploads)
+    {
+      for (auto& upload : uploads) {
+        group.Wait(upload);
+        try {
+          upload.get();
+        } catch (const std::exception& e) {
+          AF_ERROR("AnkiConnect: media upload failed: {}", e.what());
+        }
+      }
+    }
+
+    std::string ErrorOf(const nlohmann::json& response)
+    {
+      if (!response.is_object() || !response.contains("error") || response["error"].is_null()) {
+        return {};
+      }
+      const auto& error = response["error"];
+      return error.is_string() ? error.get<std::string>() : error.dump();
+    }
+  } // namespace
+
   AnkiConnectClient::AnkiConnectClient(std::string url)
   {
     SetUrl(std::move(url));
   }
 
+  AnkiConnectClient::~AnkiConnectClient()
+  {
+    if (!m_MediaDirectory.empty()) {
+      std::error_code error;
+      std::filesystem::remove_all(m_MediaDirectory, error);
+    }
+  }
+
   void AnkiConnectClient::SetUrl(const std::string& url)
   {
-    m_Url = url;
-    size_t pos = m_Url.find("localhost");
+    std::string resolved = url;
+    size_t pos = resolved.find("localhost");
     if (pos != std::string::npos) {
-      m_Url.replace(pos, 9, "127.0.0.1");
+      resolved.replace(pos, 9, "127.0.0.1");
+    }
+
+    std::vector<std::unique_ptr<httplib::Client>> closing;
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_LoopbackUrl = IsLoopbackUrl(resolved);
+    m_Url = std::move(resolved);
+    ++m_UrlGeneration;
+    closing.swap(m_IdleConnections);
+  }
+
+  void AnkiConnectClient::SetConnectionReuse(bool reuse)
+  {
+    std::vector<std::unique_ptr<httplib::Client>> closing;
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_ReuseConnections = reuse;
+    if (!reuse) {
+      closing.swap(m_IdleConnections);
+    }
+  }
+
+  void AnkiConnectClient::SetLocalMediaPaths(bool enabled)
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_LocalMediaPaths = enabled;
+    m_LocalMediaPathsFailed = false;
+  }
+
+  bool AnkiConnectClient::UsesLocalMediaPaths() const
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_LocalMediaPaths && m_LoopbackUrl && !m_LocalMediaPathsFailed;
+  }
+
+  void AnkiConnectClient::DisableLocalMediaPaths(const std::string& error)
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (!m_LocalMediaPathsFailed) {
+      m_LocalMediaPathsFailed = true;
+      AF_WARN("AnkiConnect cannot read media files by path ({}), sending their data instead", error);
+    }
+  }
+
+  std::filesystem::path AnkiConnectClient::WriteLocalMediaFile(const AnkiMediaFile& file)
+  {
+    std::filesystem::path directory;
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      if (m_MediaDirectory.empty()) {
+        m_MediaDirectory = CreatePrivateMediaDirectory();
+      }
+      directory = m_MediaDirectory;
     }
+    if (directory.empty()) {
+      AF_WARN("AnkiConnect: cannot create a private media directory");
+      return {};
+    }
+
+    // The same name may be written by two requests at once, so each write gets its own file.
+    std::string name = std::filesystem::path(file.filename).filename().string();
+    std::filesystem::path path = directory / (std::to_string(m_MediaFileCounter.fetch_add(1)) + "_" + name);
+    if (!WriteNewFile(path, file.data)) {
+      AF_WARN("AnkiConnect: cannot write {}", path.string());
+      std::error_code error;
+      std::filesystem::remove(path, error);
+      return {};
+    }
+    return path;
+  }
+
+  std::unique_ptr<httplib::Client> AnkiConnectClient::AcquireConnection(uint64_t& generation)
+  {
+    std::string url;
+    bool reuse = false;
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      generation = m_UrlGeneration;
+      if (!m_IdleConnections.empty()) {
+        auto connection = std::move(m_IdleConnections.back());
+        m_IdleConnections.pop_back();
+        return connection;
+      }
+      url = m_Url;
+      reuse = m_ReuseConnections;
+    }
+
+    auto connection = std::make_unique<httplib::Client>(url);
+    connection->set_keep_alive(reuse);
+    m_ConnectionsOpened.fetch_add(1);
+    return connection;
   }
 
-  nlohmann::json AnkiConnectClient::Execute(const std::string& action, const nlohmann::json& params)
+  void AnkiConnectClient::ReleaseConnection(std::unique_ptr<httplib::Client> connection, uint64_t generation)
   {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (m_ReuseConnections && generation == m_UrlGeneration && m_IdleConnections.size() < MaxIdleConnections) {
+      m_IdleConnections.push_back(std::move(connection));
+    }
+  }
+
+  nlohmann::json AnkiConnectClient::Execute(const std::string& action,
+                                            const nlohmann::json& params,
+                                            const Core::CancellationToken& cancellation,
+                                            httplib::Error* transportError)
+  {
+    AF_TRACE_SCOPE("anki", action);
+    if (transportError) {
+      *transportError = httplib::Error::Success;
+    }
+    if (cancellation.IsCancelled()) {
+      AF_INFO("AnkiConnect: '{}' cancelled before sending", action);
+      return nullptr;
+    }
+
+    uint64_t generation = 0;
+    std::unique_ptr<httplib::Client> cli = AcquireConnection(generation);
+    bool reusable = false;
+    nlohmann::json result = nullptr;
     try {
-      httplib::Client cli(m_Url);
-      cli.set_connection_timeout(120);
-      cli.set_read_timeout(120);
+      cli->set_connection_timeout(cancellation.ClampTimeout(std::chrono::seconds(120)));
+      cli->set_read_timeout(cancellation.ClampTimeout(std::chrono::seconds(120)));
 
       nlohmann::json request;
       request["action"] = action;
@@ -36,73 +271,85 @@ namespace Image2Card::API
         request["params"] = params;
       }
 
-      auto res = cli.Post("/", request.dump(), "application/json");
+      Core::ScopedCancellationCallback stopOnCancel(cancellation, [&cli]() { cli->stop(); });
+      auto res = cli->Post("/", request.dump(), "application/json");
 
-      if (!res) {
+      if (!res && cancellation.IsCancelled()) {
+        AF_INFO("AnkiConnect: request cancelled");
+      } else if (!res) {
+        if (transportError) {
+          *transportError = res.error();
+        }
+        std::lock_guard<std::mutex> lock(m_Mutex);
         AF_ERROR("AnkiConnect Connection Error: {} ({})", httplib::to_string(res.error()), m_Url);
-        return nullptr;
-      }
-
-      if (res->status != 200) {
-        AF_ERROR("AnkiConnect HTTP Error: {}", res->status);
-        return nullptr;
-      }
-
-      auto response = nlohmann::json::parse(res->body);
-      if (!response["error"].is_null()) {
-        AF_ERROR("AnkiConnect Error ({}): {}", action, response["error"].dump());
-        return nullptr;
+      } else {
+        // Only a complete response leaves the connection in a state the next request can use.
+        reusable = !cancellation.IsCancelled();
+        if (res->status != 200) {
+          AF_ERROR("AnkiConnect HTTP Error: {}", res->status);
+        } else {
+          auto response = nlohmann::json::parse(res->body);
+          if (!response["error"].is_null()) {
+            AF_ERROR("AnkiConnect Error ({}): {}", action, response["error"].dump());
+          } else {
+            result = response["result"];
+          }
+        }
       }
-      return response["result"];
     } catch (const std::exception& e) {
       AF_ERROR("AnkiConnect Exception: {}", e.what());
-      return nullptr;
     }
+
+    if (reusable) {
+      ReleaseConnection(std::move(cli), generation);
+    }
+    return result;
   }
 
-  bool AnkiConnectClient::Ping()
+  bool AnkiConnectClient::Ping(const Core::CancellationToken& cancellation)
   {
-    auto result = Execute("version");
+    auto result = Execute("version", nullptr, cancellation);
     return !result.is_null();
   }
 
-  std::vector<std::string> AnkiConnectClient::GetDeckNames()
+  std::vector<std::string> AnkiConnectClient::GetDeckNames(const Core::CancellationToken& cancellation)
   {
     std::vector<std::string> decks;
-    auto result = Execute("deckNames");
+    auto result = Execute("deckNames", nullptr, cancellation);
     if (result.is_array()) {
       decks = result.get<std::vector<std::string>>();
     }
     return decks;
   }
 
-  std::vector<std::string> AnkiConnectClient::GetModelNames()
+  std::vector<std::string> AnkiConnectClient::GetModelNames(const Core::CancellationToken& cancellation)
   {
     std::vector<std::string> models;
-    auto result = Execute("modelNames");
+    auto result = Execute("modelNames", nullptr, cancellation);
     if (result.is_array()) {
       models = result.get<std::vector<std::string>>();
     }
     return models;
   }
 
-  std::vector<std::string> AnkiConnectClient::GetModelFieldNames(const std::string& modelName)
+  std::vector<std::string> AnkiConnectClient::GetModelFieldNames(const std::string& modelName,
+                                                                const Core::CancellationToken& cancellation)
   {
     std::vector<std::string> fields;
     nlohmann::json params;
     params["modelName"] = modelName;
 
-    auto result = Execute("modelFieldNames", params);
+    auto result = Execute("modelFieldNames", params, cancellation);
     if (result.is_array()) {
       fields = result.get<std::vector<std::string>>();
     }
     return fields;
   }
 
-  int64_t AnkiConnectClient::AddNote(const std::string& deckName,
-                                     const std::string& modelName,
-                                     const std::map<std::string, std::string>& fields,
-                                     const std::vector<std::string>& tags)
+  nlohmann::json AnkiConnectClient::NoteToJson(const std::string& deckName,
+                                               const std::string& modelName,
+                                               const std::map<std::string, std::string>& fields,
+                                               const std::vector<std::string>& tags)
   {
     nlohmann::json note;
     note["deckName"] = deckName;
@@ -114,47 +361,318 @@ namespace Image2Card::API
     }
     note["fields"] = fieldsJson;
     note["tags"] = tags;
+    return note;
+  }
 
+  int64_t AnkiConnectClient::AddNote(const std::string& deckName,
+                                     const std::string& modelName,
+                                     const std::map<std::string, std::string>& fields,
+                                     const std::vector<std::string>& tags,
+                                     const Core::CancellationToken& cancellation)
+  {
     nlohmann::json params;
-    params["note"] = note;
+    params["note"] = NoteToJson(deckName, modelName, fields, tags);
 
-    auto result = Execute("addNote", params);
+    auto result = Execute("addNote", params, cancellation);
     if (result.is_number_integer()) {
       return result.get<int64_t>();
     }
     return 0;
   }
 
-  std::vector<int64_t> AnkiConnectClient::FindNotes(const std::string& query)
+  std::vector<int64_t> AnkiConnectClient::FindNotes(const std::string& query,
+                                                    const Core::CancellationToken& cancellation)
   {
     std::vector<int64_t> noteIds;
     nlohmann::json params;
     params["query"] = query;
 
-    auto result = Execute("findNotes", params);
+    auto result = Execute("findNotes", params, cancellation);
     if (result.is_array()) {
       noteIds = result.get<std::vector<int64_t>>();
     }
     return noteIds;
   }
 
-  bool AnkiConnectClient::StoreMediaFile(const std::string& filename, const std::string& base64Data)
+  std::vector<AnkiNoteInfo> AnkiConnectClient::NotesInfo(const std::vector<int64_t>& noteIds,
+                                                         const Core::CancellationToken& cancellation)
   {
+    std::vector<AnkiNoteInfo> notes;
+    if (noteIds.empty()) {
+      return notes;
+    }
+
     nlohmann::json params;
-    params["filename"] = filename;
-    params["data"] = base64Data;
+    params["notes"] = noteIds;
 
-    auto result = Execute("storeMediaFile", params);
+    auto result = Execute("notesInfo", params, cancellation);
+    if (!result.is_array()) {
+      return notes;
+    }
+    notes.reserve(result.size());
+    for (const auto& entry : result) {
+      // Ids of deleted notes come back as empty objects.
+      if (!entry.is_object() || !entry.contains("noteId")) {
+        continue;
+      }
+      AnkiNoteInfo note;
+      note.noteId = entry["noteId"].get<int64_t>();
+      note.modelName = entry.value("modelName", "");
+      note.modified = entry.value("mod", (int64_t) 0);
+      if (entry.contains("fields") && entry["fields"].is_object()) {
+        for (const auto& [name, field] : entry["fields"].items()) {
+          note.fields[name] = field.value("value", "");
+        }
+      }
+      notes.push_back(std::move(note));
+    }
+    return notes;
+  }
+
+  bool AnkiConnectClient::StoreMediaFile(const AnkiMediaFile& file, const Core::CancellationToken& cancellation)
+  {
+    std::filesystem::path path = UsesLocalMediaPaths() ? WriteLocalMediaFile(file) : std::filesystem::path();
+    if (path.empty()) {
+      return StoreMediaData(file, cancellation);
+    }
+
+    nlohmann::json actions = nlohmann::json::array();
+    actions.push_back(
+        {{"action", "storeMediaFile"}, {"params", {{"filename", file.filename}, {"path", path.string()}}}});
+    auto responses = Multi(actions, cancellation);
+    std::error_code error;
+    std::filesystem::remove(path, error);
+
+    // A versioned multi reports a path AnkiConnect cannot read as an error of the action instead of failing.
+    if (responses.is_null()) {
+      return false;
+    }
+    std::string actionError = ErrorOf(responses[0]);
+    if (actionError.empty()) {
+      return true;
+    }
+    DisableLocalMediaPaths(actionError);
+    return StoreMediaData(file, cancellation);
+  }
+
+  bool AnkiConnectClient::StoreMediaData(const AnkiMediaFile& file, const Core::CancellationToken& cancellation)
+  {
+    nlohmann::json params;
+    params["filename"] = file.filename;
+    params["data"] = Utils::Base64Utils::Encode(file.data);
+
+    auto result = Execute("storeMediaFile", params, cancellation);
     return !result.is_null();
   }
 
-  bool AnkiConnectClient::GuiBrowse(int64_t cardId)
+  std::vector<std::future<void>> AnkiConnectClient::StartMediaUploads(const std::vector<const AnkiMediaFile*>& files,
+                                                                      std::vector<char>& stored,
+                                                                      Core::TaskGroup& group,
+                                                                      const Core::CancellationToken& cancellation)
+  {
+    // Each uploader takes the next file until none are left, so a large file does not hold up the others.
+    auto next = std::make_shared<std::atomic<size_t>>(0);
+    auto upload = [this, &files, &stored, next, cancellation]() {
+      AF_TRACE_SCOPE("anki", "Upload media");
+      for (size_t i = next->fetch_add(1); i < files.size(); i = next->fetch_add(1)) {
+        stored[i] = StoreMediaData(*files[i], cancellation);
+        if (!stored[i]) {
+          AF_WARN("AnkiConnect: storing {} failed", files[i]->filename);
+        }
+      }
+    };
+
+    std::vector<std::future<void>> uploads;
+    for (size_t i = 0; i < std::min(files.size(), MaxConcurrentUploads); ++i) {
+      uploads.push_back(group.Submit(upload));
+    }
+    return uploads;
+  }
+
+  bool AnkiConnectClient::GuiBrowse(int64_t cardId, const Core::CancellationToken& cancellation)
   {
     nlohmann::json params;
     params["query"] = "cid:" + std::to_string(cardId);
 
-    auto result = Execute("guiBrowse", params);
+    auto result = Execute("guiBrowse", params, cancellation);
     return !result.is_null();
   }
 
+  nlohmann::json AnkiConnectClient::Multi(const nlohmann::json& actions,
+                                          const Core::CancellationToken& cancellation,
+                                          httplib::Error* transportError)
+  {
+    // Versioned sub-actions report {"result", "error"} each instead of failing the whole batch.
+    nlohmann::json versioned = nlohmann::json::array();
+    for (const auto& action : actions) {
+      nlohmann::json entry = action;
+      entry["version"] = 6;
+      versioned.push_back(std::move(entry));
+    }
+
+    nlohmann::json params;
+    params["actions"] = versioned;
+
+    auto result = Execute("multi", params, cancellation, transportError);
+    if (result.is_null()) {
+      return nullptr;
+    }
+    if (!result.is_array() || result.size() != actions.size()) {
+      AF_ERROR("AnkiConnect: unexpected multi response for {} actions", actions.size());
+      return nullptr;
+    }
+    return result;
+  }
+
+  std::vector<AddNoteResult> AnkiConnectClient::AddNotes(const std::vector<AnkiNote>& notes,
+                                                         const Core::CancellationToken& cancellation)
+  {
+    std::vector<AddNoteResult> results(notes.size());
+    if (notes.empty()) {
+      return results;
+    }
+
+    size_t mediaCount = 0;
+    for (const auto& note : notes) {
+      mediaCount += note.media.size();
+    }
+    bool localPaths = UsesLocalMediaPaths();
+    bool concurrentUploads = !localPaths && mediaCount > 1;
+
+    // Each note's media goes right before it, so the note can reference the files.
+    nlohmann::json actions = nlohmann::json::array();
+    std::vector<size_t> noteActions;
+    std::map<size_t, const AnkiMediaFile*> mediaActions;
+    std::set<size_t> pathActions;
+    std::vector<std::filesystem::path> temporaryFiles;
+    std::vector<const AnkiMediaFile*> uploads;
+    std::vector<size_t> uploadNotes; // Index of the note each upload belongs to
+    noteActions.reserve(notes.size());
+    for (size_t i = 0; i < notes.size(); ++i) {
+      for (const auto& file : notes[i].media) {
+        std::filesystem::path path = localPaths ? WriteLocalMediaFile(file) : std::filesystem::path();
+        if (!path.empty()) {
+          mediaActions[actions.size()] = &file;
+          pathActions.insert(actions.size());
+          temporaryFiles.push_back(path);
+          actions.push_back(
+              {{"action", "storeMediaFile"}, {"params", {{"filename", file.filename}, {"path", path.string()}}}});
+        } else if (concurrentUploads) {
+          uploads.push_back(&file);
+          uploadNotes.push_back(i);
+        } else {
+          mediaActions[actions.size()] = &file;
+          std::string data = Utils::Base64Utils::Encode(file.data);
+          actions.push_back(
+              {{"action", "storeMediaFile"}, {"params", {{"filename", file.filename}, {"data", std::move(data)}}}});
+        }
+      }
+      noteActions.push_back(actions.size());
+      const auto& note = notes[i];
+      actions.push_back(
+          {{"action", "addNote"},
+           {"params", {{"note", NoteToJson(note.deckName, note.modelName, note.fields, note.tags)}}}});
+    }
+
+    // Anki does not check that referenced media exists, so the notes need not wait for the uploads.
+    Core::TaskGroup uploadGroup(Core::TaskPriority::Interactive);
+    std::vector<char> uploaded(uploads.size(), 0);
+    std::vector<std::future<void>> uploading = StartMediaUploads(uploads, uploaded, uploadGroup, cancellation);
+    httplib::Error transportError = httplib::Error::Success;
+    nlohmann::json responses = Multi(actions, cancellation, &transportError);
+    WaitForUploads(uploadGroup, uploading);
+
+    std::error_code removeError;
+    for (const auto& path : temporaryFiles) {
+      std::filesystem::remove(path, removeError);
+    }
+    AF_DEBUG("AnkiConnect: {} note(s), {} media file(s) by path, {} uploaded concurrently",
+             notes.size(),
+             temporaryFiles.size(),
+             uploads.size());
+
+    if (responses.is_null()) {
+      // Only a request that never reached Anki is safe to send again. After a read timeout, an
+      // HTTP or AnkiConnect error, or a malformed answer the notes may be in already, so those fail visibly.
+      bool cancelled = cancellation.IsCancelled();
+      bool unreachable = !cancelled && (transportError == httplib::Error::Connection ||
+                                        transportError == httplib::Error::ConnectionTimeout);
+      for (auto& result : results) {
+        result.error = cancelled ? "Cancelled" : "Request to AnkiConnect failed";
+        result.unreachable = unreachable;
+      }
+      return results;
+    }
+
+    // Media each note is still missing; its note is only reported as added once these are stored.
+    std::vector<std::vector<const AnkiMediaFile*>> missing(notes.size());
+    for (size_t k = 0; k < uploads.size(); ++k) {
+      if (!uploaded[k]) {
+        missing[uploadNotes[k]].push_back(uploads[k]);
+      }
+    }
+
+    size_t actionIndex = 0;
+    for (size_t i = 0; i < notes.size(); ++i) {
+      for (; actionIndex < noteActions[i]; ++actionIndex) {
+        std::string error = ErrorOf(responses[actionIndex]);
+        if (error.empty()) {
+          continue;
+        }
+        const AnkiMediaFile* file = mediaActions.at(actionIndex);
+        AF_WARN("AnkiConnect: storing {} failed: {}", file->filename, error);
+        if (pathActions.count(actionIndex)) {
+          // Its data is sent below; later requests skip the paths altogether.
+          DisableLocalMediaPaths(error);
+        }
+        missing[i].push_back(file);
+      }
+
+      const auto& response = responses[actionIndex++];
+      results[i].error = ErrorOf(response);
+      if (results[i].error.empty()) {
+        if (response.is_object() && response["result"].is_number_integer()) {
+          results[i].noteId = response["result"].get<int64_t>();
+        } else {
+          results[i].error = "addNote returned no note id";
+        }
+      }
+      if (results[i].Succeeded() && !missing[i].empty()) {
+        CompleteNoteMedia(results[i], missing[i], cancellation);
+      }
+    }
+    return results;
+  }
+
+  void AnkiConnectClient::CompleteNoteMedia(AddNoteResult& result,
+                                            const std::vector<const AnkiMediaFile*>& missing,
+                                            const Core::CancellationToken& cancellation)
+  {
+    // Anki adds a note whether or not the media it references exists, so the files get one more attempt.
+    std::string failed;
+    for (const auto* file : missing) {
+      if (!StoreMediaData(*file, cancellation)) {
+        failed = file->filename;
+        break;
+      }
+    }
+    if (failed.empty()) {
+      return;
+    }
+
+    // Taking the note out again lets the card be sent again as a whole without leaving a broken copy behind.
+    nlohmann::json actions = nlohmann::json::array();
+    actions.push_back(
+        {{"action", "deleteNotes"}, {"params", {{"notes", nlohmann::json::array({result.noteId})}}}});
+    auto responses = Multi(actions, cancellation);
+    if (!responses.is_null() && ErrorOf(responses[0]).empty()) {
+      AF_WARN("AnkiConnect: storing {} failed, note {} removed again", failed, result.noteId);
+      result.noteId = 0;
+      result.error = "Storing " + failed + " failed";
+    } else {
+      AF_ERROR("AnkiConnect: note {} was added without {}", result.noteId, failed);
+      result.error = "Note added without " + failed;
+    }
+  }
+
 } // namespace Image2Card::API
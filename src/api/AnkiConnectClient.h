@@ -1,39 +1,230 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <future>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <nlohmann/json.hpp>
 #include <string>
 #include <vector>
 
+#include "core/CancellationToken.h"
+
+namespace httplib
+{
+  class Client;
+  enum class Error;
+}
+
+namespace Image2Card::Core
+{
+  class TaskGroup;
+}
+
 namespace Image2Card::API
 {
 
+  struct AnkiMediaFile
+  {
+    std::string filename;
+    std::vector<unsigned char> data; // Raw contents; encoded by the client only if they go in the request
+  };
+
+  /**
+ * A note ready to send, together with the media files its fields reference.
+ */
+  struct AnkiNote
+  {
+    std::string deckName;
+    std::string modelName;
+    std::map<std::string, std::string> fields;
+    std::vector<std::string> tags;
+    std::vector<AnkiMediaFile> media;
+  };
+
+  /**
+ * A note as stored in Anki, from notesInfo.
+ */
+  struct AnkiNoteInfo
+  {
+    int64_t noteId = 0;
+    std::string modelName;
+    int64_t modified = 0; // Seconds since the epoch, 0 if AnkiConnect does not report it
+    std::map<std::string, std::string> fields;
+  };
+
+  struct AddNoteResult
+  {
+    int64_t noteId = 0;
+    std::string error;        // Empty on success, or names the media an added note is missing
+    bool unreachable = false; // No connection to Anki was made, so the note can be sent again as it is
+
+    [[nodiscard]] bool Succeeded() const { return noteId != 0; }
+  };
+
+  /**
+ * Client for the AnkiConnect add-on. Connections are kept alive and reused
+ * between requests; each request borrows an idle connection (or opens one), so
+ * the client can be shared by several threads and concurrent requests do not
+ * wait for each other.
+ */
   class AnkiConnectClient
   {
 public:
 
     explicit AnkiConnectClient(std::string url);
-    ~AnkiConnectClient() = default;
+    ~AnkiConnectClient();
+
+    AnkiConnectClient(const AnkiConnectClient&) = delete;
+    AnkiConnectClient& operator=(const AnkiConnectClient&) = delete;
 
+    /**
+   * Point the client at another AnkiConnect; open connections to the old URL are dropped.
+   */
     void SetUrl(const std::string& url);
 
-    bool Ping();
-    std::vector<std::string> GetDeckNames();
-    std::vector<std::string> GetModelNames();
-    std::vector<std::string> GetModelFieldNames(const std::string& modelName);
+    /**
+   * Keep connections open between requests (the default). Without reuse every request
+   * connects anew, which is only useful to measure what reuse saves.
+   */
+    void SetConnectionReuse(bool reuse);
+
+    /**
+   * Hand media to AnkiConnect as temporary files it reads by path when it runs on
+   * this computer, which skips base64 and JSON escaping of the data. Remote
+   * AnkiConnect, or local with this off, gets the data in the request.
+   */
+    void SetLocalMediaPaths(bool enabled);
+
+    /**
+   * @return true if media is passed by path: enabled, AnkiConnect is on a loopback
+   * address, and it has not failed to read a file from the media directory yet
+   */
+    [[nodiscard]] bool UsesLocalMediaPaths() const;
+
+    /**
+   * @return Number of connections opened so far
+   */
+    [[nodiscard]] uint64_t GetConnectionCount() const { return m_ConnectionsOpened.load(); }
+
+    // Every call takes an optional cancellation token; cancelling it aborts the request in flight.
+    bool Ping(const Core::CancellationToken& cancellation = {});
+    std::vector<std::string> GetDeckNames(const Core::CancellationToken& cancellation = {});
+    std::vector<std::string> GetModelNames(const Core::CancellationToken& cancellation = {});
+    std::vector<std::string> GetModelFieldNames(const std::string& modelName,
+                                                const Core::CancellationToken& cancellation = {});
     int64_t AddNote(const std::string& deckName,
                     const std::string& modelName,
                     const std::map<std::string, std::string>& fields,
-                    const std::vector<std::string>& tags = {});
-    std::vector<int64_t> FindNotes(const std::string& query);
-    bool StoreMediaFile(const std::string& filename, const std::string& base64Data);
-    bool GuiBrowse(int64_t cardId);
+                    const std::vector<std::string>& tags = {},
+                    const Core::CancellationToken& cancellation = {});
+    std::vector<int64_t> FindNotes(const std::string& query, const Core::CancellationToken& cancellation = {});
+
+    /**
+   * @return Details of the notes that still exist; deleted ids are left out
+   */
+    std::vector<AnkiNoteInfo> NotesInfo(const std::vector<int64_t>& noteIds,
+                                        const Core::CancellationToken& cancellation = {});
+    bool StoreMediaFile(const AnkiMediaFile& file, const Core::CancellationToken& cancellation = {});
+    bool GuiBrowse(int64_t cardId, const Core::CancellationToken& cancellation = {});
+
+    /**
+   * Store the media of every note and add the notes. Media passed by path, or a
+   * single file, goes in the same "multi" request as the notes; otherwise the
+   * files are uploaded concurrently while the notes are added.
+   * Each note's result comes from its addNote action. Media that could not be
+   * stored is sent once more; if it still fails, the note is deleted again and
+   * reported as failed. If the request itself fails every note is reported as failed.
+   * @return One result per note, in the same order
+   */
+    std::vector<AddNoteResult> AddNotes(const std::vector<AnkiNote>& notes,
+                                        const Core::CancellationToken& cancellation = {});
+
+    /**
+   * Run several actions in one round trip.
+   * @param actions Array of {"action", "params"} objects
+   * @param transportError Receives why no response arrived, or Error::Success if one did
+   * @return One {"result", "error"} object per action, or null if the request failed
+   */
+    nlohmann::json Multi(const nlohmann::json& actions,
+                         const Core::CancellationToken& cancellation = {},
+                         httplib::Error* transportError = nullptr);
 
 private:
 
-    nlohmann::json Execute(const std::string& action, const nlohmann::json& params = nullptr);
+    static nlohmann::json NoteToJson(const std::string& deckName,
+                                     const std::string& modelName,
+                                     const std::map<std::string, std::string>& fields,
+                                     const std::vector<std::string>& tags);
+
+    bool StoreMediaData(const AnkiMediaFile& file, const Core::CancellationToken& cancellation);
+
+    /**
+   * Upload files with storeMediaFile requests on several connections at once,
+   * as tasks of group. The files must stay alive until every returned future is ready.
+   * @param stored Sized like files; set to 1 for each file that was stored
+   */
+    std::vector<std::future<void>> StartMediaUploads(const std::vector<const AnkiMediaFile*>& files,
+                                                     std::vector<char>& stored,
+                                                     Core::TaskGroup& group,
+                                                     const Core::CancellationToken& cancellation);
+
+    /**
+   * Send media an added note is missing. If a file still cannot be stored the note
+   * is deleted, so the card can be sent again; result is updated either way.
+   */
+    void CompleteNoteMedia(AddNoteResult& result,
+                           const std::vector<const AnkiMediaFile*>& missing,
+                           const Core::CancellationToken& cancellation);
+
+    /**
+   * Write a media file to this client's private temporary directory, which
+   * AnkiConnect reads paths from. The directory is created on first use.
+   * @return Path of the written file, empty if it could not be written
+   */
+    std::filesystem::path WriteLocalMediaFile(const AnkiMediaFile& file);
+
+    /**
+   * Stop passing paths after AnkiConnect could not read one, e.g. because Anki runs
+   * in a sandbox that cannot see the temporary directory.
+   */
+    void DisableLocalMediaPaths(const std::string& error);
+
+    /**
+   * Send one action and return its result, or null if it failed for any reason.
+   * @param transportError Receives why no response arrived, or Error::Success if one did
+   */
+    nlohmann::json Execute(const std::string& action,
+                           const nlohmann::json& params = nullptr,
+                           const Core::CancellationToken& cancellation = {},
+                           httplib::Error* transportError = nullptr);
+
+    /**
+   * Borrow an idle connection, or open one if none is idle.
+   * @param generation Receives the URL generation the connection belongs to
+   */
+    std::unique_ptr<httplib::Client> AcquireConnection(uint64_t& generation);
+
+    /**
+   * Return a connection after a complete response. It is closed instead if the URL
+   * changed meanwhile, reuse is off, or enough connections are idle already.
+   */
+    void ReleaseConnection(std::unique_ptr<httplib::Client> connection, uint64_t generation);
 
+    mutable std::mutex m_Mutex;
     std::string m_Url;
+    uint64_t m_UrlGeneration = 0; // Bumped by SetUrl so connections to the old URL are not reused
+    bool m_ReuseConnections = true;
+    bool m_LoopbackUrl = false;           // AnkiConnect runs on this computer
+    bool m_LocalMediaPaths = true;        // Setting: pass media by path when AnkiConnect is local
+    bool m_LocalMediaPathsFailed = false; // AnkiConnect could not read a path; data is sent from then on
+    std::vector<std::unique_ptr<httplib::Client>> m_IdleConnections;
+    std::atomic<uint64_t> m_ConnectionsOpened{0};
+    std::filesystem::path m_MediaDirectory;      // Private, created on first use and removed with the client
+    std::atomic<uint64_t> m_MediaFileCounter{0}; // Keeps temporary media file names unique
   };
 
 } // namespace Image2Card::API
@@ -0,0 +1,271 @@
+#include "api/CardOutbox.h"
+
+#include <algorithm>
+#include <iterator>
+#include <nlohmann/json.hpp>
+#include <sqlite3.h>
+#include <stdexcept>
+
+#include "core/Logger.h"
+#include "core/Trace.h"
+
+namespace Image2Card::API
+{
+
+  namespace
+  {
+    bool Exec(sqlite3* db, const char* sql)
+    {
+      char* error = nullptr;
+      if (sqlite3_exec(db, sql, nullptr, nullptr, &error) != SQLITE_OK) {
+        AF_ERROR("Outbox: {} ({})", error ? error : "unknown error", sql);
+        sqlite3_free(error);
+        return false;
+      }
+      return true;
+    }
+
+    // Media is stored next to the note as blobs, so only the note itself is JSON.
+    std::string SerializeNote(const AnkiNote& note)
+    {
+      nlohmann::json json;
+      json["deck"] = note.deckName;
+      json["model"] = note.modelName;
+      json["fields"] = note.fields;
+      json["tags"] = note.tags;
+      return json.dump();
+    }
+
+    AnkiNote DeserializeNote(const std::string& data)
+    {
+      auto json = nlohmann::json::parse(data);
+      AnkiNote note;
+      note.deckName = json.at("deck");
+      note.modelName = json.at("model");
+      note.fields = json.at("fields").get<std::map<std::string, std::string>>();
+      note.tags = json.at("tags").get<std::vector<std::string>>();
+      return note;
+    }
+  } // namespace
+
+  CardOutbox::CardOutbox(const std::string& dbPath)
+  {
+    int result = sqlite3_open(dbPath.c_str(), &m_Database);
+    if (result != SQLITE_OK) {
+      std::string error = sqlite3_errmsg(m_Database);
+      sqlite3_close(m_Database);
+      m_Database = nullptr;
+      throw std::runtime_error("Failed to open outbox: " + error);
+    }
+
+    bool ready = Exec(m_Database, "PRAGMA journal_mode=WAL; PRAGMA foreign_keys=ON;") &&
+                 Exec(m_Database,
+                      "CREATE TABLE IF NOT EXISTS outbox_notes (id INTEGER PRIMARY KEY, note TEXT NOT NULL);"
+                      "CREATE TABLE IF NOT EXISTS outbox_media ("
+                      "note_id INTEGER NOT NULL REFERENCES outbox_notes(id) ON DELETE CASCADE,"
+                      "position INTEGER NOT NULL, filename TEXT NOT NULL, data BLOB NOT NULL,"
+                      "PRIMARY KEY (note_id, position));");
+    if (!ready) {
+      sqlite3_close(m_Database);
+      m_Database = nullptr;
+      throw std::runtime_error("Failed to create outbox tables");
+    }
+
+    Load();
+  }
+
+  CardOutbox::~CardOutbox()
+  {
+    if (m_Database) {
+      sqlite3_close(m_Database);
+    }
+  }
+
+  void CardOutbox::Load()
+  {
+    std::map<int64_t, size_t> indexOf;
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(m_Database, "SELECT id, note FROM outbox_notes ORDER BY id", -1, &stmt, nullptr) ==
+        SQLITE_OK) {
+      while (sqlite3_step(stmt) == SQLITE_ROW) {
+        int64_t rowId = sqlite3_column_int64(stmt, 0);
+        const char* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+        try {
+          indexOf[rowId] = m_Pending.size();
+          m_Pending.push_back({rowId, DeserializeNote(text ? text : "")});
+        } catch (const std::exception& e) {
+          AF_WARN("Outbox: skipping unreadable card {}: {}", rowId, e.what());
+          indexOf.erase(rowId);
+        }
+      }
+      sqlite3_finalize(stmt);
+    }
+
+    const char* media = "SELECT note_id, filename, data FROM outbox_media ORDER BY note_id, position";
+    if (sqlite3_prepare_v2(m_Database, media, -1, &stmt, nullptr) == SQLITE_OK) {
+      while (sqlite3_step(stmt) == SQLITE_ROW) {
+        auto entry = indexOf.find(sqlite3_column_int64(stmt, 0));
+        if (entry == indexOf.end()) {
+          continue;
+        }
+        const char* filename = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+        const auto* data = static_cast<const unsigned char*>(sqlite3_column_blob(stmt, 2));
+        int size = sqlite3_column_bytes(stmt, 2);
+        m_Pending[entry->second].note.media.push_back(
+            {filename ? filename : "", std::vector<unsigned char>(data, data + size)});
+      }
+      sqlite3_finalize(stmt);
+    }
+
+    if (!m_Pending.empty()) {
+      AF_INFO("Outbox: {} card(s) waiting from an earlier session", m_Pending.size());
+    }
+  }
+
+  int64_t CardOutbox::Insert(const AnkiNote& note)
+  {
+    // A card is on disk with all of its media or not at all.
+    if (!Exec(m_Database, "BEGIN")) {
+      return 0;
+    }
+
+    bool stored = false;
+    int64_t rowId = 0;
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(m_Database, "INSERT INTO outbox_notes (note) VALUES (?)", -1, &stmt, nullptr) ==
+        SQLITE_OK) {
+      std::string data = SerializeNote(note);
+      sqlite3_bind_text(stmt, 1, data.c_str(), (int) data.size(), SQLITE_TRANSIENT);
+      stored = sqlite3_step(stmt) == SQLITE_DONE;
+      rowId = sqlite3_last_insert_rowid(m_Database);
+      sqlite3_finalize(stmt);
+    }
+
+    const char* media = "INSERT INTO outbox_media (note_id, position, filename, data) VALUES (?, ?, ?, ?)";
+    if (stored && sqlite3_prepare_v2(m_Database, media, -1, &stmt, nullptr) == SQLITE_OK) {
+      for (size_t i = 0; i < note.media.size() && stored; ++i) {
+        const auto& file = note.media[i];
+        sqlite3_bind_int64(stmt, 1, rowId);
+        sqlite3_bind_int64(stmt, 2, (int64_t) i);
+        sqlite3_bind_text(stmt, 3, file.filename.c_str(), (int) file.filename.size(), SQLITE_STATIC);
+        sqlite3_bind_blob(stmt, 4, file.data.data(), (int) file.data.size(), SQLITE_STATIC);
+        stored = sqlite3_step(stmt) == SQLITE_DONE;
+        sqlite3_reset(stmt);
+      }
+      sqlite3_finalize(stmt);
+    }
+
+    if (!stored || !Exec(m_Database, "COMMIT")) {
+      AF_ERROR("Outbox: cannot save card to '{}': {}", note.deckName, sqlite3_errmsg(m_Database));
+      Exec(m_Database, "ROLLBACK");
+      return 0;
+    }
+    return rowId;
+  }
+
+  void CardOutbox::Remove(const std::vector<int64_t>& rowIds)
+  {
+    if (!m_Database || rowIds.empty()) {
+      return;
+    }
+
+    Exec(m_Database, "BEGIN");
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(m_Database, "DELETE FROM outbox_notes WHERE id = ?", -1, &stmt, nullptr) == SQLITE_OK) {
+      for (int64_t rowId : rowIds) {
+        sqlite3_bind_int64(stmt, 1, rowId);
+        sqlite3_step(stmt);
+        sqlite3_reset(stmt);
+      }
+      sqlite3_finalize(stmt);
+    }
+    Exec(m_Database, "COMMIT");
+  }
+
+  void CardOutbox::Stage(AnkiNote note)
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    int64_t rowId = m_Database ? Insert(note) : 0;
+    m_Pending.push_back({rowId, std::move(note)});
+  }
+
+  CardOutbox::FlushReport CardOutbox::Flush(AnkiConnectClient& client, const Core::CancellationToken& cancellation)
+  {
+    AF_TRACE_SCOPE("anki", "Flush Outbox");
+
+    std::vector<Entry> entries;
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      entries.swap(m_Pending);
+    }
+
+    FlushReport report;
+    report.results.reserve(entries.size());
+    std::vector<Entry> kept;
+
+    for (size_t begin = 0; begin < entries.size(); begin += MaxNotesPerRequest) {
+      size_t end = std::min(entries.size(), begin + MaxNotesPerRequest);
+
+      // Without an answer to the last request the rest would fail the same way, so it stays for the next flush.
+      if (report.unreachable || cancellation.IsCancelled()) {
+        std::move(entries.begin() + begin, entries.end(), std::back_inserter(kept));
+        break;
+      }
+
+      std::vector<AnkiNote> chunk;
+      chunk.reserve(end - begin);
+      for (size_t i = begin; i < end; ++i) {
+        chunk.push_back(entries[i].note);
+      }
+
+      auto results = client.AddNotes(chunk, cancellation);
+      bool cancelled = cancellation.IsCancelled();
+      std::vector<int64_t> done;
+      for (size_t i = 0; i < chunk.size(); ++i) {
+        Entry& entry = entries[begin + i];
+        if (results[i].Succeeded()) {
+          ++report.added;
+          done.push_back(entry.rowId);
+        } else if (results[i].unreachable || cancelled) {
+          ++report.failed;
+          report.unreachable = report.unreachable || results[i].unreachable;
+          kept.push_back(std::move(entry));
+        } else {
+          // Anki answered and refused the card, so it would only be refused again.
+          ++report.failed;
+          ++report.rejected;
+          if (report.rejectedError.empty()) {
+            report.rejectedError = results[i].error;
+          }
+          AF_ERROR("Outbox: Anki rejected a card for '{}', dropping it: {}", entry.note.deckName, results[i].error);
+          done.push_back(entry.rowId);
+        }
+        report.results.push_back(std::move(results[i]));
+      }
+
+      // Removed right away, so a crash later in the flush cannot send these cards twice.
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      Remove(done);
+    }
+
+    if (report.unreachable) {
+      AF_INFO("Outbox: AnkiConnect is unreachable, {} card(s) kept", kept.size());
+    } else {
+      AF_INFO("Outbox flushed: {} added, {} rejected, {} kept", report.added, report.rejected, kept.size());
+    }
+
+    if (!kept.empty()) {
+      // Kept cards go back ahead of anything staged during the flush.
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      m_Pending.insert(m_Pending.begin(), std::make_move_iterator(kept.begin()), std::make_move_iterator(kept.end()));
+    }
+    return report;
+  }
+
+  size_t CardOutbox::GetPendingCount() const
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Pending.size();
+  }
+
+} // namespace Image2Card::API
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "api/AnkiConnectClient.h"
+#include "core/CancellationToken.h"
+
+struct sqlite3;
+
+namespace Image2Card::API
+{
+
+  /**
+ * Cards prepared for Anki but not sent yet.
+ * Flushing sends the staged cards and their media in as few AnkiConnect requests
+ * as possible. Cards that could not be delivered stay staged so they can be retried;
+ * cards Anki rejected are reported once and dropped, since sending them again would
+ * only fail again.
+ * An outbox opened on a database file keeps its cards, media included, on disk
+ * until they are added, so they survive a restart while Anki is unreachable.
+ */
+  class CardOutbox
+  {
+public:
+
+    struct FlushReport
+    {
+      std::vector<AddNoteResult> results; // One per flushed card, in staging order
+      size_t added = 0;
+      size_t failed = 0;         // Not added, rejected ones included
+      size_t rejected = 0;       // Refused by Anki and dropped; their results say why
+      std::string rejectedError; // Error of the first rejected card
+      bool unreachable = false;  // Stopped because AnkiConnect did not answer
+    };
+
+    // Upper bound on cards per request, keeping request bodies with media to a few MB.
+    static constexpr size_t MaxNotesPerRequest = 50;
+
+    /**
+   * An outbox held in memory only.
+   */
+    CardOutbox() = default;
+
+    /**
+   * An outbox stored in a SQLite file; cards staged in an earlier session are loaded.
+   * @param dbPath SQLite file, created if missing
+   * @throws std::runtime_error if the database cannot be opened or created
+   */
+    explicit CardOutbox(const std::string& dbPath);
+    ~CardOutbox();
+
+    CardOutbox(const CardOutbox&) = delete;
+    CardOutbox& operator=(const CardOutbox&) = delete;
+
+    /**
+   * Add a card. With a database it is written to disk before this returns.
+   */
+    void Stage(AnkiNote note);
+
+    /**
+   * Send every staged card. Cards staged while a flush is running are kept for the next one.
+   * Once a request gets no answer the remaining cards are not tried. Cards Anki rejects
+   * are logged and removed.
+   * @param client Client to send through
+   * @param cancellation Stops between and during requests; unsent cards stay staged
+   * @return Per-card results
+   */
+    FlushReport Flush(AnkiConnectClient& client, const Core::CancellationToken& cancellation = {});
+
+    [[nodiscard]] size_t GetPendingCount() const;
+
+private:
+
+    struct Entry
+    {
+      int64_t rowId = 0; // Row in the database, 0 without one
+      AnkiNote note;
+    };
+
+    int64_t Insert(const AnkiNote& note);
+    void Remove(const std::vector<int64_t>& rowIds);
+    void Load();
+
+    sqlite3* m_Database = nullptr;
+    mutable std::mutex m_Mutex;
+    std::vector<Entry> m_Pending;
+  };
+
+} // namespace Image2Card::API
@@ -0,0 +1,454 @@
+#include "api/DuplicateIndex.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <unordered_set>
+#include <utility>
+
+#include "api/AnkiConnectClient.h"
+#include "core/Logger.h"
+#include "core/Trace.h"
+
+namespace Image2Card::API
+{
+
+  namespace
+  {
+    // Notes per notesInfo request when a deck is read in full.
+    constexpr size_t NotesInfoBatch = 500;
+    constexpr int FileVersion = 2;
+    constexpr int64_t SecondsPerDay = 24 * 60 * 60;
+
+    int64_t Now()
+    {
+      return std::chrono::duration_cast<std::chrono::seconds>(DuplicateIndex::Clock::now().time_since_epoch()).count();
+    }
+
+    std::string EscapeQuotes(std::string value)
+    {
+      size_t pos = 0;
+      while ((pos = value.find('"', pos)) != std::string::npos) {
+        value.replace(pos, 1, "\\\"");
+        pos += 2;
+      }
+      return value;
+    }
+
+    std::vector<int64_t> IdsOf(const nlohmann::json& response)
+    {
+      if (!response.is_object() || !response.contains("result") || !response["result"].is_array()) {
+        return {};
+      }
+      return response["result"].get<std::vector<int64_t>>();
+    }
+  } // namespace
+
+  DuplicateIndex::DuplicateIndex(std::string path)
+      : m_Path(std::move(path))
+  {}
+
+  std::string DuplicateIndex::Normalize(std::string_view value)
+  {
+    static constexpr std::pair<std::string_view, std::string_view> Entities[] = {
+        {"&nbsp;", " "}, {"&amp;", "&"}, {"&lt;", "<"}, {"&gt;", ">"}, {"&quot;", "\""}};
+
+    std::string result;
+    result.reserve(value.size());
+    bool space = false; // Whitespace seen since the last character; written once before the next one
+    auto emit = [&result, &space](std::string_view text) {
+      if (space && !result.empty()) {
+        result += ' ';
+      }
+      space = false;
+      for (char c : text) {
+        result += (c >= 'A' && c <= 'Z') ? (char) (c - 'A' + 'a') : c;
+      }
+    };
+
+    size_t i = 0;
+    while (i < value.size()) {
+      std::string_view rest = value.substr(i);
+      char c = value[i];
+      if (c == '<' && rest.find('>') != std::string_view::npos) {
+        size_t end = rest.find('>');
+        std::string_view tag = rest.substr(1, end - 1);
+        if (tag.starts_with("br") || tag.starts_with("BR") || tag.starts_with("div") || tag.starts_with("/div")) {
+          space = true;
+        }
+        i += end + 1;
+        continue;
+      }
+      if (c == '&') {
+        auto entity = std::find_if(std::begin(Entities), std::end(Entities), [rest](const auto& entry) {
+          return rest.starts_with(entry.first);
+        });
+        if (entity != std::end(Entities)) {
+          if (entity->second == " ") {
+            space = true;
+          } else {
+            emit(entity->second);
+          }
+          i += entity->first.size();
+          continue;
+        }
+      }
+      if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+        space = true;
+        ++i;
+        continue;
+      }
+      if (rest.starts_with("\xE3\x80\x80")) { // Ideographic space
+        space = true;
+        i += 3;
+        continue;
+      }
+      emit(rest.substr(0, 1));
+      ++i;
+    }
+    return result;
+  }
+
+  std::string DuplicateIndex::ScopeName(const std::string& deck, const std::string& model)
+  {
+    return deck + '\x1f' + model;
+  }
+
+  std::string DuplicateIndex::Key(const std::string& field, std::string_view normalizedValue)
+  {
+    std::string key = field;
+    key += '\x1f';
+    key += normalizedValue;
+    return key;
+  }
+
+  void DuplicateIndex::Insert(Scope& scope,
+                              int64_t noteId,
+                              int64_t modified,
+                              const std::map<std::string, std::string>& fields)
+  {
+    Erase(scope, noteId);
+
+    Note note;
+    note.modified = modified;
+    for (const auto& [field, value] : fields) {
+      if (!std::binary_search(scope.fields.begin(), scope.fields.end(), field)) {
+        continue;
+      }
+      std::string normalized = Normalize(value);
+      if (normalized.empty() || normalized.size() > MaxIndexedLength) {
+        continue;
+      }
+      note.keys.push_back(Key(field, normalized));
+      scope.byKey[note.keys.back()].push_back(noteId);
+    }
+    scope.notes[noteId] = std::move(note);
+  }
+
+  void DuplicateIndex::Erase(Scope& scope, int64_t noteId)
+  {
+    auto it = scope.notes.find(noteId);
+    if (it == scope.notes.end()) {
+      return;
+    }
+    for (const auto& key : it->second.keys) {
+      auto ids = scope.byKey.find(key);
+      if (ids == scope.byKey.end()) {
+        continue;
+      }
+      std::erase(ids->second, noteId);
+      if (ids->second.empty()) {
+        scope.byKey.erase(ids);
+      }
+    }
+    scope.notes.erase(it);
+  }
+
+  bool DuplicateIndex::Refresh(AnkiConnectClient& client,
+                               const std::string& deck,
+                               const std::string& model,
+                               std::vector<std::string> fields,
+                               std::chrono::seconds refreshInterval,
+                               const Core::CancellationToken& cancellation)
+  {
+    AF_TRACE_SCOPE("anki", "Refresh duplicate index");
+    std::lock_guard<std::mutex> refreshLock(m_RefreshMutex);
+    std::string name = ScopeName(deck, model);
+    int64_t started = Now();
+    std::sort(fields.begin(), fields.end());
+    fields.erase(std::unique(fields.begin(), fields.end()), fields.end());
+
+    int64_t refreshed = 0;
+    std::unordered_map<int64_t, int64_t> known; // Note id to modification time
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      LoadLocked();
+      Scope& scope = m_Scopes[name];
+      if (scope.fields != fields) {
+        // Values of the newly checked fields were never stored, so the deck is read again.
+        scope = Scope{};
+        scope.fields = std::move(fields);
+      }
+      refreshed = scope.refreshed;
+      if (refreshInterval.count() > 0 && refreshed > 0 && started - refreshed < refreshInterval.count()) {
+        return true;
+      }
+      for (const auto& [id, note] : scope.notes) {
+        known[id] = note.modified;
+      }
+    }
+
+    // Every note id of the deck, to see what was added and deleted, and the notes edited
+    // since the last refresh (Anki counts edits in whole days), in one round trip.
+    std::string query = "deck:\"" + EscapeQuotes(deck) + "\" note:\"" + EscapeQuotes(model) + "\"";
+    nlohmann::json actions = nlohmann::json::array();
+    actions.push_back({{"action", "findNotes"}, {"params", {{"query", query}}}});
+    if (refreshed > 0) {
+      int64_t days = (started - refreshed) / SecondsPerDay + 1;
+      actions.push_back({{"action", "findNotes"}, {"params", {{"query", query + " edited:" + std::to_string(days)}}}});
+    }
+    auto responses = client.Multi(actions, cancellation);
+    if (responses.is_null() || !responses[0].is_object() || !responses[0]["result"].is_array()) {
+      return false;
+    }
+    std::vector<int64_t> current = IdsOf(responses[0]);
+    std::vector<int64_t> edited = refreshed > 0 ? IdsOf(responses[1]) : std::vector<int64_t>{};
+
+    std::vector<int64_t> fetch;
+    for (int64_t id : current) {
+      if (!known.contains(id)) {
+        fetch.push_back(id);
+      }
+    }
+    for (int64_t id : edited) {
+      if (known.contains(id)) {
+        fetch.push_back(id);
+      }
+    }
+
+    std::vector<AnkiNoteInfo> notes;
+    for (size_t begin = 0; begin < fetch.size(); begin += NotesInfoBatch) {
+      size_t end = std::min(fetch.size(), begin + NotesInfoBatch);
+      auto batch = client.NotesInfo(std::vector<int64_t>(fetch.begin() + begin, fetch.begin() + end), cancellation);
+      // The notes were listed a moment ago, so no answer at all means the request failed.
+      if (batch.empty()) {
+        return false;
+      }
+      std::move(batch.begin(), batch.end(), std::back_inserter(notes));
+    }
+
+    size_t updated = 0;
+    size_t removed = 0;
+    size_t total = 0;
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      Scope& scope = m_Scopes[name];
+      std::unordered_set<int64_t> present(current.begin(), current.end());
+      for (const auto& [id, modified] : known) {
+        if (!present.contains(id)) {
+          Erase(scope, id);
+          ++removed;
+        }
+      }
+      for (const auto& note : notes) {
+        auto existing = scope.notes.find(note.noteId);
+        if (existing == scope.notes.end() || existing->second.modified != note.modified) {
+          Insert(scope, note.noteId, note.modified, note.fields);
+          ++updated;
+        }
+      }
+      scope.refreshed = started;
+      total = scope.notes.size();
+    }
+
+    AF_INFO("Duplicate index: {} / {} has {} notes, {} updated and {} removed in {} s",
+            deck,
+            model,
+            total,
+            updated,
+            removed,
+            Now() - started);
+    if (updated > 0 || removed > 0 || refreshed == 0) {
+      Save();
+    }
+    return true;
+  }
+
+  std::optional<std::vector<int64_t>> DuplicateIndex::FindDuplicates(AnkiConnectClient& client,
+                                                                     const std::string& deck,
+                                                                     const std::string& model,
+                                                                     const std::map<std::string, std::string>& values,
+                                                                     const Core::CancellationToken& cancellation)
+  {
+    std::map<std::string, std::string> normalized;
+    for (const auto& [field, value] : values) {
+      std::string text = Normalize(value);
+      if (text.size() > MaxIndexedLength) {
+        return std::nullopt;
+      }
+      if (!text.empty()) {
+        normalized[field] = std::move(text);
+      }
+    }
+
+    std::vector<std::string> fields;
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      LoadLocked();
+      // Until the background refresh has read the deck once, findNotes answers instead of waiting for it.
+      auto scope = m_Scopes.find(ScopeName(deck, model));
+      if (scope == m_Scopes.end() || scope->second.refreshed == 0) {
+        return std::nullopt;
+      }
+      fields = scope->second.fields;
+      for (const auto& [field, text] : normalized) {
+        if (!std::binary_search(fields.begin(), fields.end(), field)) {
+          return std::nullopt;
+        }
+      }
+    }
+
+    if (!Refresh(client, deck, model, std::move(fields), RefreshInterval, cancellation)) {
+      return std::nullopt;
+    }
+
+    std::vector<int64_t> candidates;
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      const Scope& scope = m_Scopes[ScopeName(deck, model)];
+      for (const auto& [field, text] : normalized) {
+        auto ids = scope.byKey.find(Key(field, text));
+        if (ids != scope.byKey.end()) {
+          candidates.insert(candidates.end(), ids->second.begin(), ids->second.end());
+        }
+      }
+    }
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    if (candidates.empty()) {
+      return candidates;
+    }
+
+    // The index may be up to a refresh interval old, so a hit is only reported if Anki still agrees.
+    auto notes = client.NotesInfo(candidates, cancellation);
+    if (notes.empty()) {
+      return std::nullopt;
+    }
+
+    std::vector<int64_t> duplicates;
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    Scope& scope = m_Scopes[ScopeName(deck, model)];
+    for (int64_t id : candidates) {
+      auto note = std::find_if(notes.begin(), notes.end(), [id](const auto& info) { return info.noteId == id; });
+      if (note == notes.end()) {
+        Erase(scope, id);
+        continue;
+      }
+      Insert(scope, note->noteId, note->modified, note->fields);
+      bool matches = std::any_of(normalized.begin(), normalized.end(), [&note](const auto& entry) {
+        auto field = note->fields.find(entry.first);
+        return field != note->fields.end() && Normalize(field->second) == entry.second;
+      });
+      if (matches) {
+        duplicates.push_back(id);
+      }
+    }
+    return duplicates;
+  }
+
+  void DuplicateIndex::Add(const std::string& deck,
+                           const std::string& model,
+                           int64_t noteId,
+                           const std::map<std::string, std::string>& fields)
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    LoadLocked();
+    // A scope that was never read in full picks the note up with the rest of the deck.
+    auto scope = m_Scopes.find(ScopeName(deck, model));
+    if (scope != m_Scopes.end() && scope->second.refreshed > 0) {
+      Insert(scope->second, noteId, Now(), fields);
+    }
+  }
+
+  void DuplicateIndex::LoadLocked()
+  {
+    if (m_Loaded) {
+      return;
+    }
+    m_Loaded = true;
+
+    std::ifstream file(m_Path);
+    if (!file.is_open()) {
+      return;
+    }
+
+    try {
+      nlohmann::json j;
+      file >> j;
+      if (j.value("version", 0) != FileVersion) {
+        AF_INFO("Duplicate index: {} has an old format, rebuilding", m_Path);
+        return;
+      }
+
+      size_t notes = 0;
+      for (const auto& scopeJson : j.at("scopes")) {
+        Scope& scope = m_Scopes[ScopeName(scopeJson.at("deck"), scopeJson.at("model"))];
+        scope.fields = scopeJson.at("fields").get<std::vector<std::string>>();
+        scope.refreshed = scopeJson.at("refreshed");
+        for (const auto& noteJson : scopeJson.at("notes")) {
+          int64_t id = noteJson.at("id");
+          Note& note = scope.notes[id];
+          note.modified = noteJson.at("mod");
+          note.keys = noteJson.at("keys").get<std::vector<std::string>>();
+          for (const auto& key : note.keys) {
+            scope.byKey[key].push_back(id);
+          }
+          ++notes;
+        }
+      }
+      AF_INFO("Duplicate index: loaded {} notes in {} decks", notes, m_Scopes.size());
+    } catch (const std::exception& e) {
+      AF_WARN("Duplicate index: cannot read {}, rebuilding ({})", m_Path, e.what());
+      m_Scopes.clear();
+    }
+  }
+
+  void DuplicateIndex::Save() const
+  {
+    AF_TRACE_SCOPE("anki", "Save duplicate index");
+    nlohmann::json scopes = nlohmann::json::array();
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      for (const auto& [name, scope] : m_Scopes) {
+        size_t separator = name.find('\x1f');
+        nlohmann::json notes = nlohmann::json::array();
+        for (const auto& [id, note] : scope.notes) {
+          notes.push_back({{"id", id}, {"mod", note.modified}, {"keys", note.keys}});
+        }
+        scopes.push_back({{"deck", name.substr(0, separator)},
+                          {"model", name.substr(separator + 1)},
+                          {"fields", scope.fields},
+                          {"refreshed", scope.refreshed},
+                          {"notes", std::move(notes)}});
+      }
+    }
+
+    // Written next to the index and renamed over it, so a crash never leaves half a file.
+    std::string temporaryPath = m_Path + ".tmp";
+    {
+      std::ofstream file(temporaryPath);
+      if (!file.is_open()) {
+        AF_WARN("Duplicate index: cannot write {}", temporaryPath);
+        return;
+      }
+      file << nlohmann::json{{"version", FileVersion}, {"scopes", std::move(scopes)}}.dump();
+    }
+    std::error_code error;
+    std::filesystem::rename(temporaryPath, m_Path, error);
+    if (error) {
+      AF_WARN("Duplicate index: cannot replace {}: {}", m_Path, error.message());
+    }
+  }
+
+} // namespace Image2Card::API
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "core/CancellationToken.h"
+
+namespace Image2Card::API
+{
+
+  class AnkiConnectClient;
+
+  /**
+ * Local copy of the duplicate-check field values of the notes in each deck and
+ * note type, so a duplicate check is a hash lookup instead of a findNotes query
+ * per card. A deck and note type is read in full with findNotes and notesInfo
+ * by the first Refresh; until that has finished, checks fall back to findNotes
+ * rather than wait for it. After that only notes that were added, edited or
+ * deleted are fetched, at most once per refresh interval. Candidates found in the index
+ * are confirmed against Anki before they are reported, so a stale index can
+ * miss a duplicate added in Anki since the last refresh but never invents one.
+ * The index is kept in a JSON file between sessions. Safe to use from several threads.
+ */
+  class DuplicateIndex
+  {
+public:
+
+    using Clock = std::chrono::system_clock;
+
+    // Longer values are not indexed; checks on them fall back to a findNotes query.
+    static constexpr size_t MaxIndexedLength = 1024;
+
+    // Interval FindDuplicates refreshes at; changes made in Anki itself show up after this long.
+    static constexpr std::chrono::seconds RefreshInterval{60};
+
+    /**
+   * @param path JSON file the index is loaded from on first use and saved to after refreshes
+   */
+    explicit DuplicateIndex(std::string path);
+
+    DuplicateIndex(const DuplicateIndex&) = delete;
+    DuplicateIndex& operator=(const DuplicateIndex&) = delete;
+
+    /**
+   * Bring one deck and note type up to date with Anki. A no-op if it was refreshed
+   * less than refreshInterval ago, unless the interval is zero. Indexing other
+   * fields than last time reads the deck in full again.
+   * @param fields Names of the fields duplicates are checked on; no other field is indexed
+   * @return false if AnkiConnect could not be reached
+   */
+    bool Refresh(AnkiConnectClient& client,
+                 const std::string& deck,
+                 const std::string& model,
+                 std::vector<std::string> fields,
+                 std::chrono::seconds refreshInterval,
+                 const Core::CancellationToken& cancellation = {});
+
+    /**
+   * Notes of the deck and note type where any of the given fields has the given value,
+   * compared after normalization. Refreshes first if the index is older than the
+   * refresh interval, and confirms candidates with notesInfo.
+   * @param values Field name to value
+   * @return Ids of the duplicates, or nullopt if the index cannot answer (not read in
+   *         full yet, a field it does not index, AnkiConnect unreachable, or a value
+   *         too long to be indexed)
+   */
+    std::optional<std::vector<int64_t>> FindDuplicates(AnkiConnectClient& client,
+                                                       const std::string& deck,
+                                                       const std::string& model,
+                                                       const std::map<std::string, std::string>& values,
+                                                       const Core::CancellationToken& cancellation = {});
+
+    /**
+   * Record a note that was just added, so the next check sees it without a refresh.
+   */
+    void Add(const std::string& deck,
+             const std::string& model,
+             int64_t noteId,
+             const std::map<std::string, std::string>& fields);
+
+    /**
+   * Lowercase ASCII, strip HTML tags, decode the common entities and collapse whitespace.
+   */
+    [[nodiscard]] static std::string Normalize(std::string_view value);
+
+private:
+
+    struct Note
+    {
+      int64_t modified = 0;
+      std::vector<std::string> keys; // Field name and normalized value, see Key()
+    };
+
+    struct Scope
+    {
+      std::vector<std::string> fields; // Sorted names of the indexed fields
+      std::unordered_map<int64_t, Note> notes;
+      std::unordered_map<std::string, std::vector<int64_t>> byKey;
+      int64_t refreshed = 0; // Seconds since the epoch, 0 if never refreshed
+    };
+
+    [[nodiscard]] static std::string ScopeName(const std::string& deck, const std::string& model);
+    [[nodiscard]] static std::string Key(const std::string& field, std::string_view normalizedValue);
+    static void Insert(Scope& scope,
+                       int64_t noteId,
+                       int64_t modified,
+                       const std::map<std::string, std::string>& fields);
+    static void Erase(Scope& scope, int64_t noteId);
+
+    void LoadLocked();
+    void Save() const;
+
+    const std::string m_Path;
+    mutable std::mutex m_Mutex;
+    std::mutex m_RefreshMutex; // One refresh at a time, so a check waits for a refresh in flight
+    bool m_Loaded = false;
+    std::unordered_map<std::string, Scope> m_Scopes;
+  };
+
+} // namespace Image2Card::API
@@ -0,0 +1,78 @@
+#include "api/OutboxSync.h"
+
+#include <algorithm>
+
+#include "core/Logger.h"
+#include "core/TaskExecutor.h"
+
+namespace Image2Card::API
+{
+
+  OutboxSync::OutboxSync(AnkiConnectClient* client, CardOutbox* outbox)
+      : m_Client(client)
+      , m_Outbox(outbox)
+  {}
+
+  OutboxSync::~OutboxSync()
+  {
+    Cancel();
+    if (m_Attempt.valid()) {
+      m_Attempt.wait();
+    }
+  }
+
+  std::optional<OutboxSync::Attempt> OutboxSync::Poll()
+  {
+    std::optional<Attempt> finished;
+    if (m_Attempt.valid()) {
+      if (m_Attempt.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        return std::nullopt;
+      }
+
+      try {
+        finished = m_Attempt.get();
+      } catch (const std::exception& e) {
+        AF_ERROR("Outbox sync failed: {}", e.what());
+        finished = Attempt{};
+      }
+
+      // Rejected cards have left the outbox, so only cards still waiting call for a later retry.
+      if (!finished->reachable || finished->report.failed > finished->report.rejected) {
+        m_NextAttempt = Clock::now() + m_RetryDelay;
+        AF_DEBUG("Outbox sync: next attempt in {}s", m_RetryDelay.count());
+        m_RetryDelay = std::min(m_RetryDelay * 2, std::chrono::seconds(MaxRetryDelay));
+      } else {
+        m_RetryDelay = InitialRetryDelay;
+      }
+    }
+
+    if (!m_Client || !m_Outbox || m_Cancellation.IsCancelled() || m_Outbox->GetPendingCount() == 0 ||
+        Clock::now() < m_NextAttempt) {
+      return finished;
+    }
+
+    m_Attempt = Core::TaskExecutor::Get().Submit(
+        Core::TaskPriority::Batch, [client = m_Client, outbox = m_Outbox, token = m_Cancellation.GetToken()] {
+          Attempt attempt;
+          attempt.reachable = !token.IsCancelled() && client->Ping(token);
+          if (attempt.reachable) {
+            attempt.report = outbox->Flush(*client, token);
+            attempt.reachable = !attempt.report.unreachable;
+          }
+          return attempt;
+        });
+    return finished;
+  }
+
+  void OutboxSync::Wake()
+  {
+    m_NextAttempt = {};
+    m_RetryDelay = InitialRetryDelay;
+  }
+
+  void OutboxSync::Cancel()
+  {
+    m_Cancellation.Cancel();
+  }
+
+} // namespace Image2Card::API
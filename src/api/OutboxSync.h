@@ -0,0 +1,69 @@
+#pragma once
+
+#include <chrono>
+#include <future>
+#include <optional>
+
+#include "api/CardOutbox.h"
+#include "core/CancellationToken.h"
+
+namespace Image2Card::API
+{
+
+  /**
+ * Sends the cards of an outbox to Anki whenever AnkiConnect can be reached.
+ * Poll() is called once per frame; while cards are waiting it starts an attempt
+ * on the task executor that pings AnkiConnect and flushes the outbox in batches.
+ * After an attempt that could not reach Anki or left cards behind, the next one
+ * waits twice as long as the last, up to MaxRetryDelay.
+ */
+  class OutboxSync
+  {
+public:
+
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr std::chrono::seconds InitialRetryDelay{2};
+    static constexpr std::chrono::seconds MaxRetryDelay{300};
+
+    struct Attempt
+    {
+      bool reachable = false;
+      CardOutbox::FlushReport report;
+    };
+
+    OutboxSync(AnkiConnectClient* client, CardOutbox* outbox);
+    ~OutboxSync();
+
+    OutboxSync(const OutboxSync&) = delete;
+    OutboxSync& operator=(const OutboxSync&) = delete;
+
+    /**
+   * Collect a finished attempt and start the next one when it is due. Main thread only.
+   * @return The attempt that finished since the last call, if any
+   */
+    std::optional<Attempt> Poll();
+
+    /**
+   * Try again on the next Poll, e.g. once AnkiConnect is known to be back. Main thread only.
+   */
+    void Wake();
+
+    /**
+   * Abort the attempt in flight and start no more, e.g. before shutting down the task executor.
+   * Cards not sent yet stay in the outbox.
+   */
+    void Cancel();
+
+private:
+
+    AnkiConnectClient* m_Client;
+    CardOutbox* m_Outbox;
+
+    std::future<Attempt> m_Attempt;
+    Clock::time_point m_NextAttempt{};
+    std::chrono::seconds m_RetryDelay = InitialRetryDelay;
+    Core::CancellationSource m_Cancellation;
+  };
+
+} // namespace Image2Card::API
@@ -0,0 +1,161 @@
+#include "batch/AnkiBenchmark.h"
+
+#include <SDL3/SDL.h>
+
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+
+#include "api/AnkiConnectClient.h"
+#include "config/ConfigManager.h"
+#include "core/Logger.h"
+
+namespace Image2Card::Batch
+{
+
+  namespace
+  {
+    constexpr const char* BenchmarkDeck = "Image2Card Benchmark";
+
+    struct Summary
+    {
+      double average = 0.0;
+      double median = 0.0;
+      double max = 0.0;
+    };
+
+    Summary Summarize(std::vector<double> samples)
+    {
+      Summary summary;
+      if (samples.empty()) {
+        return summary;
+      }
+      std::sort(samples.begin(), samples.end());
+      summary.average = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+      summary.median = samples[samples.size() / 2];
+      summary.max = samples.back();
+      return summary;
+    }
+  } // namespace
+
+  AnkiBenchmark::AnkiBenchmark(int cards)
+      : m_Cards(std::max(1, cards))
+  {}
+
+  void AnkiBenchmark::AddCards(API::AnkiConnectClient& client,
+                               const std::string& modelName,
+                               const std::string& fieldName,
+                               const std::string& label,
+                               Totals& totals)
+  {
+    auto stamp = std::chrono::system_clock::now().time_since_epoch().count();
+    uint64_t connectionsBefore = client.GetConnectionCount();
+    std::vector<unsigned char> mediaBytes = {'b', 'e', 'n', 'c', 'h'};
+
+    for (int i = 0; i < m_Cards; ++i) {
+      std::string text = "Image2Card benchmark " + label + " " + std::to_string(i) + " " + std::to_string(stamp);
+      std::string mediaFile = "image2card_benchmark_" + label + "_" + std::to_string(i) + ".txt";
+
+      API::AnkiNote note;
+      note.deckName = BenchmarkDeck;
+      note.modelName = modelName;
+      note.fields[fieldName] = text;
+      note.tags = {"image2card-benchmark"};
+      note.media.push_back({mediaFile, mediaBytes});
+
+      // The same requests as adding a card in the GUI: a duplicate check, then media and note together.
+      auto start = std::chrono::steady_clock::now();
+      client.FindNotes("\"deck:" + std::string(BenchmarkDeck) + "\" \"" + fieldName + ":" + text + "\"");
+      auto results = client.AddNotes({note});
+      totals.milliseconds.push_back(
+          std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+
+      m_MediaFiles.push_back(mediaFile);
+      if (!results.empty() && results.front().Succeeded()) {
+        m_NoteIds.push_back(results.front().noteId);
+      } else {
+        ++totals.failures;
+      }
+    }
+    totals.connections = client.GetConnectionCount() - connectionsBefore;
+  }
+
+  int AnkiBenchmark::Run()
+  {
+    char* prefPath = SDL_GetPrefPath("Image2Card", "AnkiImage2Card");
+    std::string configPath = "config.json";
+    if (prefPath) {
+      configPath = std::string(prefPath) + "config.json";
+      SDL_free(prefPath);
+    }
+    Config::ConfigManager configManager(configPath);
+    m_Url = configManager.GetConfig().AnkiConnectUrl;
+
+    API::AnkiConnectClient client(m_Url);
+    if (!client.Ping()) {
+      AF_ERROR("Anki benchmark: AnkiConnect is not reachable at {}", m_Url);
+      return 1;
+    }
+
+    auto models = client.GetModelNames();
+    std::string modelName = std::find(models.begin(), models.end(), "Basic") != models.end() ? "Basic"
+                            : models.empty()                                                 ? ""
+                                                                                             : models.front();
+    auto fields = modelName.empty() ? std::vector<std::string>{} : client.GetModelFieldNames(modelName);
+    if (fields.empty()) {
+      AF_ERROR("Anki benchmark: no note type with fields found");
+      return 1;
+    }
+
+    nlohmann::json createDeck = nlohmann::json::array();
+    createDeck.push_back({{"action", "createDeck"}, {"params", {{"deck", BenchmarkDeck}}}});
+    if (client.Multi(createDeck).is_null()) {
+      AF_ERROR("Anki benchmark: cannot create the deck {}", BenchmarkDeck);
+      return 1;
+    }
+
+    AF_INFO("Anki benchmark: {} cards each way against {}, note type {}", m_Cards, m_Url, modelName);
+
+    Totals fresh;
+    client.SetConnectionReuse(false);
+    AddCards(client, modelName, fields.front(), "fresh", fresh);
+
+    Totals reused;
+    client.SetConnectionReuse(true);
+    AddCards(client, modelName, fields.front(), "reused", reused);
+
+    // Everything the benchmark created goes in one request as well.
+    nlohmann::json cleanup = nlohmann::json::array();
+    cleanup.push_back({{"action", "deleteNotes"}, {"params", {{"notes", m_NoteIds}}}});
+    for (const auto& file : m_MediaFiles) {
+      cleanup.push_back({{"action", "deleteMediaFile"}, {"params", {{"filename", file}}}});
+    }
+    cleanup.push_back({{"action", "deleteDecks"}, {"params", {{"decks", {BenchmarkDeck}}, {"cardsToo", true}}}});
+    if (client.Multi(cleanup).is_null()) {
+      AF_WARN("Anki benchmark: cleanup failed, delete the deck {} by hand", BenchmarkDeck);
+    }
+
+    Summary freshSummary = Summarize(fresh.milliseconds);
+    Summary reusedSummary = Summarize(reused.milliseconds);
+    AF_INFO("New connection per request: {:>7.1f} ms/card average, {:.1f} median, {:.1f} max, {} connections",
+            freshSummary.average,
+            freshSummary.median,
+            freshSummary.max,
+            fresh.connections);
+    AF_INFO("Kept-alive connections:     {:>7.1f} ms/card average, {:.1f} median, {:.1f} max, {} connections",
+            reusedSummary.average,
+            reusedSummary.median,
+            reusedSummary.max,
+            reused.connections);
+    if (freshSummary.average > 0.0) {
+      AF_INFO("Saved {:.1f} ms per card ({:.0f}%)",
+              freshSummary.average - reusedSummary.average,
+              100.0 * (freshSummary.average - reusedSummary.average) / freshSummary.average);
+    }
+    if (fresh.failures + reused.failures > 0) {
+      AF_WARN("Anki benchmark: {} card(s) failed to add", fresh.failures + reused.failures);
+    }
+    return 0;
+  }
+
+} // namespace Image2Card::Batch
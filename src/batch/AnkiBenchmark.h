@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Image2Card::API
+{
+  class AnkiConnectClient;
+}
+
+namespace Image2Card::Batch
+{
+
+  /**
+ * Measures the AnkiConnect time of adding a card, with a new connection per
+ * request and with kept-alive connections. Each card makes the requests the
+ * GUI makes: a duplicate check, then its media and note in one multi request.
+ * Cards go to a temporary deck that is deleted afterwards, with its media.
+ * The AnkiConnect URL comes from the saved configuration.
+ */
+  class AnkiBenchmark
+  {
+public:
+
+    explicit AnkiBenchmark(int cards);
+
+    /**
+   * Add the cards both ways, print per-card timings and clean up.
+   * @return Process exit code (0 if the benchmark ran)
+   */
+    int Run();
+
+private:
+
+    struct Totals
+    {
+      std::vector<double> milliseconds;
+      uint64_t connections = 0;
+      size_t failures = 0;
+    };
+
+    void AddCards(API::AnkiConnectClient& client,
+                  const std::string& modelName,
+                  const std::string& fieldName,
+                  const std::string& label,
+                  Totals& totals);
+
+    std::string m_Url;
+    int m_Cards;
+    std::vector<int64_t> m_NoteIds;
+    std::vector<std::string> m_MediaFiles;
+  };
+
+} // namespace Image2Card::Batch
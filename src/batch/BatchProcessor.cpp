@@ -0,0 +1,441 @@
+#include "batch/BatchProcessor.h"
+
+#include <SDL3/SDL.h>
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <future>
+#include <numeric>
+#include <thread>
+
+#include "ai/IAudioAIProvider.h"
+#include "ai/ITextAIProvider.h"
+#include "ai/ImageUpload.h"
+#include "api/AnkiConnectClient.h"
+#include "config/ConfigManager.h"
+#include "config/ServiceFactory.h"
+#include "core/FieldTypes.h"
+#include "core/Logger.h"
+#include "core/TaskExecutor.h"
+#include "language/JapaneseLanguage.h"
+#include "language/analyzer/SentenceAnalyzer.h"
+#include "language/audio/ForvoClient.h"
+#include "language/services/ILanguageService.h"
+#include "ocr/NativeOCRProvider.h"
+#include "ocr/TesseractOCRProvider.h"
+#include "pipeline/CardPipeline.h"
+#include "utils/ImageProcessor.h"
+
+namespace Image2Card::Batch
+{
+
+  namespace
+  {
+    std::string MimeTypeForPath(const std::filesystem::path& path)
+    {
+      std::string ext = path.extension().string();
+      std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return (char) std::tolower(c); });
+
+      if (ext == ".png")
+        return "image/png";
+      if (ext == ".jpg" || ext == ".jpeg")
+        return "image/jpeg";
+      if (ext == ".webp")
+        return "image/webp";
+      if (ext == ".bmp")
+        return "image/bmp";
+      return "";
+    }
+
+    std::vector<unsigned char> ReadFileBytes(const std::filesystem::path& path)
+    {
+      std::ifstream file(path, std::ios::binary);
+      if (!file.is_open()) {
+        return {};
+      }
+      return std::vector<unsigned char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+  } // namespace
+
+  BatchProcessor::BatchProcessor(std::string directory, int workerCount)
+      : m_Directory(std::move(directory))
+      , m_WorkerCount(workerCount)
+  {
+    if (m_WorkerCount <= 0) {
+      m_WorkerCount = (int) std::clamp(std::thread::hardware_concurrency(), 1u, 4u);
+    }
+  }
+
+  BatchProcessor::~BatchProcessor() = default;
+
+  int BatchProcessor::Run()
+  {
+    if (!Initialize()) {
+      return 1;
+    }
+
+    auto images = CollectImages();
+    if (images.empty()) {
+      AF_ERROR("Batch: no images found in {}", m_Directory);
+      return 1;
+    }
+
+    int workerCount = std::min<int>(m_WorkerCount, (int) images.size());
+    AF_INFO("Batch: processing {} images from {} with {} workers", images.size(), m_Directory, workerCount);
+
+    auto start = std::chrono::steady_clock::now();
+
+    // Each image is its own task that queues the next one when it finishes, so at most workerCount
+    // images are in flight without an executor thread being held between images.
+    std::vector<std::promise<void>> done(images.size());
+    for (int i = 0; i < workerCount; ++i) {
+      StartImage(images, done, m_NextImage.fetch_add(1));
+    }
+    for (auto& image : done) {
+      image.get_future().wait();
+    }
+
+    ReportSummary(std::chrono::steady_clock::now() - start);
+
+    return m_Failed.load() == 0 ? 0 : 1;
+  }
+
+  bool BatchProcessor::Initialize()
+  {
+    const char* base = SDL_GetBasePath();
+    if (base) {
+      m_BasePath = std::string(base);
+    }
+
+    char* prefPath = SDL_GetPrefPath("Image2Card", "AnkiImage2Card");
+    std::string configPath = "config.json";
+    if (prefPath) {
+      configPath = std::string(prefPath) + "config.json";
+      SDL_free(prefPath);
+    }
+    m_ConfigManager = std::make_unique<Config::ConfigManager>(configPath);
+    auto& config = m_ConfigManager->GetConfig();
+
+    m_DeckName = config.LastDeck;
+    m_ModelName = config.LastNoteType;
+    if (m_DeckName.empty() || m_ModelName.empty()) {
+      AF_ERROR("Batch: no deck or note type selected. Pick them once in the GUI before using --batch.");
+      return false;
+    }
+
+    if (config.FieldMappings.count(m_ModelName)) {
+      for (const auto& [fieldName, mapping] : config.FieldMappings.at(m_ModelName)) {
+        if (mapping.first) {
+          m_FieldsByTool[mapping.second].push_back(fieldName);
+        }
+      }
+    }
+    if (m_FieldsByTool.empty()) {
+      AF_ERROR("Batch: note type '{}' has no auto-filled fields configured.", m_ModelName);
+      return false;
+    }
+
+    std::string ankiUrl = config.AnkiConnectUrl;
+    if (ankiUrl.empty())
+      ankiUrl = "http://localhost:8765";
+    m_AnkiConnectClient = std::make_unique<API::AnkiConnectClient>(ankiUrl);
+    m_AnkiConnectClient->SetLocalMediaPaths(config.AnkiLocalMediaPaths);
+    if (!m_AnkiConnectClient->Ping()) {
+      AF_ERROR("Batch: AnkiConnect is not reachable at {}", ankiUrl);
+      return false;
+    }
+
+    m_Language = std::make_unique<Language::JapaneseLanguage>();
+
+    m_TextAIProviders = Config::ServiceFactory::CreateTextProviders(config);
+
+    // Workers share the providers, so pick the models once up front instead of per request.
+    auto modelNameOf = [](const std::string& label) {
+      size_t slashPos = label.find('/');
+      return slashPos == std::string::npos ? label : label.substr(slashPos + 1);
+    };
+    if (auto* provider = GetTextProviderForModel(config.SelectedVisionModel);
+        provider && !config.SelectedVisionModel.empty())
+    {
+      provider->LoadConfig({{"vision_model", modelNameOf(config.SelectedVisionModel)}});
+    }
+    if (auto* provider = GetTextProviderForModel(config.SelectedAnalysisModel);
+        provider && !config.SelectedAnalysisModel.empty())
+    {
+      provider->LoadConfig({{"sentence_model", modelNameOf(config.SelectedAnalysisModel)}});
+    }
+
+    m_AudioAIProvider = Config::ServiceFactory::CreateAudioProvider(config, config.AudioProvider);
+
+    if (config.OCRMethod == "Tesseract") {
+      // One engine per worker unless configured, so workers never wait on each other for OCR.
+      size_t engineCount = config.TesseractEngineCount > 0 ? config.TesseractEngineCount : m_WorkerCount;
+      m_TesseractOCRProvider = std::make_unique<OCR::TesseractOCRProvider>(engineCount);
+      if (!m_TesseractOCRProvider->Initialize(m_BasePath + "tessdata", "jpn")) {
+        AF_WARN("Batch: failed to initialize Tesseract OCR, falling back to AI OCR.");
+      }
+    } else if (config.OCRMethod == "Native") {
+      m_NativeOCRProvider = std::make_unique<OCR::NativeOCRProvider>();
+    }
+
+    m_LanguageServices = Config::ServiceFactory::CreateLanguageServices(config, m_TextAIProviders, *m_Language);
+
+    m_SentenceAnalyzer = std::make_unique<Language::Analyzer::SentenceAnalyzer>();
+    m_SentenceAnalyzer->SetLanguageServices(&m_LanguageServices);
+    m_SentenceAnalyzer->SetPreferredTranslator(config.SelectedTranslator.empty() ? "none" : config.SelectedTranslator);
+    if (!m_SentenceAnalyzer->Initialize(m_BasePath)) {
+      AF_WARN("Batch: local sentence analyzer unavailable, AI analysis will be used.");
+    }
+
+    m_ForvoClient = std::make_unique<Language::Audio::ForvoClient>("ja", 10, 1);
+
+    return true;
+  }
+
+  std::vector<std::filesystem::path> BatchProcessor::CollectImages() const
+  {
+    std::vector<std::filesystem::path> images;
+
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(m_Directory, ec)) {
+      if (entry.is_regular_file() && !MimeTypeForPath(entry.path()).empty()) {
+        images.push_back(entry.path());
+      }
+    }
+    if (ec) {
+      AF_ERROR("Batch: cannot read directory {}: {}", m_Directory, ec.message());
+    }
+
+    std::sort(images.begin(), images.end());
+    return images;
+  }
+
+  void BatchProcessor::StartImage(const std::vector<std::filesystem::path>& images,
+                                  std::vector<std::promise<void>>& done,
+                                  size_t index)
+  {
+    // Batch priority keeps a worker free for anything interactive sharing the executor.
+    Core::TaskExecutor::Get().Post(Core::TaskPriority::Batch, [this, &images, &done, index]() {
+      const auto& imagePath = images[index];
+      bool ok = false;
+      try {
+        ok = ProcessImage(imagePath);
+      } catch (const std::exception& e) {
+        AF_ERROR("Batch: {} failed: {}", imagePath.filename().string(), e.what());
+      }
+
+      if (ok) {
+        m_Succeeded.fetch_add(1);
+      } else {
+        m_Failed.fetch_add(1);
+      }
+      AF_INFO("Batch: [{}/{}] {} {}",
+              m_Succeeded.load() + m_Failed.load(),
+              images.size(),
+              imagePath.filename().string(),
+              ok ? "added" : "failed");
+
+      // The next image is queued before this one counts as done, so Run cannot return while it is being queued.
+      size_t next = m_NextImage.fetch_add(1);
+      if (next < images.size()) {
+        StartImage(images, done, next);
+      }
+      done[index].set_value();
+    });
+  }
+
+  bool BatchProcessor::ProcessImage(const std::filesystem::path& imagePath)
+  {
+    auto& config = m_ConfigManager->GetConfig();
+
+    std::vector<unsigned char> imageBytes = ReadFileBytes(imagePath);
+    if (imageBytes.empty()) {
+      AF_ERROR("Batch: cannot read {}", imagePath.string());
+      return false;
+    }
+
+    auto stageStart = std::chrono::steady_clock::now();
+    std::string sentence = m_Language->PostProcessOCR(RunOCR(imageBytes, MimeTypeForPath(imagePath)));
+    RecordStage("ocr", stageStart);
+
+    if (sentence.empty()) {
+      AF_WARN("Batch: OCR returned no text for {}", imagePath.filename().string());
+      return false;
+    }
+
+    stageStart = std::chrono::steady_clock::now();
+
+    Pipeline::CardRequest request;
+    request.sentence = sentence;
+    request.languageCode = m_Language->GetLanguageCode();
+    request.audioFormat = config.AudioFormat;
+    request.audioExtension = Pipeline::CardPipeline::AudioExtension(config.AudioFormat, config.AudioProvider);
+    request.wantVocabAudio = m_FieldsByTool.count((int) Core::FieldTool::VocabAudio) > 0;
+    request.wantSentenceAudio = m_FieldsByTool.count((int) Core::FieldTool::SentenceAudio) > 0;
+
+    Pipeline::CardPipelineServices services;
+    services.analyzer = m_SentenceAnalyzer.get();
+    services.analysisProvider = GetTextProviderForModel(config.SelectedAnalysisModel);
+    services.language = m_Language.get();
+    services.forvoClient = m_ForvoClient.get();
+    services.audioProvider = m_AudioAIProvider.get();
+
+    Pipeline::CardPipeline pipeline(services);
+    pipeline.SetPriority(Core::TaskPriority::Batch);
+    Pipeline::CardResult card = pipeline.Run(request);
+    for (const auto& timing : pipeline.GetTimings()) {
+      RecordStage(timing.name, timing.durationMs);
+    }
+    RecordStage("card", stageStart);
+
+    std::map<int, std::string> textByTool = {
+        {(int) Core::FieldTool::SentenceText, card.sentence},
+        {(int) Core::FieldTool::SentenceFurigana, card.furigana},
+        {(int) Core::FieldTool::SentenceTranslation, card.translation},
+        {(int) Core::FieldTool::VocabWord, card.targetWord},
+        {(int) Core::FieldTool::VocabFurigana, card.targetWordFurigana},
+        {(int) Core::FieldTool::PitchAccent, card.pitchAccent},
+        {(int) Core::FieldTool::VocabDefinition, card.definition},
+    };
+
+    stageStart = std::chrono::steady_clock::now();
+    std::map<std::string, std::string> fields;
+    for (const auto& [tool, text] : textByTool) {
+      if (text.empty() || !m_FieldsByTool.count(tool)) {
+        continue;
+      }
+      for (const auto& fieldName : m_FieldsByTool.at(tool)) {
+        fields[fieldName] = text;
+      }
+    }
+
+    auto attachMedia = [&](Core::FieldTool tool, const std::vector<unsigned char>& data, const std::string& filename) {
+      if (data.empty() || !m_FieldsByTool.count((int) tool)) {
+        return;
+      }
+      std::string storedName = StoreMedia(data, filename);
+      if (storedName.empty()) {
+        return;
+      }
+      std::string value = tool == Core::FieldTool::Image ? "<img src=\"" + storedName + "\">"
+                                                         : "[sound:" + storedName + "]";
+      for (const auto& fieldName : m_FieldsByTool.at((int) tool)) {
+        fields[fieldName] = value;
+      }
+    };
+
+    if (m_FieldsByTool.count((int) Core::FieldTool::Image)) {
+      auto webp = Utils::ImageProcessor::ScaleAndCompressToWebP(imageBytes, 320, 320, 75);
+      if (webp.empty()) {
+        attachMedia(Core::FieldTool::Image, imageBytes, imagePath.filename().string());
+      } else {
+        attachMedia(Core::FieldTool::Image, webp, imagePath.stem().string() + ".webp");
+      }
+    }
+    attachMedia(Core::FieldTool::VocabAudio, card.vocabAudio, card.vocabAudioFilename);
+    attachMedia(Core::FieldTool::SentenceAudio, card.sentenceAudio, card.sentenceAudioFilename);
+
+    int64_t noteId = m_AnkiConnectClient->AddNote(m_DeckName, m_ModelName, fields, {"image2card", "image2card-batch"});
+    RecordStage("anki", stageStart);
+
+    return noteId > 0;
+  }
+
+  std::string BatchProcessor::RunOCR(const std::vector<unsigned char>& imageBytes, const std::string& mimeType)
+  {
+    auto& config = m_ConfigManager->GetConfig();
+
+    if (m_NativeOCRProvider && m_NativeOCRProvider->IsInitialized()) {
+      return m_NativeOCRProvider->ExtractTextFromImage(imageBytes);
+    }
+
+    if (m_TesseractOCRProvider && m_TesseractOCRProvider->IsInitialized()) {
+      OCR::TesseractOptions options;
+      options.orientation = OCR::ParseTesseractOrientation(config.TesseractOrientation);
+      options.preprocess = config.TesseractPreprocess;
+      return m_TesseractOCRProvider->ExtractTextFromImage(imageBytes, options);
+    }
+
+    auto* provider = GetTextProviderForModel(config.SelectedVisionModel);
+    if (!provider) {
+      throw std::runtime_error("No Text AI Provider found for selected vision model.");
+    }
+    if (config.AIUploadOptimize) {
+      Utils::ImageBuffer pixels = Utils::ImageProcessor::Decode(imageBytes);
+      if (!pixels.IsEmpty()) {
+        AI::PreparedImage upload = AI::ImageUpload::Prepare(pixels.View(), provider->GetImageUploadLimits());
+        AF_DEBUG("Uploading {} KB of {} instead of the {} KB file",
+                 upload.bytes.size() / 1024,
+                 upload.mimeType,
+                 imageBytes.size() / 1024);
+        return provider->ExtractTextFromImage(upload.bytes, upload.mimeType, *m_Language);
+      }
+    }
+    return provider->ExtractTextFromImage(imageBytes, mimeType, *m_Language);
+  }
+
+  std::string BatchProcessor::StoreMedia(const std::vector<unsigned char>& data, const std::string& filename)
+  {
+    auto now = std::chrono::system_clock::now();
+    auto timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
+    std::string uniqueFilename =
+        std::to_string(timestamp) + "_" + std::to_string(m_MediaCounter.fetch_add(1)) + "_" + filename;
+
+    if (!m_AnkiConnectClient->StoreMediaFile({uniqueFilename, data})) {
+      AF_ERROR("Batch: failed to upload media file: {}", uniqueFilename);
+      return "";
+    }
+    return uniqueFilename;
+  }
+
+  AI::ITextAIProvider* BatchProcessor::GetTextProviderForModel(const std::string& modelLabel)
+  {
+    return Config::ServiceFactory::FindTextProvider(m_TextAIProviders, modelLabel);
+  }
+
+  void BatchProcessor::RecordStage(const std::string& stage, std::chrono::steady_clock::time_point start)
+  {
+    RecordStage(stage, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+  }
+
+  void BatchProcessor::RecordStage(const std::string& stage, double milliseconds)
+  {
+    std::lock_guard<std::mutex> lock(m_StatsMutex);
+    m_StageSamples[stage].push_back(milliseconds);
+  }
+
+  void BatchProcessor::ReportSummary(std::chrono::steady_clock::duration elapsed) const
+  {
+    std::lock_guard<std::mutex> lock(m_StatsMutex);
+
+    double seconds = std::chrono::duration<double>(elapsed).count();
+    double cardsPerMinute = seconds > 0.0 ? m_Succeeded.load() * 60.0 / seconds : 0.0;
+
+    AF_INFO("Batch complete: {} added, {} failed in {:.1f}s ({:.1f} cards/min, {} workers)",
+            m_Succeeded.load(),
+            m_Failed.load(),
+            seconds,
+            cardsPerMinute,
+            m_WorkerCount);
+
+    for (const auto& [stage, stageSamples] : m_StageSamples) {
+      if (stageSamples.empty()) {
+        continue;
+      }
+      std::vector<double> samples = stageSamples;
+      std::sort(samples.begin(), samples.end());
+      double mean = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+      auto percentile = [&samples](double p) { return samples[(size_t) (p * (samples.size() - 1))]; };
+
+      AF_INFO("  {:<16} n={:<4} mean={:>8.1f}ms p50={:>8.1f}ms p95={:>8.1f}ms max={:>8.1f}ms",
+              stage,
+              samples.size(),
+              mean,
+              percentile(0.50),
+              percentile(0.95),
+              samples.back());
+    }
+  }
+
+} // namespace Image2Card::Batch
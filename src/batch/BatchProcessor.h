@@ -0,0 +1,135 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Image2Card::OCR
+{
+  class TesseractOCRProvider;
+  class NativeOCRProvider;
+} // namespace Image2Card::OCR
+
+namespace Image2Card::Language::Analyzer
+{
+  class SentenceAnalyzer;
+}
+
+namespace Image2Card::Language::Audio
+{
+  class ForvoClient;
+}
+
+namespace Image2Card::Language::Services
+{
+  class ILanguageService;
+}
+
+namespace Image2Card::Language
+{
+  class ILanguage;
+}
+
+namespace Image2Card::API
+{
+  class AnkiConnectClient;
+}
+
+namespace Image2Card::AI
+{
+  class ITextAIProvider;
+  class IAudioAIProvider;
+} // namespace Image2Card::AI
+
+namespace Image2Card::Config
+{
+  class ConfigManager;
+}
+
+namespace Image2Card::Batch
+{
+
+  /**
+ * Headless card miner. Runs every screenshot in a directory through
+ * OCR, sentence analysis, audio generation and AnkiConnect without
+ * creating a window, using the same configuration as the GUI.
+ */
+  class BatchProcessor
+  {
+public:
+
+    BatchProcessor(std::string directory, int workerCount);
+    ~BatchProcessor();
+
+    BatchProcessor(const BatchProcessor&) = delete;
+    BatchProcessor& operator=(const BatchProcessor&) = delete;
+
+    /**
+   * Process all images in the directory and print a summary.
+   * @return Process exit code (0 if every image produced a note)
+   */
+    int Run();
+
+private:
+
+    bool Initialize();
+
+    std::vector<std::filesystem::path> CollectImages() const;
+
+    /**
+   * Queue images[index] on the executor. When it finishes, its task queues the
+   * next unclaimed image and then fulfils done[index].
+   */
+    void StartImage(const std::vector<std::filesystem::path>& images,
+                    std::vector<std::promise<void>>& done,
+                    size_t index);
+    bool ProcessImage(const std::filesystem::path& imagePath);
+
+    std::string RunOCR(const std::vector<unsigned char>& imageBytes, const std::string& mimeType);
+    std::string StoreMedia(const std::vector<unsigned char>& data, const std::string& filename);
+
+    AI::ITextAIProvider* GetTextProviderForModel(const std::string& modelLabel);
+
+    void RecordStage(const std::string& stage, std::chrono::steady_clock::time_point start);
+    void RecordStage(const std::string& stage, double milliseconds);
+    void ReportSummary(std::chrono::steady_clock::duration elapsed) const;
+
+    std::string m_Directory;
+    int m_WorkerCount;
+    std::string m_BasePath;
+
+    std::string m_DeckName;
+    std::string m_ModelName;
+    std::map<int, std::vector<std::string>> m_FieldsByTool;
+
+    std::unique_ptr<Config::ConfigManager> m_ConfigManager;
+    std::unique_ptr<API::AnkiConnectClient> m_AnkiConnectClient;
+
+    std::vector<std::shared_ptr<AI::ITextAIProvider>> m_TextAIProviders;
+    std::unique_ptr<AI::IAudioAIProvider> m_AudioAIProvider;
+
+    std::unique_ptr<OCR::TesseractOCRProvider> m_TesseractOCRProvider;
+    std::unique_ptr<OCR::NativeOCRProvider> m_NativeOCRProvider;
+
+    std::vector<std::unique_ptr<Language::Services::ILanguageService>> m_LanguageServices;
+    std::unique_ptr<Language::Analyzer::SentenceAnalyzer> m_SentenceAnalyzer;
+    std::unique_ptr<Language::Audio::ForvoClient> m_ForvoClient;
+    std::unique_ptr<Language::ILanguage> m_Language;
+
+    std::atomic<size_t> m_NextImage{0};
+    std::atomic<int> m_Succeeded{0};
+    std::atomic<int> m_Failed{0};
+    std::atomic<uint64_t> m_MediaCounter{0};
+
+    mutable std::mutex m_StatsMutex;
+    std::map<std::string, std::vector<double>> m_StageSamples;
+  };
+
+} // namespace Image2Card::Batch
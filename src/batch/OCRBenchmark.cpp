@@ -0,0 +1,240 @@
+#include "batch/OCRBenchmark.h"
+
+#include <SDL3/SDL.h>
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <sstream>
+
+#include "config/ConfigManager.h"
+#include "core/Logger.h"
+#include "ocr/ImagePreprocessor.h"
+#include "ocr/OrientationDetector.h"
+#include "ocr/TesseractOCRProvider.h"
+#include "stb_image.h"
+#include "utils/ImageView.h"
+
+namespace Image2Card::Batch
+{
+
+  namespace
+  {
+    // Code points of text with whitespace removed, since line breaks and spacing are not OCR errors.
+    std::vector<char32_t> CodePoints(const std::string& text)
+    {
+      std::vector<char32_t> result;
+      for (size_t i = 0; i < text.size();) {
+        unsigned char lead = (unsigned char) text[i];
+        size_t length = lead < 0x80 ? 1 : (lead >> 5) == 0x6 ? 2 : (lead >> 4) == 0xE ? 3 : (lead >> 3) == 0x1E ? 4 : 1;
+        char32_t codePoint = length == 1 ? lead : lead & (0xFF >> (length + 1));
+        for (size_t k = 1; k < length && i + k < text.size(); ++k) {
+          codePoint = (codePoint << 6) | ((unsigned char) text[i + k] & 0x3F);
+        }
+        i += length;
+
+        bool whitespace = codePoint < 0x80 ? std::isspace((int) codePoint) != 0 : codePoint == 0x3000;
+        if (!whitespace) {
+          result.push_back(codePoint);
+        }
+      }
+      return result;
+    }
+
+    size_t EditDistance(const std::vector<char32_t>& a, const std::vector<char32_t>& b)
+    {
+      std::vector<size_t> previous(b.size() + 1);
+      std::vector<size_t> current(b.size() + 1);
+      for (size_t j = 0; j <= b.size(); ++j) {
+        previous[j] = j;
+      }
+      for (size_t i = 1; i <= a.size(); ++i) {
+        current[0] = i;
+        for (size_t j = 1; j <= b.size(); ++j) {
+          size_t substitution = previous[j - 1] + (a[i - 1] == b[j - 1] ? 0 : 1);
+          current[j] = std::min({previous[j] + 1, current[j - 1] + 1, substitution});
+        }
+        std::swap(previous, current);
+      }
+      return previous[b.size()];
+    }
+
+    // Median wall time of running work the given number of times.
+    double MedianMilliseconds(int iterations, const std::function<void()>& work)
+    {
+      std::vector<double> samples;
+      for (int i = 0; i < iterations; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        work();
+        samples.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+      }
+      std::sort(samples.begin(), samples.end());
+      return samples[samples.size() / 2];
+    }
+
+    double ErrorRate(size_t errors, size_t expectedLength)
+    {
+      return expectedLength > 0 ? 100.0 * errors / expectedLength : 0.0;
+    }
+  } // namespace
+
+  OCRBenchmark::OCRBenchmark(std::string directory, int iterations)
+      : m_Directory(std::move(directory))
+      , m_Iterations(std::max(1, iterations))
+  {}
+
+  std::vector<std::filesystem::path> OCRBenchmark::CollectImages() const
+  {
+    std::vector<std::filesystem::path> images;
+
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(m_Directory, ec)) {
+      std::string ext = entry.path().extension().string();
+      std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return (char) std::tolower(c); });
+      if (entry.is_regular_file() && (ext == ".png" || ext == ".jpg" || ext == ".jpeg" || ext == ".bmp")) {
+        images.push_back(entry.path());
+      }
+    }
+    if (ec) {
+      AF_ERROR("OCR benchmark: cannot read directory {}: {}", m_Directory, ec.message());
+    }
+
+    std::sort(images.begin(), images.end());
+    return images;
+  }
+
+  int OCRBenchmark::Run()
+  {
+    std::string basePath;
+    if (const char* base = SDL_GetBasePath()) {
+      basePath = base;
+    }
+
+    char* prefPath = SDL_GetPrefPath("Image2Card", "AnkiImage2Card");
+    std::string configPath = "config.json";
+    if (prefPath) {
+      configPath = std::string(prefPath) + "config.json";
+      SDL_free(prefPath);
+    }
+    Config::ConfigManager configManager(configPath);
+    std::string orientation = configManager.GetConfig().TesseractOrientation;
+
+    // One engine, so timings are per-image latency rather than throughput.
+    OCR::TesseractOCRProvider provider(1);
+    if (!provider.Initialize(basePath + "tessdata", "jpn")) {
+      AF_ERROR("OCR benchmark: Tesseract failed to initialize");
+      return 1;
+    }
+
+    auto images = CollectImages();
+    if (images.empty()) {
+      AF_ERROR("OCR benchmark: no images found in {}", m_Directory);
+      return 1;
+    }
+
+    AF_INFO("OCR benchmark: {} images, {} iterations each, {} text, kernels: {}",
+            images.size(),
+            m_Iterations,
+            orientation,
+            OCR::ImagePreprocessor::GetSimdLevel());
+
+    Totals raw;
+    Totals preprocessed;
+    double simdMilliseconds = 0.0;
+    double scalarMilliseconds = 0.0;
+    double detectMilliseconds = 0.0;
+
+    for (const auto& path : images) {
+      int width = 0, height = 0, channels = 0;
+      unsigned char* pixels = stbi_load(path.string().c_str(), &width, &height, &channels, 4);
+      if (!pixels) {
+        AF_WARN("OCR benchmark: cannot decode {}", path.filename().string());
+        continue;
+      }
+      Utils::ImageView image{pixels, width, height, width * 4, Utils::PixelFormat::RGBA32};
+
+      std::vector<char32_t> expected;
+      auto truthPath = std::filesystem::path(path).replace_extension(".txt");
+      bool hasTruth = std::filesystem::exists(truthPath);
+      if (hasTruth) {
+        std::ifstream file(truthPath, std::ios::binary);
+        std::stringstream contents;
+        contents << file.rdbuf();
+        expected = CodePoints(contents.str());
+      }
+
+      auto measure = [&](bool preprocess, Totals& totals) {
+        OCR::TesseractOptions options;
+        options.orientation = OCR::ParseTesseractOrientation(orientation);
+        options.preprocess = preprocess;
+        std::string text;
+        double milliseconds =
+            MedianMilliseconds(m_Iterations, [&]() { text = provider.ExtractTextFromPixels(image, options); });
+        totals.milliseconds += milliseconds;
+
+        size_t errors = 0;
+        if (hasTruth) {
+          errors = EditDistance(CodePoints(text), expected);
+          totals.errors += errors;
+          totals.expectedLength += expected.size();
+        }
+        return std::make_pair(milliseconds, errors);
+      };
+
+      auto [rawMs, rawErrors] = measure(false, raw);
+      auto [preMs, preErrors] = measure(true, preprocessed);
+
+      OCR::OrientationEstimate estimate;
+      detectMilliseconds +=
+          MedianMilliseconds(m_Iterations, [&]() { estimate = OCR::OrientationDetector::Detect(image); });
+
+      OCR::PreprocessOptions options;
+      options.verticalText = orientation == "auto" ? estimate.vertical : orientation == "vertical";
+      OCR::ImagePreprocessor::SetSimdEnabled(false);
+      scalarMilliseconds += MedianMilliseconds(m_Iterations, [&]() { OCR::ImagePreprocessor::Run(image, options); });
+      OCR::ImagePreprocessor::SetSimdEnabled(true);
+      simdMilliseconds += MedianMilliseconds(m_Iterations, [&]() { OCR::ImagePreprocessor::Run(image, options); });
+
+      if (hasTruth) {
+        AF_INFO("  {:<32} {}x{} {}  raw {:>8.1f}ms CER {:>5.1f}%  preprocessed {:>8.1f}ms CER {:>5.1f}%",
+                path.filename().string(),
+                width,
+                height,
+                estimate.vertical ? "V" : "H",
+                rawMs,
+                ErrorRate(rawErrors, expected.size()),
+                preMs,
+                ErrorRate(preErrors, expected.size()));
+      } else {
+        AF_INFO("  {:<32} {}x{} {}  raw {:>8.1f}ms  preprocessed {:>8.1f}ms",
+                path.filename().string(),
+                width,
+                height,
+                estimate.vertical ? "V" : "H",
+                rawMs,
+                preMs);
+      }
+
+      stbi_image_free(pixels);
+    }
+
+    AF_INFO("Without preprocessing: {:>9.1f}ms total, CER {:.1f}%",
+            raw.milliseconds,
+            ErrorRate(raw.errors, raw.expectedLength));
+    AF_INFO("With preprocessing:    {:>9.1f}ms total, CER {:.1f}%",
+            preprocessed.milliseconds,
+            ErrorRate(preprocessed.errors, preprocessed.expectedLength));
+    AF_INFO("Preprocessing alone:   {:>9.1f}ms {} vs {:.1f}ms scalar",
+            simdMilliseconds,
+            OCR::ImagePreprocessor::GetSimdLevel(),
+            scalarMilliseconds);
+    AF_INFO("Orientation detection: {:>9.1f}ms total", detectMilliseconds);
+    if (raw.expectedLength == 0) {
+      AF_INFO("Add a .txt with the expected text next to an image to measure accuracy.");
+    }
+    return 0;
+  }
+
+} // namespace Image2Card::Batch
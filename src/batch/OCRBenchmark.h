@@ -0,0 +1,43 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace Image2Card::Batch
+{
+
+  /**
+ * Compares Tesseract with and without image preprocessing over a directory of
+ * screenshots, using the tessdata and orientation the GUI is configured with.
+ * An image may have its expected text in a .txt file of the same name; those
+ * images also report the character error rate of each run.
+ */
+  class OCRBenchmark
+  {
+public:
+
+    OCRBenchmark(std::string directory, int iterations);
+
+    /**
+   * Run every image through both configurations and print the results.
+   * @return Process exit code (0 if the benchmark ran)
+   */
+    int Run();
+
+private:
+
+    struct Totals
+    {
+      double milliseconds = 0.0;
+      size_t errors = 0;
+      size_t expectedLength = 0;
+    };
+
+    std::vector<std::filesystem::path> CollectImages() const;
+
+    std::string m_Directory;
+    int m_Iterations;
+  };
+
+} // namespace Image2Card::Batch
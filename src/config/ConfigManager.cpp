@@ -27,10 +27,14 @@ namespace Image2Card::Config
 
       if (j.contains("anki_connect_url"))
         m_Config.AnkiConnectUrl = j["anki_connect_url"];
+      if (j.contains("anki_local_media_paths"))
+        m_Config.AnkiLocalMediaPaths = j["anki_local_media_paths"];
       if (j.contains("anki_decks"))
         m_Config.AnkiDecks = j["anki_decks"].get<std::vector<std::string>>();
       if (j.contains("anki_note_types"))
         m_Config.AnkiNoteTypes = j["anki_note_types"].get<std::vector<std::string>>();
+      if (j.contains("anki_model_fields"))
+        m_Config.AnkiModelFields = j["anki_model_fields"].get<std::map<std::string, std::vector<std::string>>>();
 
       if (j.contains("selected_language"))
         m_Config.SelectedLanguage = j["selected_language"];
@@ -112,6 +116,20 @@ namespace Image2Card::Config
         m_Config.OCRMethod = j["ocr_method"];
       if (j.contains("tesseract_orientation"))
         m_Config.TesseractOrientation = j["tesseract_orientation"];
+      if (j.contains("tesseract_engine_count"))
+        m_Config.TesseractEngineCount = j["tesseract_engine_count"];
+      if (j.contains("tesseract_preprocess"))
+        m_Config.TesseractPreprocess = j["tesseract_preprocess"];
+      if (j.contains("cascade_min_confidence"))
+        m_Config.CascadeMinConfidence = j["cascade_min_confidence"];
+      if (j.contains("cascade_hedge_delay_ms"))
+        m_Config.CascadeHedgeDelayMs = j["cascade_hedge_delay_ms"];
+      if (j.contains("ocr_cache_enabled"))
+        m_Config.OCRCacheEnabled = j["ocr_cache_enabled"];
+      if (j.contains("ocr_cache_size_mb"))
+        m_Config.OCRCacheSizeMB = j["ocr_cache_size_mb"];
+      if (j.contains("ai_upload_optimize"))
+        m_Config.AIUploadOptimize = j["ai_upload_optimize"];
 
       if (j.contains("audio_provider"))
         m_Config.AudioProvider = j["audio_provider"];
@@ -155,8 +173,10 @@ namespace Image2Card::Config
     nlohmann::json j;
 
     j["anki_connect_url"] = m_Config.AnkiConnectUrl;
+    j["anki_local_media_paths"] = m_Config.AnkiLocalMediaPaths;
     j["anki_decks"] = m_Config.AnkiDecks;
     j["anki_note_types"] = m_Config.AnkiNoteTypes;
+    j["anki_model_fields"] = m_Config.AnkiModelFields;
 
     j["selected_language"] = m_Config.SelectedLanguage;
 
@@ -191,6 +211,13 @@ namespace Image2Card::Config
 
     j["ocr_method"] = m_Config.OCRMethod;
     j["tesseract_orientation"] = m_Config.TesseractOrientation;
+    j["tesseract_engine_count"] = m_Config.TesseractEngineCount;
+    j["tesseract_preprocess"] = m_Config.TesseractPreprocess;
+    j["cascade_min_confidence"] = m_Config.CascadeMinConfidence;
+    j["cascade_hedge_delay_ms"] = m_Config.CascadeHedgeDelayMs;
+    j["ocr_cache_enabled"] = m_Config.OCRCacheEnabled;
+    j["ocr_cache_size_mb"] = m_Config.OCRCacheSizeMB;
+    j["ai_upload_optimize"] = m_Config.AIUploadOptimize;
 
     j["audio_provider"] = m_Config.AudioProvider;
     j["audio_format"] = m_Config.AudioFormat;
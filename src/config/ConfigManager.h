@@ -12,8 +12,10 @@ namespace Image2Card::Config
   struct AppConfig
   {
     std::string AnkiConnectUrl = "http://localhost:8765";
+    bool AnkiLocalMediaPaths = true; // Pass media to a local AnkiConnect as file paths instead of base64
     std::vector<std::string> AnkiDecks;
     std::vector<std::string> AnkiNoteTypes;
+    std::map<std::string, std::vector<std::string>> AnkiModelFields; // Field names per note type, for working offline
 
     std::string SelectedLanguage = "JP";
 
@@ -42,8 +44,15 @@ namespace Image2Card::Config
     std::vector<std::pair<std::string, std::string>> MiniMaxAvailableVoices;
 
     // OCR Configuration
-    std::string OCRMethod = "Tesseract";             // "AI" or "Tesseract"
-    std::string TesseractOrientation = "horizontal"; // "horizontal" or "vertical"
+    std::string OCRMethod = "Tesseract";             // "AI", "Tesseract", "Native" or "Cascade"
+    std::string TesseractOrientation = "auto";       // "auto", "horizontal" or "vertical"
+    int TesseractEngineCount = 0;                    // Concurrent Tesseract engines, 0 = half the CPU threads
+    bool TesseractPreprocess = true;                 // Grayscale, rescale and binarize crops before Tesseract
+    float CascadeMinConfidence = 70.0f;              // Cascade: Tesseract word confidence below this asks AI
+    int CascadeHedgeDelayMs = 0;                     // Cascade: start AI this long into Tesseract, 0 = wait
+    bool OCRCacheEnabled = true;                     // Reuse OCR results for crops that were recognized before
+    int OCRCacheSizeMB = 32;                         // Size limit of the OCR result cache
+    bool AIUploadOptimize = true;                    // Downscale and send WebP/JPEG to vision models instead of PNG
 
     // DeepL Translation Configuration
     std::string DeepLApiKey;
@@ -0,0 +1,118 @@
+#include "config/ServiceFactory.h"
+
+#include "ai/ElevenLabsAudioProvider.h"
+#include "ai/GoogleTextProvider.h"
+#include "ai/MiniMaxAudioProvider.h"
+#include "ai/NativeAudioProvider.h"
+#include "ai/XAiTextProvider.h"
+#include "language/ILanguage.h"
+#include "language/services/AITranslationService.h"
+#include "language/services/DeepLService.h"
+#include "language/services/GoogleTranslateService.h"
+#include "language/services/NoneTranslationService.h"
+
+namespace Image2Card::Config::ServiceFactory
+{
+
+  namespace
+  {
+    nlohmann::json VoicesToJson(const std::vector<std::pair<std::string, std::string>>& voices)
+    {
+      nlohmann::json voicesJson = nlohmann::json::array();
+      for (const auto& voice : voices) {
+        voicesJson.push_back({voice.first, voice.second});
+      }
+      return voicesJson;
+    }
+  } // namespace
+
+  TextProviders CreateTextProviders(const AppConfig& config)
+  {
+    TextProviders providers;
+    providers.push_back(std::make_shared<AI::GoogleTextProvider>());
+    providers.push_back(std::make_shared<AI::XAiTextProvider>());
+
+    for (auto& provider : providers) {
+      nlohmann::json providerConfig;
+      if (provider->GetId() == "xai") {
+        providerConfig["api_key"] = config.TextApiKey;
+        providerConfig["available_models"] = config.TextAvailableModels;
+      } else if (provider->GetId() == "google") {
+        providerConfig["api_key"] = config.GoogleApiKey;
+        providerConfig["available_models"] = config.GoogleAvailableModels;
+      }
+      provider->LoadConfig(providerConfig);
+    }
+    return providers;
+  }
+
+  std::unique_ptr<AI::IAudioAIProvider> CreateAudioProvider(const AppConfig& config, const std::string& providerId)
+  {
+    std::unique_ptr<AI::IAudioAIProvider> provider;
+    nlohmann::json audioConfig;
+    if (providerId == "native") {
+      provider = std::make_unique<AI::NativeAudioProvider>();
+    } else if (providerId == "minimax") {
+      provider = std::make_unique<AI::MiniMaxAudioProvider>();
+      audioConfig["api_key"] = config.MiniMaxApiKey;
+      audioConfig["voice_id"] = config.MiniMaxVoiceId;
+      audioConfig["model"] = config.MiniMaxModel;
+      audioConfig["available_voices"] = VoicesToJson(config.MiniMaxAvailableVoices);
+    } else {
+      provider = std::make_unique<AI::ElevenLabsAudioProvider>();
+      audioConfig["api_key"] = config.ElevenLabsApiKey;
+      audioConfig["voice_id"] = config.ElevenLabsVoiceId;
+      audioConfig["available_voices"] = VoicesToJson(config.ElevenLabsAvailableVoices);
+    }
+    provider->LoadConfig(audioConfig);
+    return provider;
+  }
+
+  LanguageServices CreateLanguageServices(const AppConfig& config,
+                                          const TextProviders& textProviders,
+                                          const Language::ILanguage& language)
+  {
+    LanguageServices services;
+    services.push_back(std::make_unique<Language::Services::NoneTranslationService>());
+
+    auto deeplService = std::make_unique<Language::Services::DeepLService>();
+    nlohmann::json deeplConfig;
+    deeplConfig["api_key"] = config.DeepLApiKey;
+    deeplConfig["use_free_api"] = config.DeepLUseFreeAPI;
+    deeplConfig["source_lang"] = config.DeepLSourceLang;
+    deeplConfig["target_lang"] = config.DeepLTargetLang;
+    deeplService->LoadConfig(deeplConfig);
+    services.push_back(std::move(deeplService));
+
+    auto googleTranslateService = std::make_unique<Language::Services::GoogleTranslateService>();
+    nlohmann::json googleConfig;
+    googleConfig["source_lang"] = "ja";
+    googleConfig["target_lang"] = "en";
+    googleTranslateService->LoadConfig(googleConfig);
+    services.push_back(std::move(googleTranslateService));
+
+    for (const auto& provider : textProviders) {
+      services.push_back(std::make_unique<Language::Services::AITranslationService>(provider, language));
+    }
+    return services;
+  }
+
+  AI::ITextAIProvider* FindTextProvider(const TextProviders& textProviders, const std::string& modelLabel)
+  {
+    std::string providerName;
+    size_t slashPos = modelLabel.find('/');
+    if (slashPos != std::string::npos) {
+      providerName = modelLabel.substr(0, slashPos);
+    }
+
+    for (const auto& provider : textProviders) {
+      if ((providerName == "xAI" && provider->GetId() == "xai") ||
+          (providerName == "Google" && provider->GetId() == "google"))
+      {
+        return provider.get();
+      }
+    }
+    return textProviders.empty() ? nullptr : textProviders.front().get();
+  }
+
+} // namespace Image2Card::Config::ServiceFactory
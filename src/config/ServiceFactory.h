@@ -0,0 +1,61 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "config/ConfigManager.h"
+
+namespace Image2Card::AI
+{
+  class ITextAIProvider;
+  class IAudioAIProvider;
+} // namespace Image2Card::AI
+
+namespace Image2Card::Language
+{
+  class ILanguage;
+}
+
+namespace Image2Card::Language::Services
+{
+  class ILanguageService;
+}
+
+namespace Image2Card::Config
+{
+
+  /**
+ * Builds the AI providers and language services from the saved configuration.
+ * The GUI and batch mode both go through these, so they are set up the same way.
+ */
+  namespace ServiceFactory
+  {
+    using TextProviders = std::vector<std::shared_ptr<AI::ITextAIProvider>>;
+    using LanguageServices = std::vector<std::unique_ptr<Language::Services::ILanguageService>>;
+
+    /**
+   * Google and xAI text providers with their API keys and model lists.
+   */
+    TextProviders CreateTextProviders(const AppConfig& config);
+
+    /**
+   * @param providerId "native", "minimax" or "elevenlabs"; anything else is ElevenLabs
+   */
+    std::unique_ptr<AI::IAudioAIProvider> CreateAudioProvider(const AppConfig& config, const std::string& providerId);
+
+    /**
+   * None, DeepL and Google Translate, followed by one AI translation service per text provider.
+   */
+    LanguageServices CreateLanguageServices(const AppConfig& config,
+                                            const TextProviders& textProviders,
+                                            const Language::ILanguage& language);
+
+    /**
+   * @param modelLabel "Provider/model" as stored in the configuration
+   * @return The provider named by the label, or the first provider if it names none
+   */
+    AI::ITextAIProvider* FindTextProvider(const TextProviders& textProviders, const std::string& modelLabel);
+  } // namespace ServiceFactory
+
+} // namespace Image2Card::Config
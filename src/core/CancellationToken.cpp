@@ -0,0 +1,142 @@
+#include "core/CancellationToken.h"
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <mutex>
+
+namespace Image2Card::Core
+{
+
+  struct CancellationToken::State
+  {
+    std::atomic<bool> cancelled{false};
+    std::atomic<Clock::rep> deadline{Clock::time_point::max().time_since_epoch().count()};
+
+    std::mutex mutex;
+    std::map<uint64_t, std::function<void()>> callbacks;
+    uint64_t nextId = 1;
+
+    Clock::time_point Deadline() const { return Clock::time_point(Clock::duration(deadline.load())); }
+  };
+
+  CancellationToken::CancellationToken(std::shared_ptr<State> state)
+      : m_State(std::move(state))
+  {}
+
+  bool CancellationToken::IsCancelled() const
+  {
+    if (!m_State) {
+      return false;
+    }
+    return m_State->cancelled.load() || Clock::now() >= m_State->Deadline();
+  }
+
+  bool CancellationToken::HasDeadline() const
+  {
+    return m_State && m_State->Deadline() != Clock::time_point::max();
+  }
+
+  std::chrono::milliseconds CancellationToken::ClampTimeout(std::chrono::milliseconds timeout) const
+  {
+    if (!HasDeadline()) {
+      return timeout;
+    }
+    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(m_State->Deadline() - Clock::now());
+    return std::max(std::chrono::milliseconds(1), std::min(timeout, remaining));
+  }
+
+  uint64_t CancellationToken::Register(std::function<void()> callback) const
+  {
+    if (!m_State) {
+      return 0;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(m_State->mutex);
+      if (!m_State->cancelled.load()) {
+        uint64_t id = m_State->nextId++;
+        m_State->callbacks.emplace(id, std::move(callback));
+        return id;
+      }
+    }
+
+    callback();
+    return 0;
+  }
+
+  void CancellationToken::Unregister(uint64_t id) const
+  {
+    if (!m_State || id == 0) {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(m_State->mutex);
+    m_State->callbacks.erase(id);
+  }
+
+  CancellationSource::CancellationSource()
+      : m_State(std::make_shared<CancellationToken::State>())
+  {}
+
+  CancellationSource::CancellationSource(std::shared_ptr<CancellationToken::State> state)
+      : m_State(std::move(state))
+  {}
+
+  CancellationSource CancellationSource::CreateLinked(const CancellationToken& parent)
+  {
+    CancellationSource source;
+    if (!parent.m_State) {
+      return source;
+    }
+
+    source.m_State->deadline.store(parent.m_State->deadline.load());
+
+    // Weak so a parent that outlives the linked source does not keep its state alive.
+    std::weak_ptr<CancellationToken::State> weak = source.m_State;
+    source.m_ParentLink = std::make_shared<ScopedCancellationCallback>(parent, [weak]() {
+      if (auto state = weak.lock()) {
+        CancellationSource(std::move(state)).Cancel();
+      }
+    });
+    return source;
+  }
+
+  CancellationToken CancellationSource::GetToken() const
+  {
+    return CancellationToken(m_State);
+  }
+
+  void CancellationSource::Cancel()
+  {
+    // Callbacks run under the lock so Unregister cannot return while one is still using its target.
+    std::lock_guard<std::mutex> lock(m_State->mutex);
+    if (m_State->cancelled.exchange(true)) {
+      return;
+    }
+    for (auto& [id, callback] : m_State->callbacks) {
+      callback();
+    }
+    m_State->callbacks.clear();
+  }
+
+  void CancellationSource::SetDeadline(CancellationToken::Clock::time_point deadline)
+  {
+    m_State->deadline.store(deadline.time_since_epoch().count());
+  }
+
+  bool CancellationSource::IsCancelled() const
+  {
+    return CancellationToken(m_State).IsCancelled();
+  }
+
+  ScopedCancellationCallback::ScopedCancellationCallback(const CancellationToken& token, std::function<void()> callback)
+      : m_Token(token)
+      , m_Id(token.Register(std::move(callback)))
+  {}
+
+  ScopedCancellationCallback::~ScopedCancellationCallback()
+  {
+    m_Token.Unregister(m_Id);
+  }
+
+} // namespace Image2Card::Core
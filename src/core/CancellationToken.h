@@ -0,0 +1,120 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+namespace Image2Card::Core
+{
+
+  /**
+ * Read-only view of a cancellation request and an optional absolute deadline.
+ * Copies share state with the CancellationSource that created them. A
+ * default-constructed token is never cancelled and has no deadline, so it can
+ * be used as a default argument for callers that do not care.
+ */
+  class CancellationToken
+  {
+public:
+
+    using Clock = std::chrono::steady_clock;
+
+    CancellationToken() = default;
+
+    /**
+   * @return true once Cancel() was called on the source or the deadline has passed
+   */
+    [[nodiscard]] bool IsCancelled() const;
+
+    [[nodiscard]] bool HasDeadline() const;
+
+    /**
+   * Clamp a timeout so it does not run past the deadline.
+   * @param timeout Timeout the operation would use without a deadline
+   * @return The smaller of timeout and the time left, and at least 1ms so it stays a valid timeout
+   */
+    [[nodiscard]] std::chrono::milliseconds ClampTimeout(std::chrono::milliseconds timeout) const;
+
+    /**
+   * Register a callback run on the cancelling thread when Cancel() is called.
+   * Runs immediately if the token is already cancelled. Callbacks must be quick
+   * and must not block; they typically abort a blocking call on another thread.
+   * @return Registration id for Unregister, 0 if nothing was registered
+   */
+    uint64_t Register(std::function<void()> callback) const;
+
+    void Unregister(uint64_t id) const;
+
+private:
+
+    friend class CancellationSource;
+    struct State;
+
+    explicit CancellationToken(std::shared_ptr<State> state);
+
+    std::shared_ptr<State> m_State;
+  };
+
+  class ScopedCancellationCallback;
+
+  /**
+ * Owner side of a CancellationToken.
+ */
+  class CancellationSource
+  {
+public:
+
+    CancellationSource();
+
+    /**
+   * Create a source that is cancelled when parent is and shares its deadline.
+   * Cancelling the new source does not affect the parent, which makes it suitable
+   * for abandoning one request of several running under the same parent. The link
+   * is removed from the parent once the new source and all its copies are gone.
+   */
+    [[nodiscard]] static CancellationSource CreateLinked(const CancellationToken& parent);
+
+    [[nodiscard]] CancellationToken GetToken() const;
+
+    /**
+   * Request cancellation and run registered callbacks. Only the first call has an effect.
+   */
+    void Cancel();
+
+    /**
+   * Set an absolute deadline after which the token reports cancelled.
+   */
+    void SetDeadline(CancellationToken::Clock::time_point deadline);
+
+    [[nodiscard]] bool IsCancelled() const;
+
+private:
+
+    explicit CancellationSource(std::shared_ptr<CancellationToken::State> state);
+
+    std::shared_ptr<CancellationToken::State> m_State;
+    std::shared_ptr<ScopedCancellationCallback> m_ParentLink; // Shared by copies; set by CreateLinked
+  };
+
+  /**
+ * Keeps a callback registered on a token for the lifetime of a scope, e.g. to
+ * stop an HTTP client while a request on it is in flight.
+ */
+  class ScopedCancellationCallback
+  {
+public:
+
+    ScopedCancellationCallback(const CancellationToken& token, std::function<void()> callback);
+    ~ScopedCancellationCallback();
+
+    ScopedCancellationCallback(const ScopedCancellationCallback&) = delete;
+    ScopedCancellationCallback& operator=(const ScopedCancellationCallback&) = delete;
+
+private:
+
+    CancellationToken m_Token;
+    uint64_t m_Id;
+  };
+
+} // namespace Image2Card::Core
@@ -0,0 +1,51 @@
+#include "core/MainThreadDispatcher.h"
+
+#include <exception>
+
+#include "core/Logger.h"
+
+namespace Image2Card::Core
+{
+
+  void MainThreadDispatcher::Post(std::function<void()> function)
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Pending.push_back(std::move(function));
+  }
+
+  size_t MainThreadDispatcher::Drain()
+  {
+    std::vector<std::function<void()>> ready;
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      ready.swap(m_Pending);
+    }
+
+    for (auto& function : ready) {
+      try {
+        function();
+      } catch (const std::exception& e) {
+        AF_ERROR("Main thread continuation threw exception: {}", e.what());
+      } catch (...) {
+        AF_ERROR("Main thread continuation threw unknown exception");
+      }
+    }
+    return ready.size();
+  }
+
+  void MainThreadDispatcher::Clear()
+  {
+    std::vector<std::function<void()>> dropped;
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      dropped.swap(m_Pending);
+    }
+  }
+
+  size_t MainThreadDispatcher::GetPendingCount() const
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Pending.size();
+  }
+
+} // namespace Image2Card::Core
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace Image2Card::Core
+{
+
+  /**
+ * Queue of continuations that must run on the main (UI) thread.
+ * Background tasks post to it when they finish; the main loop drains it once
+ * per frame, so the cost of a frame is proportional to what actually completed.
+ */
+  class MainThreadDispatcher
+  {
+public:
+
+    /**
+   * Queue a function to run on the next Drain. Safe to call from any thread.
+   */
+    void Post(std::function<void()> function);
+
+    /**
+   * Run everything queued so far on the calling thread. Functions posted while
+   * draining run on the next call. Exceptions are logged and swallowed.
+   * @return Number of functions run
+   */
+    size_t Drain();
+
+    /**
+   * Drop queued functions without running them.
+   */
+    void Clear();
+
+    [[nodiscard]] size_t GetPendingCount() const;
+
+private:
+
+    mutable std::mutex m_Mutex;
+    std::vector<std::function<void()>> m_Pending;
+  };
+
+} // namespace Image2Card::Core
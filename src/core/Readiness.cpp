@@ -0,0 +1,105 @@
+#include "core/Readiness.h"
+
+#include <exception>
+
+#include "core/Logger.h"
+#include "core/Trace.h"
+
+namespace Image2Card::Core
+{
+
+  Readiness::Readiness(std::string name)
+      : m_Name(std::move(name))
+      , m_Begin(Clock::now())
+  {}
+
+  void Readiness::Begin()
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Begin = Clock::now();
+  }
+
+  void Readiness::Start(std::function<std::string()> initialize)
+  {
+    Begin();
+    m_Loader.Post([this, initialize = std::move(initialize)]() {
+      AF_TRACE_SCOPE("startup", "Load subsystem");
+      try {
+        std::string failure = initialize();
+        if (failure.empty()) {
+          MarkReady();
+        } else {
+          MarkFailed(std::move(failure));
+        }
+      } catch (const std::exception& e) {
+        MarkFailed(e.what());
+      }
+    });
+  }
+
+  void Readiness::MarkReady()
+  {
+    Settle(ReadyState::Ready, "");
+  }
+
+  void Readiness::MarkFailed(std::string reason)
+  {
+    Settle(ReadyState::Failed, std::move(reason));
+  }
+
+  void Readiness::Settle(ReadyState state, std::string reason)
+  {
+    double milliseconds = 0.0;
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      m_State = state;
+      m_FailureReason = std::move(reason);
+      m_End = Clock::now();
+      milliseconds = std::chrono::duration<double, std::milli>(m_End - m_Begin).count();
+    }
+    m_Settled.notify_all();
+
+    if (state == ReadyState::Ready) {
+      AF_INFO("{} ready in {:.0f} ms", m_Name, milliseconds);
+    } else {
+      AF_WARN("{} failed to load after {:.0f} ms: {}", m_Name, milliseconds, GetFailureReason());
+    }
+  }
+
+  ReadyState Readiness::GetState() const
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_State;
+  }
+
+  bool Readiness::Wait(const CancellationToken& cancellation) const
+  {
+    // Only the loading task is run here, never unrelated work that could hold up this waiter.
+    if (GetState() == ReadyState::Loading && !cancellation.IsCancelled()) {
+      m_Loader.RunPendingTask();
+    }
+
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    while (m_State == ReadyState::Loading && !cancellation.IsCancelled()) {
+      // Cancellation has no wakeup of its own, so it is checked every few milliseconds.
+      m_Settled.wait_for(lock, std::chrono::milliseconds(20));
+    }
+    return m_State == ReadyState::Ready;
+  }
+
+  std::string Readiness::GetFailureReason() const
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_FailureReason;
+  }
+
+  double Readiness::GetMilliseconds() const
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (m_State == ReadyState::Loading) {
+      return 0.0;
+    }
+    return std::chrono::duration<double, std::milli>(m_End - m_Begin).count();
+  }
+
+} // namespace Image2Card::Core
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+
+#include "core/CancellationToken.h"
+#include "core/TaskExecutor.h"
+
+namespace Image2Card::Core
+{
+
+  enum class ReadyState
+  {
+    Loading, // Not started yet, or initializing in the background
+    Ready,
+    Failed
+  };
+
+  /**
+ * Readiness of a subsystem that initializes in the background while the UI is
+ * already running. The loading task marks it ready or failed; code that needs
+ * the subsystem checks the state or waits for it. Settling the state publishes
+ * everything the loading task wrote, so after IsReady() returns true (or Wait
+ * returns) the subsystem can be used without further synchronization.
+ */
+  class Readiness
+  {
+public:
+
+    using Clock = std::chrono::steady_clock;
+
+    explicit Readiness(std::string name);
+
+    Readiness(const Readiness&) = delete;
+    Readiness& operator=(const Readiness&) = delete;
+
+    /**
+   * Note that loading started, for the load time reported by GetMilliseconds.
+   */
+    void Begin();
+
+    /**
+   * Begin loading on an executor worker. The subsystem is marked ready if
+   * initialize returns an empty string, failed with the returned reason (or
+   * exception message) otherwise.
+   */
+    void Start(std::function<std::string()> initialize);
+
+    void MarkReady();
+    void MarkFailed(std::string reason);
+
+    [[nodiscard]] ReadyState GetState() const;
+    [[nodiscard]] bool IsReady() const { return GetState() == ReadyState::Ready; }
+    [[nodiscard]] bool IsFailed() const { return GetState() == ReadyState::Failed; }
+
+    /**
+   * Block until the subsystem is ready or failed. If no worker has picked up the
+   * loading task yet, it runs on the calling thread, so waiting cannot starve it.
+   * @return true if the subsystem is ready, false if it failed or the wait was cancelled
+   */
+    bool Wait(const CancellationToken& cancellation = {}) const;
+
+    [[nodiscard]] const std::string& GetName() const { return m_Name; }
+    [[nodiscard]] std::string GetFailureReason() const;
+
+    /**
+   * @return Time from Begin to ready or failed, 0 while loading
+   */
+    [[nodiscard]] double GetMilliseconds() const;
+
+private:
+
+    void Settle(ReadyState state, std::string reason);
+
+    const std::string m_Name;
+    mutable std::mutex m_Mutex;
+    mutable std::condition_variable m_Settled;
+    ReadyState m_State = ReadyState::Loading;
+    std::string m_FailureReason;
+    Clock::time_point m_Begin;
+    Clock::time_point m_End;
+    mutable TaskGroup m_Loader{TaskPriority::Interactive};
+  };
+
+} // namespace Image2Card::Core
@@ -0,0 +1,394 @@
+#include "core/TaskExecutor.h"
+
+#include <algorithm>
+#include <exception>
+#include <string>
+
+#include "core/Logger.h"
+#include "core/Trace.h"
+
+namespace Image2Card::Core
+{
+
+  namespace
+  {
+    constexpr size_t NoWorker = static_cast<size_t>(-1);
+
+    thread_local const TaskExecutor* t_Executor = nullptr;
+    thread_local size_t t_WorkerIndex = NoWorker;
+  } // namespace
+
+  TaskExecutor& TaskExecutor::Get()
+  {
+    static TaskExecutor executor;
+    return executor;
+  }
+
+  TaskExecutor::TaskExecutor(size_t workerCount)
+  {
+    if (workerCount == 0) {
+      // Most tasks block on network I/O, so allow more workers than cores.
+      workerCount = std::max<size_t>(4, std::thread::hardware_concurrency());
+    }
+    m_MaxBatchRunning = std::max<size_t>(1, workerCount - 1);
+
+    m_Workers.reserve(workerCount);
+    for (size_t i = 0; i < workerCount; ++i) {
+      m_Workers.push_back(std::make_unique<Worker>());
+    }
+    for (size_t i = 0; i < workerCount; ++i) {
+      m_Workers[i]->thread = std::thread([this, i]() { WorkerLoop(i); });
+    }
+    m_TimerThread = std::thread([this]() { TimerLoop(); });
+
+    AF_INFO("TaskExecutor started with {} workers (batch limit {})", workerCount, m_MaxBatchRunning);
+  }
+
+  TaskExecutor::~TaskExecutor()
+  {
+    Shutdown();
+  }
+
+  void TaskExecutor::Post(TaskPriority priority, std::function<void()> function)
+  {
+    if (m_Stopping.load()) {
+      AF_WARN("TaskExecutor: task posted after shutdown was dropped");
+      return;
+    }
+
+    Task task;
+    task.function = std::move(function);
+    task.priority = priority;
+    task.enqueued = std::chrono::steady_clock::now();
+
+    size_t lane = static_cast<size_t>(priority);
+    if (t_Executor == this && t_WorkerIndex != NoWorker) {
+      auto& worker = *m_Workers[t_WorkerIndex];
+      std::lock_guard<std::mutex> lock(worker.mutex);
+      worker.lanes[lane].push_back(std::move(task));
+    } else {
+      std::lock_guard<std::mutex> lock(m_InjectMutex);
+      m_Injected[lane].push_back(std::move(task));
+    }
+    m_Queued[lane].fetch_add(1);
+
+    Wake(false);
+  }
+
+  void TaskExecutor::PostAfter(TaskPriority priority, std::chrono::milliseconds delay, std::function<void()> function)
+  {
+    if (m_Stopping.load()) {
+      AF_WARN("TaskExecutor: task posted after shutdown was dropped");
+      return;
+    }
+
+    Task task;
+    task.function = std::move(function);
+    task.priority = priority;
+    {
+      std::lock_guard<std::mutex> lock(m_TimerMutex);
+      m_Timers.emplace(std::chrono::steady_clock::now() + delay, std::move(task));
+    }
+    m_TimerCondition.notify_one();
+  }
+
+  bool TaskExecutor::IsWorkerThread() const
+  {
+    return t_Executor == this && t_WorkerIndex != NoWorker;
+  }
+
+  TaskExecutor::Stats TaskExecutor::GetStats() const
+  {
+    Stats stats;
+    stats.workerCount = m_Workers.size();
+    stats.steals = m_Steals.load();
+
+    std::lock_guard<std::mutex> lock(m_StatsMutex);
+    for (size_t lane = 0; lane < LaneCount; ++lane) {
+      LaneStats& out = lane == 0 ? stats.interactive : stats.batch;
+      const LaneCounters& counters = m_Counters[lane];
+
+      out.queued = m_Queued[lane].load();
+      out.running = m_Running[lane].load();
+      out.completed = counters.completed;
+      out.maxWaitMs = counters.maxWaitMs;
+      if (counters.completed > 0) {
+        out.averageWaitMs = counters.totalWaitMs / counters.completed;
+        out.averageRunMs = counters.totalRunMs / counters.completed;
+      }
+    }
+    return stats;
+  }
+
+  void TaskExecutor::Shutdown()
+  {
+    if (m_Stopping.exchange(true)) {
+      return;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(m_TimerMutex);
+      m_TimerCondition.notify_all();
+    }
+    if (m_TimerThread.joinable()) {
+      m_TimerThread.join();
+    }
+    Wake(true);
+    for (auto& worker : m_Workers) {
+      if (worker->thread.joinable()) {
+        worker->thread.join();
+      }
+    }
+
+    // Dropping queued tasks breaks their promises, so anyone waiting on a future is released.
+    size_t dropped = m_Timers.size();
+    m_Timers.clear();
+    for (auto& worker : m_Workers) {
+      for (auto& lane : worker->lanes) {
+        dropped += lane.size();
+        lane.clear();
+      }
+    }
+    for (auto& lane : m_Injected) {
+      dropped += lane.size();
+      lane.clear();
+    }
+
+    auto stats = GetStats();
+    AF_INFO("TaskExecutor stopped: interactive {} tasks (avg wait {:.1f}ms, max {:.1f}ms, avg run {:.1f}ms), "
+            "batch {} tasks (avg wait {:.1f}ms, max {:.1f}ms, avg run {:.1f}ms), {} steals, {} dropped",
+            stats.interactive.completed,
+            stats.interactive.averageWaitMs,
+            stats.interactive.maxWaitMs,
+            stats.interactive.averageRunMs,
+            stats.batch.completed,
+            stats.batch.averageWaitMs,
+            stats.batch.maxWaitMs,
+            stats.batch.averageRunMs,
+            stats.steals,
+            dropped);
+  }
+
+  void TaskExecutor::WorkerLoop(size_t index)
+  {
+    t_Executor = this;
+    t_WorkerIndex = index;
+    Trace::SetThreadName("Worker " + std::to_string(index));
+
+    while (!m_Stopping.load()) {
+      Task task;
+      if (TryTakeTask(index, task)) {
+        Execute(task);
+        continue;
+      }
+
+      std::unique_lock<std::mutex> lock(m_SleepMutex);
+      m_WakeCondition.wait_for(lock, std::chrono::milliseconds(100), [this]() {
+        return m_Stopping.load() || HasRunnableWork();
+      });
+    }
+  }
+
+  void TaskExecutor::TimerLoop()
+  {
+    Trace::SetThreadName("Task timer");
+
+    std::unique_lock<std::mutex> lock(m_TimerMutex);
+    while (!m_Stopping.load()) {
+      if (m_Timers.empty()) {
+        m_TimerCondition.wait(lock, [this]() { return m_Stopping.load() || !m_Timers.empty(); });
+        continue;
+      }
+
+      auto due = m_Timers.begin()->first;
+      if (std::chrono::steady_clock::now() < due) {
+        // Woken early by an earlier task or by shutdown; the loop looks again either way.
+        m_TimerCondition.wait_until(lock, due);
+        continue;
+      }
+
+      Task task = std::move(m_Timers.begin()->second);
+      m_Timers.erase(m_Timers.begin());
+      lock.unlock();
+      Post(task.priority, std::move(task.function));
+      lock.lock();
+    }
+  }
+
+  bool TaskExecutor::HasRunnableWork() const
+  {
+    size_t interactive = static_cast<size_t>(TaskPriority::Interactive);
+    size_t batch = static_cast<size_t>(TaskPriority::Batch);
+    return m_Queued[interactive].load() > 0 ||
+           (m_Queued[batch].load() > 0 && m_Running[batch].load() < m_MaxBatchRunning);
+  }
+
+  bool TaskExecutor::TryTakeTask(size_t self, Task& task)
+  {
+    size_t interactive = static_cast<size_t>(TaskPriority::Interactive);
+    if (m_Queued[interactive].load() > 0 && TryTakeFromLane(self, interactive, task)) {
+      m_Running[interactive].fetch_add(1);
+      return true;
+    }
+
+    size_t batch = static_cast<size_t>(TaskPriority::Batch);
+    if (m_Queued[batch].load() == 0) {
+      return false;
+    }
+
+    // Reserve a batch slot before taking the task so concurrent workers cannot overshoot the limit.
+    size_t running = m_Running[batch].load();
+    do {
+      if (running >= m_MaxBatchRunning) {
+        return false;
+      }
+    } while (!m_Running[batch].compare_exchange_weak(running, running + 1));
+
+    if (TryTakeFromLane(self, batch, task)) {
+      return true;
+    }
+    m_Running[batch].fetch_sub(1);
+    return false;
+  }
+
+  bool TaskExecutor::TryTakeFromLane(size_t self, size_t lane, Task& task)
+  {
+    if (self != NoWorker) {
+      auto& worker = *m_Workers[self];
+      std::lock_guard<std::mutex> lock(worker.mutex);
+      if (!worker.lanes[lane].empty()) {
+        task = std::move(worker.lanes[lane].back());
+        worker.lanes[lane].pop_back();
+        m_Queued[lane].fetch_sub(1);
+        return true;
+      }
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(m_InjectMutex);
+      if (!m_Injected[lane].empty()) {
+        task = std::move(m_Injected[lane].front());
+        m_Injected[lane].pop_front();
+        m_Queued[lane].fetch_sub(1);
+        return true;
+      }
+    }
+
+    size_t count = m_Workers.size();
+    size_t start = self == NoWorker ? 0 : self + 1;
+    for (size_t offset = 0; offset < count; ++offset) {
+      size_t victim = (start + offset) % count;
+      if (victim == self) {
+        continue;
+      }
+
+      auto& worker = *m_Workers[victim];
+      std::lock_guard<std::mutex> lock(worker.mutex);
+      if (!worker.lanes[lane].empty()) {
+        task = std::move(worker.lanes[lane].front());
+        worker.lanes[lane].pop_front();
+        m_Queued[lane].fetch_sub(1);
+        m_Steals.fetch_add(1);
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  void TaskExecutor::Execute(Task& task)
+  {
+    size_t lane = static_cast<size_t>(task.priority);
+    auto start = std::chrono::steady_clock::now();
+
+    try {
+      task.function();
+    } catch (const std::exception& e) {
+      AF_ERROR("TaskExecutor: task threw exception: {}", e.what());
+    } catch (...) {
+      AF_ERROR("TaskExecutor: task threw unknown exception");
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    m_Running[lane].fetch_sub(1);
+
+    {
+      std::lock_guard<std::mutex> lock(m_StatsMutex);
+      auto& counters = m_Counters[lane];
+      double waitMs = std::chrono::duration<double, std::milli>(start - task.enqueued).count();
+      counters.completed++;
+      counters.totalWaitMs += waitMs;
+      counters.maxWaitMs = std::max(counters.maxWaitMs, waitMs);
+      counters.totalRunMs += std::chrono::duration<double, std::milli>(end - start).count();
+    }
+
+    // A finished batch task frees a slot that a sleeping worker may be waiting for.
+    if (task.priority == TaskPriority::Batch && m_Queued[lane].load() > 0) {
+      Wake(false);
+    }
+  }
+
+  void TaskExecutor::Wake(bool all)
+  {
+    std::lock_guard<std::mutex> lock(m_SleepMutex);
+    if (all) {
+      m_WakeCondition.notify_all();
+    } else {
+      m_WakeCondition.notify_one();
+    }
+  }
+
+  TaskGroup::TaskGroup(TaskPriority priority, TaskExecutor& executor)
+      : m_Executor(executor)
+      , m_Priority(priority)
+  {}
+
+  void TaskGroup::Post(std::function<void()> task)
+  {
+    auto entry = std::make_shared<Entry>();
+    entry->function = std::move(task);
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      m_Pending.push_back(entry);
+    }
+
+    // Whoever claims the entry first runs it; the other side finds it claimed and skips it.
+    m_Executor.Post(m_Priority, [entry]() {
+      if (!entry->claimed.exchange(true)) {
+        Run(*entry);
+      }
+    });
+  }
+
+  bool TaskGroup::RunPendingTask()
+  {
+    std::shared_ptr<Entry> entry;
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      while (!m_Pending.empty() && !entry) {
+        if (!m_Pending.front()->claimed.exchange(true)) {
+          entry = m_Pending.front();
+        }
+        m_Pending.pop_front();
+      }
+    }
+    if (!entry) {
+      return false;
+    }
+    Run(*entry);
+    return true;
+  }
+
+  void TaskGroup::Run(Entry& entry)
+  {
+    try {
+      entry.function();
+    } catch (const std::exception& e) {
+      AF_ERROR("TaskGroup: task threw exception: {}", e.what());
+    } catch (...) {
+      AF_ERROR("TaskGroup: task threw unknown exception");
+    }
+    entry.function = nullptr;
+  }
+
+} // namespace Image2Card::Core
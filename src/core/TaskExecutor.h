@@ -0,0 +1,240 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace Image2Card::Core
+{
+
+  enum class TaskPriority
+  {
+    Interactive = 0, // Work the user is waiting on (scans, processing, UI-triggered requests)
+    Batch = 1        // Throughput work that must never starve the interactive lane
+  };
+
+  /**
+ * Process-wide work-stealing thread pool.
+ * Each worker owns a deque per priority lane; tasks posted from a worker go to
+ * its own deque (LIFO for locality), tasks from other threads go to a shared
+ * injection queue, and idle workers steal from the front of other deques.
+ * Interactive tasks are always taken before batch tasks, and batch tasks may
+ * occupy at most all-but-one worker so an interactive task can always start.
+ */
+  class TaskExecutor
+  {
+public:
+
+    struct LaneStats
+    {
+      size_t queued = 0;
+      size_t running = 0;
+      uint64_t completed = 0;
+      double averageWaitMs = 0.0;
+      double maxWaitMs = 0.0;
+      double averageRunMs = 0.0;
+    };
+
+    struct Stats
+    {
+      size_t workerCount = 0;
+      uint64_t steals = 0;
+      LaneStats interactive;
+      LaneStats batch;
+    };
+
+    /**
+   * The shared executor used by the whole application.
+   */
+    static TaskExecutor& Get();
+
+    /**
+   * @param workerCount Number of worker threads; 0 picks a default based on hardware concurrency
+   */
+    explicit TaskExecutor(size_t workerCount = 0);
+    ~TaskExecutor();
+
+    TaskExecutor(const TaskExecutor&) = delete;
+    TaskExecutor& operator=(const TaskExecutor&) = delete;
+
+    /**
+   * Queue fire-and-forget work. Exceptions are logged and swallowed.
+   */
+    void Post(TaskPriority priority, std::function<void()> task);
+
+    /**
+   * Queue fire-and-forget work once the delay has passed. No worker is occupied
+   * meanwhile; a single timer thread posts the task when it is due. Tasks still
+   * waiting at shutdown are dropped.
+   */
+    void PostAfter(TaskPriority priority, std::chrono::milliseconds delay, std::function<void()> task);
+
+    /**
+   * Queue work and get a future for its result (exceptions propagate through the future).
+   */
+    template <typename Function>
+    auto Submit(TaskPriority priority, Function&& function) -> std::future<std::invoke_result_t<std::decay_t<Function>>>
+    {
+      using Result = std::invoke_result_t<std::decay_t<Function>>;
+      auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Function>(function));
+      auto future = task->get_future();
+      Post(priority, [task]() { (*task)(); });
+      return future;
+    }
+
+    /**
+   * @return true if the calling thread is one of this executor's workers
+   */
+    [[nodiscard]] bool IsWorkerThread() const;
+
+    [[nodiscard]] size_t GetWorkerCount() const { return m_Workers.size(); }
+
+    /**
+   * Snapshot of queue depth and task latency per lane.
+   */
+    [[nodiscard]] Stats GetStats() const;
+
+    /**
+   * Stop accepting work, drop queued tasks and join the workers.
+   * Running tasks are allowed to finish.
+   */
+    void Shutdown();
+
+private:
+
+    static constexpr size_t LaneCount = 2;
+
+    struct Task
+    {
+      std::function<void()> function;
+      TaskPriority priority = TaskPriority::Interactive;
+      std::chrono::steady_clock::time_point enqueued;
+    };
+
+    struct Worker
+    {
+      std::mutex mutex;
+      std::array<std::deque<Task>, LaneCount> lanes;
+      std::thread thread;
+    };
+
+    struct LaneCounters
+    {
+      uint64_t completed = 0;
+      double totalWaitMs = 0.0;
+      double maxWaitMs = 0.0;
+      double totalRunMs = 0.0;
+    };
+
+    void WorkerLoop(size_t index);
+    void TimerLoop();
+    bool TryTakeTask(size_t self, Task& task);
+    bool TryTakeFromLane(size_t self, size_t lane, Task& task);
+    bool HasRunnableWork() const;
+    void Execute(Task& task);
+    void Wake(bool all);
+
+    std::vector<std::unique_ptr<Worker>> m_Workers;
+
+    std::mutex m_InjectMutex;
+    std::array<std::deque<Task>, LaneCount> m_Injected;
+
+    std::mutex m_SleepMutex;
+    std::condition_variable m_WakeCondition;
+
+    std::array<std::atomic<size_t>, LaneCount> m_Queued{};
+    std::array<std::atomic<size_t>, LaneCount> m_Running{};
+    size_t m_MaxBatchRunning;
+    std::atomic<uint64_t> m_Steals{0};
+    std::atomic<bool> m_Stopping{false};
+
+    mutable std::mutex m_StatsMutex;
+    std::array<LaneCounters, LaneCount> m_Counters;
+
+    std::mutex m_TimerMutex;
+    std::condition_variable m_TimerCondition;
+    std::multimap<std::chrono::steady_clock::time_point, Task> m_Timers; // Delayed tasks by due time
+    std::thread m_TimerThread;
+  };
+
+  /**
+ * Tasks a caller posts and later waits for. Each task is queued on the executor
+ * as usual, but the waiting thread may also run a task of its own group that no
+ * worker has started yet. A waiter never runs anyone else's work, so an
+ * interactive wait cannot get stuck behind unrelated batch work, and a worker
+ * blocked on its own tasks cannot starve the pool of them.
+ */
+  class TaskGroup
+  {
+public:
+
+    explicit TaskGroup(TaskPriority priority, TaskExecutor& executor = TaskExecutor::Get());
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    /**
+   * Queue fire-and-forget work. Exceptions are logged and swallowed.
+   */
+    void Post(std::function<void()> task);
+
+    /**
+   * Queue work and get a future for its result (exceptions propagate through the future).
+   */
+    template <typename Function>
+    auto Submit(Function&& function) -> std::future<std::invoke_result_t<std::decay_t<Function>>>
+    {
+      using Result = std::invoke_result_t<std::decay_t<Function>>;
+      auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Function>(function));
+      auto future = task->get_future();
+      Post([task]() { (*task)(); });
+      return future;
+    }
+
+    /**
+   * Run one task of this group that has not started yet on the calling thread.
+   * @return false if every task of the group has started already
+   */
+    bool RunPendingTask();
+
+    /**
+   * Wait for a future of this group, running the group's unstarted tasks meanwhile.
+   */
+    template <typename Result>
+    void Wait(std::future<Result>& future)
+    {
+      while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        if (!RunPendingTask()) {
+          future.wait();
+        }
+      }
+    }
+
+private:
+
+    struct Entry
+    {
+      std::function<void()> function;
+      std::atomic<bool> claimed{false};
+    };
+
+    static void Run(Entry& entry); // Runs a claimed entry
+
+    TaskExecutor& m_Executor;
+    TaskPriority m_Priority;
+    std::mutex m_Mutex;
+    std::deque<std::shared_ptr<Entry>> m_Pending; // Oldest first; started entries are dropped lazily
+  };
+
+} // namespace Image2Card::Core
@@ -0,0 +1,126 @@
+#include "core/Trace.h"
+
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <vector>
+
+#include "core/Logger.h"
+
+namespace Image2Card::Core
+{
+
+  std::atomic<bool> Trace::s_Enabled{false};
+
+  namespace
+  {
+    struct Event
+    {
+      std::string category;
+      std::string name;
+      uint32_t threadId;
+      Trace::Clock::time_point begin;
+      Trace::Clock::time_point end;
+    };
+
+    struct TraceState
+    {
+      std::mutex mutex;
+      std::string outputPath;
+      Trace::Clock::time_point origin;
+      std::vector<Event> events;
+      std::map<uint32_t, std::string> threadNames;
+    };
+
+    TraceState& State()
+    {
+      static TraceState state;
+      return state;
+    }
+
+    // Small sequential ids read better in the viewer than hashed std::thread::ids.
+    uint32_t CurrentThreadId()
+    {
+      static std::atomic<uint32_t> nextId{1};
+      thread_local uint32_t id = nextId.fetch_add(1);
+      return id;
+    }
+
+    double Microseconds(Trace::Clock::duration duration)
+    {
+      return std::chrono::duration<double, std::micro>(duration).count();
+    }
+  } // namespace
+
+  void Trace::Start(std::string outputPath)
+  {
+    auto& state = State();
+    {
+      std::lock_guard<std::mutex> lock(state.mutex);
+      state.outputPath = std::move(outputPath);
+      state.origin = Clock::now();
+      state.events.clear();
+      state.events.reserve(4096);
+    }
+    s_Enabled.store(true);
+    AF_INFO("Tracing enabled, writing to {}", state.outputPath);
+  }
+
+  bool Trace::Stop()
+  {
+    if (!s_Enabled.exchange(false)) {
+      return false;
+    }
+
+    auto& state = State();
+    std::lock_guard<std::mutex> lock(state.mutex);
+
+    nlohmann::json events = nlohmann::json::array();
+    for (const auto& [threadId, name] : state.threadNames) {
+      events.push_back(
+          {{"name", "thread_name"}, {"ph", "M"}, {"pid", 1}, {"tid", threadId}, {"args", {{"name", name}}}});
+    }
+    for (const auto& event : state.events) {
+      events.push_back({{"name", event.name},
+                        {"cat", event.category},
+                        {"ph", "X"},
+                        {"ts", Microseconds(event.begin - state.origin)},
+                        {"dur", Microseconds(event.end - event.begin)},
+                        {"pid", 1},
+                        {"tid", event.threadId}});
+    }
+
+    std::ofstream file(state.outputPath, std::ios::binary | std::ios::trunc);
+    if (!file) {
+      AF_ERROR("Failed to open trace file: {}", state.outputPath);
+      return false;
+    }
+    file << nlohmann::json{{"traceEvents", events}, {"displayTimeUnit", "ms"}}.dump();
+
+    AF_INFO("Wrote {} trace events to {}", state.events.size(), state.outputPath);
+    state.events.clear();
+    return true;
+  }
+
+  void Trace::Record(std::string_view category, std::string_view name, Clock::time_point begin, Clock::time_point end)
+  {
+    if (!IsEnabled()) {
+      return;
+    }
+
+    Event event{std::string(category), std::string(name), CurrentThreadId(), begin, end};
+    auto& state = State();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.events.push_back(std::move(event));
+  }
+
+  void Trace::SetThreadName(std::string name)
+  {
+    auto& state = State();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.threadNames[CurrentThreadId()] = std::move(name);
+  }
+
+} // namespace Image2Card::Core
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <string_view>
+
+namespace Image2Card::Core
+{
+
+  /**
+ * Collects timed spans and writes them in the Chrome trace event format, which
+ * chrome://tracing and Perfetto (ui.perfetto.dev) can open.
+ * Recording is off until Start is called; while off a span costs one relaxed
+ * atomic load, so spans can stay in hot paths.
+ */
+  class Trace
+  {
+public:
+
+    using Clock = std::chrono::steady_clock;
+
+    /**
+   * Start recording spans. Spans already recorded are discarded.
+   * @param outputPath File Stop writes the trace to
+   */
+    static void Start(std::string outputPath);
+
+    /**
+   * Stop recording and write everything recorded since Start to the output file.
+   * Does nothing if recording was not started.
+   * @return true if the file was written
+   */
+    static bool Stop();
+
+    [[nodiscard]] static bool IsEnabled() { return s_Enabled.load(std::memory_order_relaxed); }
+
+    /**
+   * Record a finished span on the calling thread.
+   * @param category Group shown in the viewer (e.g. "ocr", "tts", "anki")
+   * @param name Span name
+   * @param begin When the span started
+   * @param end When the span ended
+   */
+    static void
+    Record(std::string_view category, std::string_view name, Clock::time_point begin, Clock::time_point end);
+
+    /**
+   * Name the calling thread in the trace viewer. Safe to call while recording is off.
+   */
+    static void SetThreadName(std::string name);
+
+private:
+
+    static std::atomic<bool> s_Enabled;
+  };
+
+  /**
+ * Records a span from construction to destruction when tracing is enabled.
+ * category and name are not copied unless a span is recorded, so they must
+ * outlive the scope (string literals or strings owned by the caller).
+ */
+  class TraceScope
+  {
+public:
+
+    TraceScope(std::string_view category, std::string_view name)
+    {
+      if (Trace::IsEnabled()) {
+        m_Category = category;
+        m_Name = name;
+        m_Begin = Trace::Clock::now();
+        m_Active = true;
+      }
+    }
+
+    ~TraceScope()
+    {
+      if (m_Active) {
+        Trace::Record(m_Category, m_Name, m_Begin, Trace::Clock::now());
+      }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+
+    std::string_view m_Category;
+    std::string_view m_Name;
+    Trace::Clock::time_point m_Begin;
+    bool m_Active = false;
+  };
+
+} // namespace Image2Card::Core
+
+#define AF_TRACE_CONCAT_INTERNAL(a, b) a##b
+#define AF_TRACE_CONCAT(a, b) AF_TRACE_CONCAT_INTERNAL(a, b)
+
+#define AF_TRACE_SCOPE(category, name)                                                                                 \
+  Image2Card::Core::TraceScope AF_TRACE_CONCAT(afTraceScope, __LINE__)(category, name)
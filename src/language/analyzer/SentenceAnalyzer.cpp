@@ -30,10 +30,19 @@ namespace Image2Card::Language::Analyzer
 
   void SentenceAnalyzer::SetPreferredTranslator(const std::string& translatorId)
   {
-    m_PreferredTranslatorId = translatorId;
+    {
+      std::lock_guard<std::mutex> lock(m_TranslatorMutex);
+      m_PreferredTranslatorId = translatorId;
+    }
     AF_INFO("SentenceAnalyzer: Preferred translator set to '{}'", translatorId);
   }
 
+  std::string SentenceAnalyzer::GetPreferredTranslator() const
+  {
+    std::lock_guard<std::mutex> lock(m_TranslatorMutex);
+    return m_PreferredTranslatorId;
+  }
+
   bool SentenceAnalyzer::Initialize(const std::string& basePath)
   {
     try {
@@ -75,7 +84,8 @@ namespace Image2Card::Language::Analyzer
 
   nlohmann::json SentenceAnalyzer::AnalyzeSentence(const std::string& sentence,
                                                    const std::string& targetWord,
-                                                   const ILanguage* language)
+                                                   const ILanguage* language,
+                                                   const Core::CancellationToken& cancellation)
   {
     (void) language; // Not currently used
 
@@ -92,27 +102,57 @@ namespace Image2Card::Language::Analyzer
     }
 
     try {
-      // Determine the target word
-      std::string focusWord = targetWord.empty() ? SelectTargetWord(sentence) : targetWord;
+      TargetWord target = ResolveTargetWord(sentence, targetWord);
+      result = AnalyzeTargetWord(sentence, GenerateSentenceFurigana(sentence), target);
+      if (!result.contains("error")) {
+        result["translation"] = TranslateSentence(sentence, cancellation);
+        AF_DEBUG("Analysis complete for sentence: {}", sentence);
+      }
+      return result;
 
-      if (focusWord.empty()) {
-        AF_WARN("Could not determine target word for sentence: {}", sentence);
-        focusWord = "詞"; // Fallback
+    } catch (const std::exception& e) {
+      AF_ERROR("Failed to analyze sentence: {}", e.what());
+      result["error"] = std::string("Analysis failed: ") + e.what();
+      return result;
+    }
+  }
+
+  std::string SentenceAnalyzer::GenerateSentenceFurigana(const std::string& sentence)
+  {
+    if (m_FuriganaGen) {
+      try {
+        return m_FuriganaGen->Generate(sentence);
+      } catch (const std::exception& e) {
+        AF_WARN("Failed to generate furigana: {}", e.what());
       }
+    }
+    return sentence;
+  }
 
-      // Generate furigana for the sentence
-      std::string sentenceWithFurigana = sentence;
-      if (m_FuriganaGen) {
-        try {
-          sentenceWithFurigana = m_FuriganaGen->Generate(sentence);
-        } catch (const std::exception& e) {
-          AF_WARN("Failed to generate furigana: {}", e.what());
-        }
+  std::string SentenceAnalyzer::TranslateSentence(const std::string& sentence,
+                                                  const Core::CancellationToken& cancellation)
+  {
+    auto translator = GetTranslator();
+    if (translator) {
+      try {
+        return translator->Translate(sentence, cancellation);
+      } catch (const std::exception& e) {
+        AF_WARN("Translation failed: {}", e.what());
       }
+    }
+    return "";
+  }
+
+  nlohmann::json SentenceAnalyzer::AnalyzeTargetWord(const std::string& sentence,
+                                                     const std::string& sentenceFurigana,
+                                                     const TargetWord& target)
+  {
+    nlohmann::json result;
 
-      // Get the dictionary form and reading of the target word
-      std::string dictionaryForm = GetDictionaryForm(focusWord);
-      std::string reading = GetReading(focusWord);
+    try {
+      const std::string& focusWord = target.surface;
+      const std::string& dictionaryForm = target.dictionaryForm;
+      const std::string& reading = target.reading;
 
       // Generate furigana for the target word (use dictionary form if available)
       std::string targetWordFurigana;
@@ -139,17 +179,6 @@ namespace Image2Card::Language::Analyzer
         }
       }
 
-      // Translate the sentence using language services
-      std::string translation;
-      auto translator = GetTranslator();
-      if (translator) {
-        try {
-          translation = translator->Translate(sentence);
-        } catch (const std::exception& e) {
-          AF_WARN("Translation failed: {}", e.what());
-        }
-      }
-
       // Look up pitch accent
       std::string pitchAccent;
       if (m_PitchAccent) {
@@ -175,7 +204,7 @@ namespace Image2Card::Language::Analyzer
       // Highlight target word in furigana
       // Strategy: Replace the focusWord in the plain sentence with a marker,
       // then use the same marker position logic in the furigana string
-      std::string highlightedFurigana = sentenceWithFurigana;
+      std::string highlightedFurigana = sentenceFurigana;
 
       size_t furiganaPos = highlightedFurigana.find(focusWord);
       if (furiganaPos != std::string::npos) {
@@ -283,26 +312,39 @@ namespace Image2Card::Language::Analyzer
         }
       }
 
-      // Build the result JSON
       result["sentence"] = highlightedSentence;
-      result["translation"] = translation;
       result["target_word"] = dictionaryForm.empty() ? focusWord : dictionaryForm;
       result["target_word_furigana"] = targetWordFurigana;
       result["furigana"] = highlightedFurigana;
       result["definition"] = definition;
       result["pitch_accent"] = pitchAccent;
-
-      AF_DEBUG("Analysis complete for sentence: {}", sentence);
-
       return result;
 
     } catch (const std::exception& e) {
-      AF_ERROR("Failed to analyze sentence: {}", e.what());
+      AF_ERROR("Failed to analyze target word: {}", e.what());
       result["error"] = std::string("Analysis failed: ") + e.what();
       return result;
     }
   }
 
+  SentenceAnalyzer::TargetWord SentenceAnalyzer::ResolveTargetWord(const std::string& sentence,
+                                                                   const std::string& targetWord)
+  {
+    TargetWord target;
+    target.surface = targetWord.empty() ? SelectTargetWord(sentence) : targetWord;
+
+    if (target.surface.empty()) {
+      AF_WARN("Could not determine target word for sentence: {}", sentence);
+      target.surface = "詞"; // Fallback
+    }
+
+    // Get the dictionary form and reading of the target word
+    target.dictionaryForm = GetDictionaryForm(target.surface);
+    target.reading = GetReading(target.surface);
+
+    return target;
+  }
+
   bool SentenceAnalyzer::IsReady() const
   {
     return m_MorphAnalyzer && m_FuriganaGen;
@@ -315,23 +357,24 @@ namespace Image2Card::Language::Analyzer
       return nullptr;
     }
 
-    AF_DEBUG("GetTranslator: Preferred translator ID = '{}'", m_PreferredTranslatorId);
+    std::string preferredId = GetPreferredTranslator();
+    AF_DEBUG("GetTranslator: Preferred translator ID = '{}'", preferredId);
 
-    if (!m_PreferredTranslatorId.empty()) {
+    if (!preferredId.empty()) {
       for (const auto& service : *m_LanguageServices) {
         if (service->GetType() == "translator") {
           AF_DEBUG("GetTranslator: Checking translator '{}' (id: {}, available: {})",
                    service->GetName(),
                    service->GetId(),
                    service->IsAvailable());
-          if (service->GetId() == m_PreferredTranslatorId && service->IsAvailable()) {
+          if (service->GetId() == preferredId && service->IsAvailable()) {
             AF_INFO("GetTranslator: Using preferred '{}' translator", service->GetId());
             return service->GetTranslator();
           }
         }
       }
       AF_WARN("GetTranslator: Preferred translator '{}' not found or not available, falling back to first available",
-              m_PreferredTranslatorId);
+              preferredId);
     }
 
     for (const auto& service : *m_LanguageServices) {
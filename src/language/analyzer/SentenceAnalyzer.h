@@ -1,10 +1,13 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
 #include <nlohmann/json.hpp>
 #include <string>
 #include <vector>
 
+#include "core/CancellationToken.h"
+
 namespace Image2Card::Language
 {
   class ILanguage;
@@ -52,6 +55,22 @@ namespace Image2Card::Language::Analyzer
   {
 public:
 
+    /**
+   * The word a card focuses on, as it appears in the sentence and in dictionary form.
+   */
+    struct TargetWord
+    {
+      std::string surface;
+      std::string dictionaryForm;
+      std::string reading;
+
+      /**
+     * The form used for the vocab field, lookups and vocab audio.
+     * @return Dictionary form if known, otherwise the surface form
+     */
+      [[nodiscard]] const std::string& Headword() const { return dictionaryForm.empty() ? surface : dictionaryForm; }
+    };
+
     SentenceAnalyzer();
     ~SentenceAnalyzer() = default;
 
@@ -67,6 +86,11 @@ public:
    */
     void SetPreferredTranslator(const std::string& translatorId);
 
+    /**
+   * @return The preferred translator ID; safe to call while the UI thread changes it
+   */
+    [[nodiscard]] std::string GetPreferredTranslator() const;
+
     /**
    * Initialize the analyzer with MeCab and other components.
    * @param basePath Base path for assets (database, etc.)
@@ -79,10 +103,49 @@ public:
    * @param sentence The sentence to analyze
    * @param targetWord Optional target word to focus on
    * @param language The language configuration (unused for now)
+   * @param cancellation Aborts the translation request when cancelled or past its deadline
    * @return JSON with analysis results
+   */
+    [[nodiscard]] nlohmann::json AnalyzeSentence(const std::string& sentence,
+                                                 const std::string& targetWord,
+                                                 const ILanguage* language = nullptr,
+                                                 const Core::CancellationToken& cancellation = {});
+
+    /**
+   * Generate furigana for a whole sentence. Independent of the target word.
+   * @param sentence The sentence to annotate
+   * @return Sentence with furigana, or the sentence itself if generation failed
+   */
+    [[nodiscard]] std::string GenerateSentenceFurigana(const std::string& sentence);
+
+    /**
+   * Translate a sentence with the preferred translator. Independent of the target word.
+   * @param sentence The sentence to translate
+   * @param cancellation Aborts the translation request when cancelled or past its deadline
+   * @return Translation, empty if no translator is available or the request failed
+   */
+    [[nodiscard]] std::string TranslateSentence(const std::string& sentence,
+                                                const Core::CancellationToken& cancellation = {});
+
+    /**
+   * The target word dependent part of AnalyzeSentence: definition, pitch accent,
+   * target word furigana and highlighting of the word in the sentence.
+   * @param sentence The sentence to analyze
+   * @param sentenceFurigana Result of GenerateSentenceFurigana for the sentence
+   * @param target Result of ResolveTargetWord for the sentence
+   * @return JSON with every field of AnalyzeSentence except translation
    */
     [[nodiscard]] nlohmann::json
-    AnalyzeSentence(const std::string& sentence, const std::string& targetWord, const ILanguage* language = nullptr);
+    AnalyzeTargetWord(const std::string& sentence, const std::string& sentenceFurigana, const TargetWord& target);
+
+    /**
+   * Determine the target word of a sentence without running the full analysis.
+   * Only uses MeCab, so it is cheap enough to gate other work (e.g. vocab audio) on.
+   * @param sentence The sentence to analyze
+   * @param targetWord Optional target word chosen by the user
+   * @return Surface, dictionary form and reading of the target word
+   */
+    [[nodiscard]] TargetWord ResolveTargetWord(const std::string& sentence, const std::string& targetWord);
 
     /**
    * Check if the analyzer is ready to use.
@@ -124,6 +187,7 @@ private:
     std::shared_ptr<Furigana::IFuriganaGenerator> m_FuriganaGen;
     std::shared_ptr<Dictionary::IDictionaryClient> m_DictClient;
     std::shared_ptr<PitchAccent::IPitchAccentLookup> m_PitchAccent;
+    mutable std::mutex m_TranslatorMutex; // Guards m_PreferredTranslatorId, set from the UI thread
     std::string m_PreferredTranslatorId;
   };
 
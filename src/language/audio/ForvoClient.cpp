@@ -9,6 +9,7 @@
 #include <thread>
 
 #include "core/Logger.h"
+#include "core/Trace.h"
 #include "utils/Base64Utils.h"
 
 namespace Image2Card::Language::Audio
@@ -24,9 +25,12 @@ namespace Image2Card::Language::Audio
     AF_INFO("ForvoClient initialized for language: {} (format: {})", m_Language, m_AudioFormat);
   }
 
-  std::vector<AudioFileInfo>
-  ForvoClient::SearchAudio(const std::string& word, const std::string& headword, const std::string& reading)
+  std::vector<AudioFileInfo> ForvoClient::SearchAudio(const std::string& word,
+                                                      const std::string& headword,
+                                                      const std::string& reading,
+                                                      const Core::CancellationToken& cancellation)
   {
+    AF_TRACE_SCOPE("forvo", "Forvo search");
     (void) reading; // Reading not used by Forvo
 
     std::string searchWord = word.empty() ? headword : word;
@@ -37,11 +41,11 @@ namespace Image2Card::Language::Audio
 
     try {
       AF_DEBUG("Searching Forvo for: {}", searchWord);
-      std::string html = FetchWordPage(searchWord);
+      std::string html = FetchWordPage(searchWord, cancellation);
 
-      if (html.empty()) {
+      if (html.empty() && !cancellation.IsCancelled()) {
         AF_DEBUG("ForvoClient: word page empty, trying search page for '{}'", searchWord);
-        html = FetchSearchPage(searchWord);
+        html = FetchSearchPage(searchWord, cancellation);
       }
 
       if (html.empty()) {
@@ -98,11 +102,16 @@ namespace Image2Card::Language::Audio
     }
   }
 
-  std::string ForvoClient::FetchWordPage(const std::string& word) const
+  std::string ForvoClient::FetchWordPage(const std::string& word, const Core::CancellationToken& cancellation) const
   {
+    AF_TRACE_SCOPE("forvo", "Forvo word page");
     const int maxRetries = 3;
 
     for (int attempt = 0; attempt < maxRetries; ++attempt) {
+      if (cancellation.IsCancelled()) {
+        return "";
+      }
+
       try {
         if (attempt > 0) {
           int backoffMs = 500 * (1 << (attempt - 1));
@@ -111,8 +120,8 @@ namespace Image2Card::Language::Audio
         }
 
         httplib::SSLClient cli("forvo.com");
-        cli.set_connection_timeout(m_TimeoutSeconds, 0);
-        cli.set_read_timeout(m_TimeoutSeconds, 0);
+        cli.set_connection_timeout(cancellation.ClampTimeout(std::chrono::seconds(m_TimeoutSeconds)));
+        cli.set_read_timeout(cancellation.ClampTimeout(std::chrono::seconds(m_TimeoutSeconds)));
         cli.set_follow_location(true);
 
         httplib::Headers headers = {
@@ -132,8 +141,14 @@ namespace Image2Card::Language::Audio
           path += "#" + m_Language;
         }
 
+        Core::ScopedCancellationCallback stopOnCancel(cancellation, [&cli]() { cli.stop(); });
         auto res = cli.Get(path.c_str(), headers);
 
+        if (!res && cancellation.IsCancelled()) {
+          AF_INFO("ForvoClient: request cancelled");
+          return "";
+        }
+
         if (!res) {
           AF_WARN("ForvoClient: HTTP request failed for word '{}'", word);
           if (attempt < maxRetries - 1)
@@ -164,11 +179,16 @@ namespace Image2Card::Language::Audio
     return "";
   }
 
-  std::string ForvoClient::FetchSearchPage(const std::string& word) const
+  std::string ForvoClient::FetchSearchPage(const std::string& word, const Core::CancellationToken& cancellation) const
   {
+    AF_TRACE_SCOPE("forvo", "Forvo search page");
     const int maxRetries = 3;
 
     for (int attempt = 0; attempt < maxRetries; ++attempt) {
+      if (cancellation.IsCancelled()) {
+        return "";
+      }
+
       try {
         if (attempt > 0) {
           int backoffMs = 500 * (1 << (attempt - 1));
@@ -177,8 +197,8 @@ namespace Image2Card::Language::Audio
         }
 
         httplib::SSLClient cli("forvo.com");
-        cli.set_connection_timeout(m_TimeoutSeconds, 0);
-        cli.set_read_timeout(m_TimeoutSeconds, 0);
+        cli.set_connection_timeout(cancellation.ClampTimeout(std::chrono::seconds(m_TimeoutSeconds)));
+        cli.set_read_timeout(cancellation.ClampTimeout(std::chrono::seconds(m_TimeoutSeconds)));
         cli.set_follow_location(true);
 
         httplib::Headers headers = {
@@ -195,8 +215,14 @@ namespace Image2Card::Language::Audio
 
         std::string path = "/search/" + word + "/" + m_Language + "/";
 
+        Core::ScopedCancellationCallback stopOnCancel(cancellation, [&cli]() { cli.stop(); });
         auto res = cli.Get(path.c_str(), headers);
 
+        if (!res && cancellation.IsCancelled()) {
+          AF_INFO("ForvoClient: request cancelled");
+          return "";
+        }
+
         if (!res) {
           AF_WARN("ForvoClient: Search HTTP request failed for word '{}'", word);
           if (attempt < maxRetries - 1)
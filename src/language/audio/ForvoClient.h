@@ -36,10 +36,13 @@ public:
    * @param word The word to search for
    * @param headword The dictionary form (used if word is empty)
    * @param reading Optional reading (not used by Forvo)
+   * @param cancellation Aborts in-flight requests and skips retries when cancelled
    * @return List of audio files found
    */
-    [[nodiscard]] std::vector<AudioFileInfo>
-    SearchAudio(const std::string& word, const std::string& headword = "", const std::string& reading = "") override;
+    [[nodiscard]] std::vector<AudioFileInfo> SearchAudio(const std::string& word,
+                                                         const std::string& headword = "",
+                                                         const std::string& reading = "",
+                                                         const Core::CancellationToken& cancellation = {}) override;
 
     /**
    * Get the name of this audio source.
@@ -77,16 +80,19 @@ private:
     /**
    * Fetch the word page from Forvo.
    * @param word The word to look up
+   * @param cancellation Aborts the request and skips retries when cancelled
    * @return HTML content of the page
    */
-    [[nodiscard]] std::string FetchWordPage(const std::string& word) const;
+    [[nodiscard]] std::string FetchWordPage(const std::string& word, const Core::CancellationToken& cancellation) const;
 
     /**
    * Fetch the search page from Forvo (fallback when word page fails).
    * @param word The word to search for
+   * @param cancellation Aborts the request and skips retries when cancelled
    * @return HTML content of the page
    */
-    [[nodiscard]] std::string FetchSearchPage(const std::string& word) const;
+    [[nodiscard]] std::string FetchSearchPage(const std::string& word,
+                                              const Core::CancellationToken& cancellation) const;
 
     /**
    * Parse Forvo HTML page and extract audio URLs.
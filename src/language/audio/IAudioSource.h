@@ -3,6 +3,8 @@
 #include <string>
 #include <vector>
 
+#include "core/CancellationToken.h"
+
 namespace Image2Card::Language::Audio
 {
 
@@ -53,10 +55,13 @@ public:
    * @param word The word to search for (in any form)
    * @param headword The dictionary form of the word (for better results)
    * @param reading Optional kana reading to narrow results
+   * @param cancellation Aborts in-flight requests when cancelled or past its deadline
    * @return List of audio files found
    */
-    [[nodiscard]] virtual std::vector<AudioFileInfo>
-    SearchAudio(const std::string& word, const std::string& headword = "", const std::string& reading = "") = 0;
+    [[nodiscard]] virtual std::vector<AudioFileInfo> SearchAudio(const std::string& word,
+                                                                 const std::string& headword = "",
+                                                                 const std::string& reading = "",
+                                                                 const Core::CancellationToken& cancellation = {}) = 0;
 
     /**
    * Get the name of this audio source.
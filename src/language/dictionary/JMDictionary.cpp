@@ -5,6 +5,7 @@
 #include <stdexcept>
 
 #include "core/Logger.h"
+#include "core/Trace.h"
 
 namespace Image2Card::Language::Dictionary
 {
@@ -35,6 +36,7 @@ namespace Image2Card::Language::Dictionary
 
   DictionaryEntry JMDictionary::LookupWord(const std::string& word, const std::string& headword)
   {
+    AF_TRACE_SCOPE("jmdict", "JMdict lookup");
     if (word.empty()) {
       return DictionaryEntry();
     }
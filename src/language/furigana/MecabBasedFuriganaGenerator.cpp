@@ -7,6 +7,7 @@
 
 #include "JapaneseCharUtils.h"
 #include "core/Logger.h"
+#include "core/Trace.h"
 
 namespace Image2Card::Language::Furigana
 {
@@ -314,6 +315,7 @@ namespace Image2Card::Language::Furigana
 
   std::string MecabBasedFuriganaGenerator::Generate(const std::string& text)
   {
+    AF_TRACE_SCOPE("furigana", "Sentence furigana");
     if (text.empty()) {
       return "";
     }
@@ -358,6 +360,7 @@ namespace Image2Card::Language::Furigana
 
   std::string MecabBasedFuriganaGenerator::GenerateForWord(const std::string& word)
   {
+    AF_TRACE_SCOPE("furigana", "Word furigana");
     if (word.empty()) {
       return "";
     }
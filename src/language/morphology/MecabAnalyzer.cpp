@@ -5,6 +5,7 @@
 #include <stdexcept>
 
 #include "core/Logger.h"
+#include "core/Trace.h"
 
 namespace Image2Card::Language::Morphology
 {
@@ -69,6 +70,7 @@ namespace Image2Card::Language::Morphology
 
   MecabTokenList MecabAnalyzer::Analyze(const std::string& text)
   {
+    AF_TRACE_SCOPE("mecab", "MeCab analyze");
     if (!m_IsInitialized || !m_Mecab) {
       AF_ERROR("Mecab is not initialized");
       throw std::runtime_error("Mecab analyzer is not initialized");
@@ -80,16 +82,22 @@ namespace Image2Card::Language::Morphology
       return tokens;
     }
 
-    // Use sparse_tostr for simple string output
-    const char* result = mecab_sparse_tostr(m_Mecab, text.c_str());
+    // Use sparse_tostr for simple string output. The returned buffer is owned by
+    // the tagger and reused on the next call, so copy it out under the lock.
+    std::string output;
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      const char* result = mecab_sparse_tostr(m_Mecab, text.c_str());
 
-    if (!result) {
-      AF_ERROR("Mecab analysis failed");
-      throw std::runtime_error("Mecab morphological analysis failed");
+      if (!result) {
+        AF_ERROR("Mecab analysis failed");
+        throw std::runtime_error("Mecab morphological analysis failed");
+      }
+      output = result;
     }
 
     // Parse the result line by line
-    std::istringstream stream(result);
+    std::istringstream stream(output);
     std::string line;
 
     while (std::getline(stream, line)) {
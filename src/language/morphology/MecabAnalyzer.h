@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -41,6 +42,7 @@ public:
 
     /**
    * Analyze Japanese text and return morphological tokens.
+   * Safe to call from multiple threads; calls into the tagger are serialized.
    * @param text The Japanese text to analyze
    * @return List of MecabToken objects
    * @throws std::runtime_error if analysis fails
@@ -92,6 +94,7 @@ private:
 
     mecab_t* m_Mecab;
     bool m_IsInitialized;
+    std::mutex m_Mutex;
   };
 
 } // namespace Image2Card::Language::Morphology
\ No newline at end of file
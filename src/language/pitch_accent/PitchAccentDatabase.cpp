@@ -6,6 +6,7 @@
 #include <stdexcept>
 
 #include "core/Logger.h"
+#include "core/Trace.h"
 
 namespace Image2Card::Language::PitchAccent
 {
@@ -36,6 +37,7 @@ namespace Image2Card::Language::PitchAccent
 
   std::vector<PitchAccentEntry> PitchAccentDatabase::LookupWord(const std::string& word, const std::string& reading)
   {
+    AF_TRACE_SCOPE("pitch", "Pitch accent lookup");
     std::vector<PitchAccentEntry> results;
 
     if (!IsAvailable()) {
@@ -4,6 +4,7 @@
 
 #include "ai/ITextAIProvider.h"
 #include "core/Logger.h"
+#include "core/Trace.h"
 #include "language/ILanguage.h"
 
 namespace Image2Card::Language::Translation
@@ -14,14 +15,15 @@ namespace Image2Card::Language::Translation
       , m_Language(language)
   {}
 
-  std::string AITranslator::Translate(const std::string& text)
+  std::string AITranslator::Translate(const std::string& text, const Core::CancellationToken& cancellation)
   {
+    AF_TRACE_SCOPE("translate", "AI translator");
     if (!m_AIProvider || text.empty()) {
       return "";
     }
 
     try {
-      nlohmann::json analysis = m_AIProvider->AnalyzeSentence(text, "", m_Language);
+      nlohmann::json analysis = m_AIProvider->AnalyzeSentence(text, "", m_Language, cancellation);
 
       if (analysis.contains("translation") && analysis["translation"].is_string()) {
         return analysis["translation"].get<std::string>();
@@ -25,7 +25,8 @@ public:
     AITranslator(std::shared_ptr<AI::ITextAIProvider> aiProvider, const Language::ILanguage& language);
     ~AITranslator() override = default;
 
-    [[nodiscard]] std::string Translate(const std::string& text) override;
+    [[nodiscard]] std::string Translate(const std::string& text,
+                                        const Core::CancellationToken& cancellation = {}) override;
 
     [[nodiscard]] bool IsAvailable() const override;
 
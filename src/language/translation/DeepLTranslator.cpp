@@ -8,6 +8,7 @@
 #include <stdexcept>
 
 #include "core/Logger.h"
+#include "core/Trace.h"
 
 namespace Image2Card::Language::Translation
 {
@@ -27,8 +28,9 @@ namespace Image2Card::Language::Translation
     }
   }
 
-  std::string DeepLTranslator::Translate(const std::string& text)
+  std::string DeepLTranslator::Translate(const std::string& text, const Core::CancellationToken& cancellation)
   {
+    AF_TRACE_SCOPE("translate", "DeepL");
     if (text.empty()) {
       return "";
     }
@@ -39,14 +41,18 @@ namespace Image2Card::Language::Translation
       return text;
     }
 
+    if (cancellation.IsCancelled()) {
+      return "";
+    }
+
     try {
       // Determine host based on API tier
       std::string host = m_UseFreeAPI ? "api-free.deepl.com" : "api.deepl.com";
 
       httplib::SSLClient cli(host);
-      cli.set_connection_timeout(m_TimeoutSeconds, 0);
-      cli.set_read_timeout(m_TimeoutSeconds, 0);
-      cli.set_write_timeout(m_TimeoutSeconds, 0);
+      cli.set_connection_timeout(cancellation.ClampTimeout(std::chrono::seconds(m_TimeoutSeconds)));
+      cli.set_read_timeout(cancellation.ClampTimeout(std::chrono::seconds(m_TimeoutSeconds)));
+      cli.set_write_timeout(cancellation.ClampTimeout(std::chrono::seconds(m_TimeoutSeconds)));
 
       // Build request body
       std::stringstream body;
@@ -62,8 +68,14 @@ namespace Image2Card::Language::Translation
 
       AF_DEBUG("Sending translation request to DeepL for text: {}", text.substr(0, 50));
 
+      Core::ScopedCancellationCallback stopOnCancel(cancellation, [&cli]() { cli.stop(); });
       auto res = cli.Post("/v2/translate", headers, body.str(), "application/x-www-form-urlencoded");
 
+      if (!res && cancellation.IsCancelled()) {
+        AF_INFO("DeepLTranslator: request cancelled");
+        return "";
+      }
+
       if (!res) {
         AF_WARN("DeepL API request failed: no response - returning original text");
         return text;
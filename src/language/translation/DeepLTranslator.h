@@ -40,7 +40,8 @@ public:
    * @param text The Japanese text to translate
    * @return The English translation, or the original text if API is not available
    */
-    [[nodiscard]] std::string Translate(const std::string& text) override;
+    [[nodiscard]] std::string Translate(const std::string& text,
+                                        const Core::CancellationToken& cancellation = {}) override;
 
     /**
    * Check if DeepL API is available.
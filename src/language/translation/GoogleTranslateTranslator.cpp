@@ -7,6 +7,7 @@
 #include <stdexcept>
 
 #include "core/Logger.h"
+#include "core/Trace.h"
 
 namespace Image2Card::Language::Translation
 {
@@ -19,8 +20,9 @@ namespace Image2Card::Language::Translation
       , m_TimeoutSeconds(timeoutSeconds)
   {}
 
-  std::string GoogleTranslateTranslator::Translate(const std::string& text)
+  std::string GoogleTranslateTranslator::Translate(const std::string& text, const Core::CancellationToken& cancellation)
   {
+    AF_TRACE_SCOPE("translate", "Google Translate");
     AF_DEBUG("GoogleTranslateTranslator::Translate called with text: '{}'", text);
 
     if (text.empty()) {
@@ -28,11 +30,15 @@ namespace Image2Card::Language::Translation
       return "";
     }
 
+    if (cancellation.IsCancelled()) {
+      return "";
+    }
+
     try {
       AF_DEBUG("GoogleTranslateTranslator: Connecting to translate.google.com");
       httplib::Client cli("https://translate.google.com");
-      cli.set_connection_timeout(m_TimeoutSeconds, 0);
-      cli.set_read_timeout(m_TimeoutSeconds, 0);
+      cli.set_connection_timeout(cancellation.ClampTimeout(std::chrono::seconds(m_TimeoutSeconds)));
+      cli.set_read_timeout(cancellation.ClampTimeout(std::chrono::seconds(m_TimeoutSeconds)));
       cli.set_follow_location(true);
 
       std::string encodedText = text;
@@ -50,8 +56,14 @@ namespace Image2Card::Language::Translation
       std::string path = "/m?sl=" + m_SourceLang + "&tl=" + m_TargetLang + "&q=" + encoded;
 
       AF_DEBUG("GoogleTranslateTranslator: Sending GET request to path: {}", path);
+      Core::ScopedCancellationCallback stopOnCancel(cancellation, [&cli]() { cli.stop(); });
       auto res = cli.Get(path.c_str());
 
+      if (!res && cancellation.IsCancelled()) {
+        AF_INFO("GoogleTranslateTranslator: request cancelled");
+        return "";
+      }
+
       if (!res) {
         AF_ERROR("GoogleTranslateTranslator: Request failed - {}", httplib::to_string(res.error()));
         return "";
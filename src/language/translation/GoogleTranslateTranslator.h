@@ -16,7 +16,8 @@ public:
                                        int timeoutSeconds = 10);
     ~GoogleTranslateTranslator() override = default;
 
-    [[nodiscard]] std::string Translate(const std::string& text) override;
+    [[nodiscard]] std::string Translate(const std::string& text,
+                                        const Core::CancellationToken& cancellation = {}) override;
 
     [[nodiscard]] bool IsAvailable() const override;
 
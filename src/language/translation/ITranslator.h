@@ -2,6 +2,8 @@
 
 #include <string>
 
+#include "core/CancellationToken.h"
+
 namespace Image2Card::Language::Translation
 {
 
@@ -17,9 +19,11 @@ public:
     /**
    * Translate Japanese text to English.
    * @param text The Japanese text to translate
+   * @param cancellation Aborts an in-flight request when cancelled or past its deadline
    * @return The English translation, or empty if translation fails
    */
-    [[nodiscard]] virtual std::string Translate(const std::string& text) = 0;
+    [[nodiscard]] virtual std::string Translate(const std::string& text,
+                                                const Core::CancellationToken& cancellation = {}) = 0;
 
     /**
    * Check if translator is available.
@@ -14,7 +14,11 @@ public:
     NoneTranslator() = default;
     ~NoneTranslator() override = default;
 
-    [[nodiscard]] std::string Translate(const std::string& text) override { return ""; }
+    [[nodiscard]] std::string Translate(const std::string& text,
+                                        const Core::CancellationToken& cancellation = {}) override
+    {
+      return "";
+    }
 
     [[nodiscard]] bool IsAvailable() const override { return true; }
   };
@@ -1,9 +1,65 @@
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
 #include "Application.h"
+#include "batch/AnkiBenchmark.h"
+#include "batch/BatchProcessor.h"
+#include "batch/OCRBenchmark.h"
+#include "core/Trace.h"
 
 int main(int argc, char* argv[])
 {
-  Image2Card::Application app("Anki Image2Card", 1280, 720);
-  app.Run();
+  std::string batchDirectory;
+  int batchWorkers = 0;
+  std::string tracePath;
+  std::string benchOcrDirectory;
+  int benchIterations = 3;
+  int benchAnkiCards = 0;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--batch" && i + 1 < argc) {
+      batchDirectory = argv[++i];
+    } else if (arg == "--workers" && i + 1 < argc) {
+      batchWorkers = std::atoi(argv[++i]);
+    } else if (arg == "--trace" && i + 1 < argc) {
+      tracePath = argv[++i];
+    } else if (arg == "--bench-ocr" && i + 1 < argc) {
+      benchOcrDirectory = argv[++i];
+    } else if (arg == "--bench-anki" && i + 1 < argc) {
+      benchAnkiCards = std::atoi(argv[++i]);
+    } else if (arg == "--iterations" && i + 1 < argc) {
+      benchIterations = std::atoi(argv[++i]);
+    } else if (arg == "--help" || arg == "-h") {
+      std::cout << "Usage: " << argv[0]
+                << " [--batch <dir> [--workers <n>]] [--bench-ocr <dir> [--iterations <n>]] [--bench-anki <cards>]"
+                   " [--trace <trace.json>]\n";
+      return 0;
+    }
+  }
+
+  // Written on exit; open it in chrome://tracing or ui.perfetto.dev.
+  if (!tracePath.empty()) {
+    Image2Card::Core::Trace::SetThreadName("Main");
+    Image2Card::Core::Trace::Start(tracePath);
+  }
+
+  int exitCode = 0;
+  if (!benchOcrDirectory.empty()) {
+    Image2Card::Batch::OCRBenchmark benchmark(benchOcrDirectory, benchIterations);
+    exitCode = benchmark.Run();
+  } else if (benchAnkiCards > 0) {
+    Image2Card::Batch::AnkiBenchmark benchmark(benchAnkiCards);
+    exitCode = benchmark.Run();
+  } else if (!batchDirectory.empty()) {
+    Image2Card::Batch::BatchProcessor batch(batchDirectory, batchWorkers);
+    exitCode = batch.Run();
+  } else {
+    Image2Card::Application app("Anki Image2Card", 1280, 720);
+    app.Run();
+  }
 
-  return 0;
+  Image2Card::Core::Trace::Stop();
+  return exitCode;
 }
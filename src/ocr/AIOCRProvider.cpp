@@ -1,7 +1,9 @@
 #include "AIOCRProvider.h"
 
 #include "ai/ITextAIProvider.h"
+#include "ai/ImageUpload.h"
 #include "language/ILanguage.h"
+#include "utils/ImageProcessor.h"
 
 namespace Image2Card::OCR
 {
@@ -22,7 +24,22 @@ namespace Image2Card::OCR
       return "";
     }
 
-    return m_AIProvider->ExtractTextFromImage(imageBuffer, "image/webp", m_Language);
+    // The bytes can be any image file; decoding them lets the upload be resized and re-encoded.
+    Utils::ImageBuffer image = Utils::ImageProcessor::Decode(imageBuffer);
+    if (image.IsEmpty()) {
+      return "";
+    }
+    return ExtractTextFromPixels(image.View());
+  }
+
+  std::string AIOCRProvider::ExtractTextFromPixels(const Utils::ImageView& image)
+  {
+    if (!m_AIProvider) {
+      return "";
+    }
+
+    AI::PreparedImage upload = AI::ImageUpload::Prepare(image, m_AIProvider->GetImageUploadLimits());
+    return m_AIProvider->ExtractTextFromImage(upload.bytes, upload.mimeType, m_Language);
   }
 
   bool AIOCRProvider::IsInitialized() const
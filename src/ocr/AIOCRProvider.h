@@ -28,6 +28,11 @@ public:
 
     std::string ExtractTextFromImage(const std::vector<unsigned char>& imageBuffer) override;
 
+    /**
+   * Downscale and encode the pixels the way the provider prefers before uploading them.
+   */
+    std::string ExtractTextFromPixels(const Utils::ImageView& image) override;
+
     bool IsInitialized() const override;
 
 private:
@@ -3,6 +3,10 @@
 #include <string>
 #include <vector>
 
+#include "ocr/OCRResult.h"
+#include "utils/ImageProcessor.h"
+#include "utils/ImageView.h"
+
 namespace Image2Card::OCR
 {
 
@@ -16,6 +20,24 @@ public:
 
     virtual std::string ExtractTextFromImage(const std::vector<unsigned char>& imageBuffer) = 0;
 
+    /**
+   * Recognize text in uncompressed pixels. Providers that can read pixels directly
+   * override this to skip encoding; the default encodes a PNG for ExtractTextFromImage.
+   */
+    virtual std::string ExtractTextFromPixels(const Utils::ImageView& image)
+    {
+      return ExtractTextFromImage(Utils::ImageProcessor::EncodePNG(image));
+    }
+
+    /**
+   * Recognize text with its layout and per-word boxes. Providers without layout
+   * information return their plain text with every line covering the whole image.
+   */
+    virtual OCRResult ExtractStructuredText(const Utils::ImageView& image)
+    {
+      return OCRResult::FromText(ExtractTextFromPixels(image), image.width, image.height);
+    }
+
     virtual bool IsInitialized() const = 0;
   };
 
@@ -0,0 +1,518 @@
+#include "ocr/ImagePreprocessor.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "core/Logger.h"
+#include "core/Trace.h"
+#include "stb_image_resize2.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define AF_PREPROCESS_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define AF_TARGET_AVX2
+#else
+#define AF_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace Image2Card::OCR
+{
+
+  namespace
+  {
+    enum class SimdLevel
+    {
+      Scalar,
+      SSE2,
+      AVX2
+    };
+
+    std::atomic<bool> s_SimdEnabled{true};
+
+    SimdLevel DetectSimdLevel()
+    {
+#ifdef AF_PREPROCESS_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+      int info[4];
+      __cpuid(info, 0);
+      if (info[0] >= 7) {
+        __cpuid(info, 1);
+        bool osUsesAvx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 0x6) == 0x6;
+        __cpuidex(info, 7, 0);
+        if (osUsesAvx && (info[1] & (1 << 5))) {
+          return SimdLevel::AVX2;
+        }
+      }
+      return SimdLevel::SSE2;
+#else
+      return __builtin_cpu_supports("avx2") ? SimdLevel::AVX2 : SimdLevel::SSE2;
+#endif
+#else
+      return SimdLevel::Scalar;
+#endif
+    }
+
+    SimdLevel ActiveSimdLevel()
+    {
+      static const SimdLevel detected = DetectSimdLevel();
+      return s_SimdEnabled.load(std::memory_order_relaxed) ? detected : SimdLevel::Scalar;
+    }
+
+    // Kernels process as many pixels as their vector width allows and return the
+    // count; the scalar loop finishes the tail.
+
+    // BT.601 luma in 8.8 fixed point; the weights sum to 256.
+    constexpr int LumaR = 77;
+    constexpr int LumaG = 150;
+    constexpr int LumaB = 29;
+
+    void GrayscaleScalar(const unsigned char* src, unsigned char* dst, int begin, int count)
+    {
+      for (int i = begin; i < count; ++i) {
+        const unsigned char* p = src + (size_t) i * 4;
+        dst[i] = (unsigned char) ((p[0] * LumaR + p[1] * LumaG + p[2] * LumaB) >> 8);
+      }
+    }
+
+    // dst = min(src - lo, range) * 255 / range, with scale = (255 << 8) / range.
+    void StretchScalar(unsigned char* row, int begin, int count, int lo, int range, int scale)
+    {
+      for (int i = begin; i < count; ++i) {
+        int d = std::clamp(row[i] - lo, 0, range);
+        row[i] = (unsigned char) ((d * scale) >> 8);
+      }
+    }
+
+    void InvertScalar(unsigned char* row, int begin, int count)
+    {
+      for (int i = begin; i < count; ++i) {
+        row[i] = (unsigned char) (255 - row[i]);
+      }
+    }
+
+#ifdef AF_PREPROCESS_X86
+    int GrayscaleSSE2(const unsigned char* src, unsigned char* dst, int count)
+    {
+      // Channels are isolated in 32-bit lanes; products fit in the low 16 bits of each lane.
+      const __m128i mask = _mm_set1_epi32(0xFF);
+      const __m128i wr = _mm_set1_epi32(LumaR);
+      const __m128i wg = _mm_set1_epi32(LumaG);
+      const __m128i wb = _mm_set1_epi32(LumaB);
+
+      int i = 0;
+      for (; i + 16 <= count; i += 16) {
+        __m128i gray[4];
+        for (int k = 0; k < 4; ++k) {
+          __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + (size_t) (i + k * 4) * 4));
+          __m128i r = _mm_and_si128(px, mask);
+          __m128i g = _mm_and_si128(_mm_srli_epi32(px, 8), mask);
+          __m128i b = _mm_and_si128(_mm_srli_epi32(px, 16), mask);
+          __m128i sum = _mm_add_epi32(_mm_add_epi32(_mm_mullo_epi16(r, wr), _mm_mullo_epi16(g, wg)),
+                                      _mm_mullo_epi16(b, wb));
+          gray[k] = _mm_srli_epi32(sum, 8);
+        }
+        __m128i lo = _mm_packs_epi32(gray[0], gray[1]);
+        __m128i hi = _mm_packs_epi32(gray[2], gray[3]);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo, hi));
+      }
+      return i;
+    }
+
+    AF_TARGET_AVX2 int GrayscaleAVX2(const unsigned char* src, unsigned char* dst, int count)
+    {
+      const __m256i mask = _mm256_set1_epi32(0xFF);
+      const __m256i wr = _mm256_set1_epi32(LumaR);
+      const __m256i wg = _mm256_set1_epi32(LumaG);
+      const __m256i wb = _mm256_set1_epi32(LumaB);
+      // Packing works within 128-bit lanes; this restores pixel order afterwards.
+      const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+      int i = 0;
+      for (; i + 32 <= count; i += 32) {
+        __m256i gray[4];
+        for (int k = 0; k < 4; ++k) {
+          __m256i px = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + (size_t) (i + k * 8) * 4));
+          __m256i r = _mm256_and_si256(px, mask);
+          __m256i g = _mm256_and_si256(_mm256_srli_epi32(px, 8), mask);
+          __m256i b = _mm256_and_si256(_mm256_srli_epi32(px, 16), mask);
+          __m256i sum = _mm256_add_epi32(_mm256_add_epi32(_mm256_mullo_epi16(r, wr), _mm256_mullo_epi16(g, wg)),
+                                         _mm256_mullo_epi16(b, wb));
+          gray[k] = _mm256_srli_epi32(sum, 8);
+        }
+        __m256i lo = _mm256_packs_epi32(gray[0], gray[1]);
+        __m256i hi = _mm256_packs_epi32(gray[2], gray[3]);
+        __m256i packed = _mm256_permutevar8x32_epi32(_mm256_packus_epi16(lo, hi), order);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), packed);
+      }
+      return i;
+    }
+
+    int StretchSSE2(unsigned char* row, int count, int lo, int range, int scale)
+    {
+      // (d << 8) * scale >> 16 == d * scale >> 8; clamping d to range keeps the result <= 255.
+      const __m128i zero = _mm_setzero_si128();
+      const __m128i vlo = _mm_set1_epi8((char) lo);
+      const __m128i vrange = _mm_set1_epi8((char) range);
+      const __m128i vscale = _mm_set1_epi16((short) scale);
+
+      int i = 0;
+      for (; i + 16 <= count; i += 16) {
+        __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+        __m128i d = _mm_min_epu8(_mm_subs_epu8(px, vlo), vrange);
+        __m128i dlo = _mm_mulhi_epu16(_mm_unpacklo_epi8(zero, d), vscale);
+        __m128i dhi = _mm_mulhi_epu16(_mm_unpackhi_epi8(zero, d), vscale);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(row + i), _mm_packus_epi16(dlo, dhi));
+      }
+      return i;
+    }
+
+    AF_TARGET_AVX2 int StretchAVX2(unsigned char* row, int count, int lo, int range, int scale)
+    {
+      const __m256i zero = _mm256_setzero_si256();
+      const __m256i vlo = _mm256_set1_epi8((char) lo);
+      const __m256i vrange = _mm256_set1_epi8((char) range);
+      const __m256i vscale = _mm256_set1_epi16((short) scale);
+
+      // Unpack and pack both work within 128-bit lanes, so pixel order is preserved.
+      int i = 0;
+      for (; i + 32 <= count; i += 32) {
+        __m256i px = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i));
+        __m256i d = _mm256_min_epu8(_mm256_subs_epu8(px, vlo), vrange);
+        __m256i dlo = _mm256_mulhi_epu16(_mm256_unpacklo_epi8(zero, d), vscale);
+        __m256i dhi = _mm256_mulhi_epu16(_mm256_unpackhi_epi8(zero, d), vscale);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(row + i), _mm256_packus_epi16(dlo, dhi));
+      }
+      return i;
+    }
+
+    int InvertSSE2(unsigned char* row, int count)
+    {
+      const __m128i ones = _mm_set1_epi8((char) 0xFF);
+      int i = 0;
+      for (; i + 16 <= count; i += 16) {
+        __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(row + i), _mm_xor_si128(px, ones));
+      }
+      return i;
+    }
+
+    AF_TARGET_AVX2 int InvertAVX2(unsigned char* row, int count)
+    {
+      const __m256i ones = _mm256_set1_epi8((char) 0xFF);
+      int i = 0;
+      for (; i + 32 <= count; i += 32) {
+        __m256i px = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(row + i), _mm256_xor_si256(px, ones));
+      }
+      return i;
+    }
+#endif
+
+    std::array<uint32_t, 256> Histogram(const Utils::ImageBuffer& gray)
+    {
+      std::array<uint32_t, 256> histogram{};
+      for (unsigned char value : gray.pixels) {
+        ++histogram[value];
+      }
+      return histogram;
+    }
+
+    int Percentile(const std::array<uint32_t, 256>& histogram, size_t total, double fraction)
+    {
+      size_t target = (size_t) (total * fraction);
+      size_t seen = 0;
+      for (int value = 0; value < 256; ++value) {
+        seen += histogram[value];
+        if (seen > target) {
+          return value;
+        }
+      }
+      return 255;
+    }
+
+    int OtsuThreshold(const std::array<uint32_t, 256>& histogram, size_t total)
+    {
+      double sumAll = 0.0;
+      for (int value = 0; value < 256; ++value) {
+        sumAll += (double) value * histogram[value];
+      }
+
+      double sumBackground = 0.0;
+      size_t weightBackground = 0;
+      double bestVariance = -1.0;
+      int threshold = 128;
+      for (int value = 0; value < 256; ++value) {
+        weightBackground += histogram[value];
+        if (weightBackground == 0) {
+          continue;
+        }
+        size_t weightForeground = total - weightBackground;
+        if (weightForeground == 0) {
+          break;
+        }
+        sumBackground += (double) value * histogram[value];
+        double meanBackground = sumBackground / weightBackground;
+        double meanForeground = (sumAll - sumBackground) / weightForeground;
+        double variance = (double) weightBackground * weightForeground * (meanBackground - meanForeground) *
+                          (meanBackground - meanForeground);
+        if (variance > bestVariance) {
+          bestVariance = variance;
+          threshold = value;
+        }
+      }
+      return threshold;
+    }
+  } // namespace
+
+  Utils::ImageBuffer ImagePreprocessor::Run(const Utils::ImageView& image, const PreprocessOptions& options)
+  {
+    AF_TRACE_SCOPE("ocr", "Preprocess");
+    Utils::ImageBuffer gray = ToGrayscale(image);
+    if (gray.IsEmpty()) {
+      return gray;
+    }
+
+    StretchContrast(gray);
+    if (options.invertLightText && IsLightOnDark(gray)) {
+      Invert(gray);
+    }
+
+    // Rescaling is skipped when the text is already close to the target height.
+    int textHeight = EstimateTextHeight(gray, options.verticalText);
+    if (textHeight > 0) {
+      double scale = (double) options.targetTextHeight / textHeight;
+      if (scale < 0.8 || scale > 1.25) {
+        Utils::ImageBuffer scaled = Rescale(gray, std::clamp(scale, 0.25, 4.0));
+        if (!scaled.IsEmpty()) {
+          gray = std::move(scaled);
+        }
+      }
+    }
+
+    if (options.binarize) {
+      BinarizeAdaptive(gray, options.targetTextHeight);
+    }
+    return gray;
+  }
+
+  Utils::ImageBuffer ImagePreprocessor::ToGrayscale(const Utils::ImageView& image)
+  {
+    if (image.IsEmpty()) {
+      return {};
+    }
+
+    Utils::ImageBuffer gray(image.width, image.height, Utils::PixelFormat::Gray8);
+#ifdef AF_PREPROCESS_X86
+    SimdLevel level = ActiveSimdLevel();
+#endif
+    for (int y = 0; y < image.height; ++y) {
+      const unsigned char* src = image.Row(y);
+      unsigned char* dst = gray.Row(y);
+      if (image.format == Utils::PixelFormat::Gray8) {
+        std::memcpy(dst, src, (size_t) image.width);
+        continue;
+      }
+
+      int done = 0;
+#ifdef AF_PREPROCESS_X86
+      if (level == SimdLevel::AVX2) {
+        done = GrayscaleAVX2(src, dst, image.width);
+      } else if (level == SimdLevel::SSE2) {
+        done = GrayscaleSSE2(src, dst, image.width);
+      }
+#endif
+      GrayscaleScalar(src, dst, done, image.width);
+    }
+    return gray;
+  }
+
+  void ImagePreprocessor::StretchContrast(Utils::ImageBuffer& gray)
+  {
+    auto histogram = Histogram(gray);
+    int lo = Percentile(histogram, gray.pixels.size(), 0.01);
+    int hi = Percentile(histogram, gray.pixels.size(), 0.99);
+    int range = hi - lo;
+
+    // A nearly flat image has nothing to stretch; amplifying it would only amplify noise.
+    if (range < 16 || range == 255) {
+      return;
+    }
+    int scale = (255 << 8) / range;
+
+    int count = (int) gray.pixels.size();
+    unsigned char* data = gray.pixels.data();
+    int done = 0;
+#ifdef AF_PREPROCESS_X86
+    SimdLevel level = ActiveSimdLevel();
+    if (level == SimdLevel::AVX2) {
+      done = StretchAVX2(data, count, lo, range, scale);
+    } else if (level == SimdLevel::SSE2) {
+      done = StretchSSE2(data, count, lo, range, scale);
+    }
+#endif
+    StretchScalar(data, done, count, lo, range, scale);
+  }
+
+  bool ImagePreprocessor::IsLightOnDark(const Utils::ImageBuffer& gray)
+  {
+    if (gray.IsEmpty()) {
+      return false;
+    }
+    // The background covers most of a text crop, so the median pixel is background.
+    auto histogram = Histogram(gray);
+    return Percentile(histogram, gray.pixels.size(), 0.5) < 128;
+  }
+
+  void ImagePreprocessor::Invert(Utils::ImageBuffer& gray)
+  {
+    int count = (int) gray.pixels.size();
+    unsigned char* data = gray.pixels.data();
+    int done = 0;
+#ifdef AF_PREPROCESS_X86
+    SimdLevel level = ActiveSimdLevel();
+    if (level == SimdLevel::AVX2) {
+      done = InvertAVX2(data, count);
+    } else if (level == SimdLevel::SSE2) {
+      done = InvertSSE2(data, count);
+    }
+#endif
+    InvertScalar(data, done, count);
+  }
+
+  int ImagePreprocessor::InkThreshold(const Utils::ImageBuffer& gray)
+  {
+    return OtsuThreshold(Histogram(gray), gray.pixels.size());
+  }
+
+  int ImagePreprocessor::EstimateTextHeight(const Utils::ImageBuffer& gray, bool verticalText)
+  {
+    if (gray.IsEmpty()) {
+      return 0;
+    }
+
+    int threshold = InkThreshold(gray);
+
+    // Ink profile across lines: per row for horizontal text, per column for vertical text.
+    int length = verticalText ? gray.width : gray.height;
+    int span = verticalText ? gray.height : gray.width;
+    std::vector<int> profile(length, 0);
+    for (int y = 0; y < gray.height; ++y) {
+      const unsigned char* row = gray.pixels.data() + (size_t) y * gray.Stride();
+      for (int x = 0; x < gray.width; ++x) {
+        if (row[x] <= threshold) {
+          ++profile[verticalText ? x : y];
+        }
+      }
+    }
+
+    // A row or column belongs to a line if at least 1% of it is ink; runs shorter than 3px are noise.
+    int minInk = std::max(1, span / 100);
+    std::vector<int> runs;
+    int run = 0;
+    for (int i = 0; i <= length; ++i) {
+      if (i < length && profile[i] >= minInk) {
+        ++run;
+      } else {
+        if (run >= 3) {
+          runs.push_back(run);
+        }
+        run = 0;
+      }
+    }
+
+    if (runs.empty()) {
+      return 0;
+    }
+    std::nth_element(runs.begin(), runs.begin() + runs.size() / 2, runs.end());
+    return runs[runs.size() / 2];
+  }
+
+  Utils::ImageBuffer ImagePreprocessor::Rescale(const Utils::ImageBuffer& gray, double scale)
+  {
+    constexpr int MaxDimension = 8192;
+    int width = std::clamp((int) (gray.width * scale + 0.5), 1, MaxDimension);
+    int height = std::clamp((int) (gray.height * scale + 0.5), 1, MaxDimension);
+
+    Utils::ImageBuffer scaled(width, height, Utils::PixelFormat::Gray8);
+    if (!stbir_resize_uint8_linear(gray.pixels.data(),
+                                   gray.width,
+                                   gray.height,
+                                   gray.Stride(),
+                                   scaled.pixels.data(),
+                                   width,
+                                   height,
+                                   scaled.Stride(),
+                                   STBIR_1CHANNEL))
+    {
+      AF_WARN("Failed to rescale {}x{} image for OCR", gray.width, gray.height);
+      return {};
+    }
+    return scaled;
+  }
+
+  void ImagePreprocessor::BinarizeAdaptive(Utils::ImageBuffer& gray, int windowSize, int biasPercent)
+  {
+    if (gray.IsEmpty()) {
+      return;
+    }
+
+    int width = gray.width;
+    int height = gray.height;
+
+    // Summed-area table. Window sums are differences of four entries, so they stay
+    // exact in uint32 even when the table itself wraps around on large images.
+    std::vector<uint32_t> integral((size_t) (width + 1) * (height + 1), 0);
+    for (int y = 0; y < height; ++y) {
+      const unsigned char* row = gray.Row(y);
+      uint32_t* above = integral.data() + (size_t) y * (width + 1);
+      uint32_t* current = above + (width + 1);
+      uint32_t rowSum = 0;
+      for (int x = 0; x < width; ++x) {
+        rowSum += row[x];
+        current[x + 1] = above[x + 1] + rowSum;
+      }
+    }
+
+    int half = std::max(1, windowSize / 2);
+    for (int y = 0; y < height; ++y) {
+      int y0 = std::max(0, y - half);
+      int y1 = std::min(height, y + half + 1);
+      const uint32_t* top = integral.data() + (size_t) y0 * (width + 1);
+      const uint32_t* bottom = integral.data() + (size_t) y1 * (width + 1);
+      unsigned char* row = gray.Row(y);
+      for (int x = 0; x < width; ++x) {
+        int x0 = std::max(0, x - half);
+        int x1 = std::min(width, x + half + 1);
+        uint32_t sum = bottom[x1] - bottom[x0] - top[x1] + top[x0];
+        int64_t area = (int64_t) (x1 - x0) * (y1 - y0);
+        bool ink = (int64_t) row[x] * area * 100 <= (int64_t) sum * (100 - biasPercent);
+        row[x] = ink ? 0 : 255;
+      }
+    }
+  }
+
+  void ImagePreprocessor::SetSimdEnabled(bool enabled)
+  {
+    s_SimdEnabled.store(enabled);
+  }
+
+  const char* ImagePreprocessor::GetSimdLevel()
+  {
+    switch (ActiveSimdLevel()) {
+      case SimdLevel::AVX2:
+        return "AVX2";
+      case SimdLevel::SSE2:
+        return "SSE2";
+      default:
+        return "scalar";
+    }
+  }
+
+} // namespace Image2Card::OCR
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "utils/ImageView.h"
+
+namespace Image2Card::OCR
+{
+
+  struct PreprocessOptions
+  {
+    bool verticalText = false;   // Lines run top to bottom, so text height is measured across columns
+    int targetTextHeight = 36;   // Ink height of a line after rescaling; Tesseract reads CJK best around 30-40px
+    bool binarize = true;        // Adaptive threshold to black text on white
+    bool invertLightText = true; // Invert when the background is darker than the text
+  };
+
+  /**
+ * Cleans up a crop before Tesseract: grayscale, contrast stretch, inversion of
+ * light-on-dark text, rescaling to a readable text height and adaptive
+ * binarization. The per-pixel kernels use AVX2 or SSE2 when the CPU has them
+ * and fall back to scalar code elsewhere.
+ */
+  class ImagePreprocessor
+  {
+public:
+
+    /**
+   * Run every step and return an 8-bit grayscale image ready for Tesseract.
+   */
+    [[nodiscard]] static Utils::ImageBuffer Run(const Utils::ImageView& image, const PreprocessOptions& options = {});
+
+    [[nodiscard]] static Utils::ImageBuffer ToGrayscale(const Utils::ImageView& image);
+
+    /**
+   * Map the 1st..99th percentile of the histogram to the full 0..255 range.
+   */
+    static void StretchContrast(Utils::ImageBuffer& gray);
+
+    /**
+   * True if most pixels are dark, i.e. the text is lighter than its background.
+   */
+    [[nodiscard]] static bool IsLightOnDark(const Utils::ImageBuffer& gray);
+
+    static void Invert(Utils::ImageBuffer& gray);
+
+    /**
+   * Otsu threshold of a dark-on-light image: pixels at or below it are ink.
+   */
+    [[nodiscard]] static int InkThreshold(const Utils::ImageBuffer& gray);
+
+    /**
+   * Median ink height of the text lines (column width for vertical text).
+   * @return Height in pixels, or 0 if no lines were found
+   */
+    [[nodiscard]] static int EstimateTextHeight(const Utils::ImageBuffer& gray, bool verticalText);
+
+    [[nodiscard]] static Utils::ImageBuffer Rescale(const Utils::ImageBuffer& gray, double scale);
+
+    /**
+   * Bradley local-mean threshold: a pixel becomes black if it is biasPercent darker
+   * than the mean of the window around it.
+   */
+    static void BinarizeAdaptive(Utils::ImageBuffer& gray, int windowSize, int biasPercent = 15);
+
+    /**
+   * Allow or forbid the vector kernels (for comparing against the scalar code).
+   */
+    static void SetSimdEnabled(bool enabled);
+
+    /**
+   * Instruction set the kernels currently use: "AVX2", "SSE2" or "scalar".
+   */
+    [[nodiscard]] static const char* GetSimdLevel();
+  };
+
+} // namespace Image2Card::OCR
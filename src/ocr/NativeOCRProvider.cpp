@@ -1,5 +1,6 @@
 #include "ocr/NativeOCRProvider.h"
 
+#include "core/Trace.h"
 #include "ocr/native/NativeOCRProviderInternal.h"
 
 namespace Image2Card::OCR
@@ -21,6 +22,7 @@ namespace Image2Card::OCR
 
   std::string NativeOCRProvider::ExtractTextFromImage(const std::vector<unsigned char>& imageBuffer)
   {
+    AF_TRACE_SCOPE("ocr", "Native OCR");
     return m_Impl->m_PlatformImpl->ExtractTextFromImage(imageBuffer);
   }
 
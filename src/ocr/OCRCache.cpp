@@ -0,0 +1,323 @@
+#include "ocr/OCRCache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <nlohmann/json.hpp>
+#include <sqlite3.h>
+#include <stdexcept>
+#include <vector>
+
+#include "core/Logger.h"
+#include "core/Trace.h"
+
+namespace Image2Card::OCR
+{
+
+  namespace
+  {
+    constexpr uint64_t Prime1 = 0x9E3779B185EBCA87ULL;
+    constexpr uint64_t Prime2 = 0xC2B2AE3D27D4EB4FULL;
+
+    uint64_t Rotl(uint64_t value, int bits)
+    {
+      return (value << bits) | (value >> (64 - bits));
+    }
+
+    uint64_t Round(uint64_t hash, uint64_t input)
+    {
+      hash ^= Rotl(input * Prime2, 31) * Prime1;
+      return Rotl(hash, 27) * Prime1 + 0x85EBCA77C2B2AE63ULL;
+    }
+
+    uint64_t Avalanche(uint64_t hash)
+    {
+      hash ^= hash >> 33;
+      hash *= 0xFF51AFD7ED558CCDULL;
+      hash ^= hash >> 33;
+      hash *= 0xC4CEB9FE1A85EC53ULL;
+      hash ^= hash >> 33;
+      return hash;
+    }
+
+    nlohmann::json BoxToJson(const Utils::Rect& box)
+    {
+      return {box.x, box.y, box.width, box.height};
+    }
+
+    Utils::Rect BoxFromJson(const nlohmann::json& json)
+    {
+      return {json.at(0).get<int>(), json.at(1).get<int>(), json.at(2).get<int>(), json.at(3).get<int>()};
+    }
+
+    // Short keys keep the stored results small; the cache is not meant to be read by anything else.
+    std::string Serialize(const OCRResult& result)
+    {
+      nlohmann::json blocks = nlohmann::json::array();
+      for (const auto& block : result.blocks) {
+        nlohmann::json lines = nlohmann::json::array();
+        for (const auto& line : block.lines) {
+          nlohmann::json words = nlohmann::json::array();
+          for (const auto& word : line.words) {
+            nlohmann::json symbols = nlohmann::json::array();
+            for (const auto& symbol : word.symbols) {
+              symbols.push_back({{"t", symbol.text}, {"b", BoxToJson(symbol.box)}, {"c", symbol.confidence}});
+            }
+            words.push_back({{"t", word.text}, {"b", BoxToJson(word.box)}, {"c", word.confidence}, {"s", symbols}});
+          }
+          lines.push_back({{"t", line.text}, {"b", BoxToJson(line.box)}, {"c", line.confidence}, {"w", words}});
+        }
+        blocks.push_back({{"b", BoxToJson(block.box)}, {"c", block.confidence}, {"l", lines}});
+      }
+      return blocks.dump();
+    }
+
+    OCRResult Deserialize(const std::string& data)
+    {
+      OCRResult result;
+      for (const auto& blockJson : nlohmann::json::parse(data)) {
+        OCRBlock block{BoxFromJson(blockJson.at("b")), blockJson.at("c").get<float>(), {}};
+        for (const auto& lineJson : blockJson.at("l")) {
+          OCRLine line{lineJson.at("t"), BoxFromJson(lineJson.at("b")), lineJson.at("c").get<float>(), {}};
+          for (const auto& wordJson : lineJson.at("w")) {
+            OCRWord word{wordJson.at("t"), BoxFromJson(wordJson.at("b")), wordJson.at("c").get<float>(), {}};
+            for (const auto& symbolJson : wordJson.at("s")) {
+              word.symbols.push_back(
+                  {symbolJson.at("t"), BoxFromJson(symbolJson.at("b")), symbolJson.at("c").get<float>()});
+            }
+            line.words.push_back(std::move(word));
+          }
+          block.lines.push_back(std::move(line));
+        }
+        result.blocks.push_back(std::move(block));
+      }
+      return result;
+    }
+
+    bool Exec(sqlite3* db, const char* sql)
+    {
+      char* error = nullptr;
+      if (sqlite3_exec(db, sql, nullptr, nullptr, &error) != SQLITE_OK) {
+        AF_ERROR("OCR cache: {} ({})", error ? error : "unknown error", sql);
+        sqlite3_free(error);
+        return false;
+      }
+      return true;
+    }
+  } // namespace
+
+  OCRCache::OCRCache(const std::string& dbPath, size_t maxBytes)
+      : m_MaxBytes(maxBytes)
+  {
+    int result = sqlite3_open(dbPath.c_str(), &m_Database);
+    if (result != SQLITE_OK) {
+      std::string error = sqlite3_errmsg(m_Database);
+      sqlite3_close(m_Database);
+      m_Database = nullptr;
+      throw std::runtime_error("Failed to open OCR cache: " + error);
+    }
+
+    bool ready = Exec(m_Database, "PRAGMA journal_mode=WAL; PRAGMA synchronous=NORMAL;") &&
+                 Exec(m_Database,
+                      "CREATE TABLE IF NOT EXISTS ocr_cache ("
+                      "key TEXT PRIMARY KEY, result TEXT NOT NULL, size INTEGER NOT NULL, last_used INTEGER NOT NULL);"
+                      "CREATE INDEX IF NOT EXISTS ocr_cache_last_used ON ocr_cache(last_used);");
+    if (!ready) {
+      sqlite3_close(m_Database);
+      m_Database = nullptr;
+      throw std::runtime_error("Failed to create OCR cache table");
+    }
+
+    sqlite3_stmt* stmt = nullptr;
+    const char* totals = "SELECT COALESCE(SUM(size), 0), COALESCE(MAX(last_used), 0) FROM ocr_cache";
+    if (sqlite3_prepare_v2(m_Database, totals, -1, &stmt, nullptr) == SQLITE_OK) {
+      if (sqlite3_step(stmt) == SQLITE_ROW) {
+        m_SizeBytes = static_cast<size_t>(sqlite3_column_int64(stmt, 0));
+        m_Clock = static_cast<uint64_t>(sqlite3_column_int64(stmt, 1));
+      }
+      sqlite3_finalize(stmt);
+    }
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    EvictLocked();
+    AF_INFO("OCR cache opened: {} ({} KB of {} KB)", dbPath, m_SizeBytes / 1024, m_MaxBytes / 1024);
+  }
+
+  OCRCache::~OCRCache()
+  {
+    if (m_Database) {
+      sqlite3_close(m_Database);
+      m_Database = nullptr;
+    }
+  }
+
+  uint64_t OCRCache::HashPixels(const Utils::ImageView& image)
+  {
+    uint64_t hash = Avalanche(((uint64_t) image.width << 32) ^ (uint64_t) image.height ^
+                              ((uint64_t) image.format << 60));
+    size_t rowBytes = (size_t) image.width * Utils::BytesPerPixel(image.format);
+    for (int y = 0; y < image.height; ++y) {
+      const unsigned char* row = image.Row(y);
+      size_t i = 0;
+      for (; i + 8 <= rowBytes; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, row + i, sizeof(word));
+        hash = Round(hash, word);
+      }
+      if (i < rowBytes) {
+        uint64_t tail = 0;
+        std::memcpy(&tail, row + i, rowBytes - i);
+        hash = Round(hash, tail ^ ((uint64_t) (rowBytes - i) << 56));
+      }
+    }
+    return Avalanche(hash);
+  }
+
+  std::string OCRCache::Key(const Utils::ImageView& image, const std::string& settings)
+  {
+    return std::format("{:016x}:{}", HashPixels(image), settings);
+  }
+
+  std::optional<OCRResult> OCRCache::Get(const std::string& key)
+  {
+    AF_TRACE_SCOPE("ocr", "OCR cache lookup");
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    std::optional<std::string> data;
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(m_Database, "SELECT result FROM ocr_cache WHERE key = ?", -1, &stmt, nullptr) != SQLITE_OK) {
+      AF_ERROR("OCR cache: failed to prepare lookup: {}", sqlite3_errmsg(m_Database));
+      ++m_Misses;
+      return std::nullopt;
+    }
+    sqlite3_bind_text(stmt, 1, key.c_str(), -1, SQLITE_TRANSIENT);
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+      const char* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+      data = text ? text : "";
+    }
+    sqlite3_finalize(stmt);
+
+    if (!data) {
+      ++m_Misses;
+      return std::nullopt;
+    }
+
+    OCRResult result;
+    try {
+      result = Deserialize(*data);
+    } catch (const std::exception& e) {
+      AF_WARN("OCR cache: dropping unreadable entry: {}", e.what());
+      ++m_Misses;
+      return std::nullopt;
+    }
+
+    if (sqlite3_prepare_v2(m_Database, "UPDATE ocr_cache SET last_used = ? WHERE key = ?", -1, &stmt, nullptr) ==
+        SQLITE_OK) {
+      sqlite3_bind_int64(stmt, 1, (sqlite3_int64) ++m_Clock);
+      sqlite3_bind_text(stmt, 2, key.c_str(), -1, SQLITE_TRANSIENT);
+      sqlite3_step(stmt);
+      sqlite3_finalize(stmt);
+    }
+
+    ++m_Hits;
+    return result;
+  }
+
+  void OCRCache::Put(const std::string& key, const OCRResult& result)
+  {
+    AF_TRACE_SCOPE("ocr", "OCR cache store");
+    std::string data = Serialize(result);
+    size_t size = key.size() + data.size();
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (size > m_MaxBytes) {
+      return;
+    }
+
+    // A replaced entry no longer counts towards the total.
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(m_Database, "SELECT size FROM ocr_cache WHERE key = ?", -1, &stmt, nullptr) == SQLITE_OK) {
+      sqlite3_bind_text(stmt, 1, key.c_str(), -1, SQLITE_TRANSIENT);
+      if (sqlite3_step(stmt) == SQLITE_ROW) {
+        m_SizeBytes -= std::min(m_SizeBytes, static_cast<size_t>(sqlite3_column_int64(stmt, 0)));
+      }
+      sqlite3_finalize(stmt);
+    }
+
+    const char* sql = "INSERT OR REPLACE INTO ocr_cache (key, result, size, last_used) VALUES (?, ?, ?, ?)";
+    if (sqlite3_prepare_v2(m_Database, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+      AF_ERROR("OCR cache: failed to prepare insert: {}", sqlite3_errmsg(m_Database));
+      return;
+    }
+    sqlite3_bind_text(stmt, 1, key.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt, 2, data.c_str(), (int) data.size(), SQLITE_TRANSIENT);
+    sqlite3_bind_int64(stmt, 3, (sqlite3_int64) size);
+    sqlite3_bind_int64(stmt, 4, (sqlite3_int64) ++m_Clock);
+    if (sqlite3_step(stmt) == SQLITE_DONE) {
+      m_SizeBytes += size;
+    } else {
+      AF_ERROR("OCR cache: failed to store result: {}", sqlite3_errmsg(m_Database));
+    }
+    sqlite3_finalize(stmt);
+
+    EvictLocked();
+  }
+
+  void OCRCache::SetMaxBytes(size_t maxBytes)
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_MaxBytes = maxBytes;
+    EvictLocked();
+  }
+
+  void OCRCache::Clear()
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (Exec(m_Database, "DELETE FROM ocr_cache")) {
+      m_SizeBytes = 0;
+    }
+  }
+
+  size_t OCRCache::GetSizeBytes() const
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_SizeBytes;
+  }
+
+  void OCRCache::EvictLocked()
+  {
+    if (m_SizeBytes <= m_MaxBytes) {
+      return;
+    }
+
+    // Oldest first until the rest fits.
+    std::vector<std::string> victims;
+    size_t remaining = m_SizeBytes;
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(m_Database, "SELECT key, size FROM ocr_cache ORDER BY last_used ASC", -1, &stmt, nullptr) !=
+        SQLITE_OK) {
+      AF_ERROR("OCR cache: failed to prepare eviction: {}", sqlite3_errmsg(m_Database));
+      return;
+    }
+    while (remaining > m_MaxBytes && sqlite3_step(stmt) == SQLITE_ROW) {
+      victims.emplace_back(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0)));
+      remaining -= std::min(remaining, static_cast<size_t>(sqlite3_column_int64(stmt, 1)));
+    }
+    sqlite3_finalize(stmt);
+
+    Exec(m_Database, "BEGIN");
+    if (sqlite3_prepare_v2(m_Database, "DELETE FROM ocr_cache WHERE key = ?", -1, &stmt, nullptr) == SQLITE_OK) {
+      for (const auto& key : victims) {
+        sqlite3_bind_text(stmt, 1, key.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_step(stmt);
+        sqlite3_reset(stmt);
+      }
+      sqlite3_finalize(stmt);
+    }
+    Exec(m_Database, "COMMIT");
+
+    m_SizeBytes = remaining;
+    AF_INFO("OCR cache: evicted {} entries, {} KB left", victims.size(), m_SizeBytes / 1024);
+  }
+
+} // namespace Image2Card::OCR
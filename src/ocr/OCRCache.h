@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+
+#include "ocr/OCRResult.h"
+#include "utils/ImageView.h"
+
+struct sqlite3;
+
+namespace Image2Card::OCR
+{
+
+  /**
+ * Persistent cache of OCR results in a local SQLite file, so rescanning the same
+ * crop does not run Tesseract or pay for a vision request again.
+ * Entries are keyed by a hash of the crop's pixels plus the settings that affect
+ * recognition, and evicted least recently used first once the stored results
+ * exceed the size limit. Safe to use from several threads.
+ */
+  class OCRCache
+  {
+public:
+
+    /**
+   * @param dbPath SQLite file, created if missing
+   * @param maxBytes Upper bound for the stored results
+   * @throws std::runtime_error if the database cannot be opened or created
+   */
+    OCRCache(const std::string& dbPath, size_t maxBytes);
+    ~OCRCache();
+
+    OCRCache(const OCRCache&) = delete;
+    OCRCache& operator=(const OCRCache&) = delete;
+
+    /**
+   * Build a cache key from the pixels and a description of the OCR settings
+   * (method, orientation, model, ...). Row padding is not hashed.
+   */
+    [[nodiscard]] static std::string Key(const Utils::ImageView& image, const std::string& settings);
+
+    /**
+   * Fast 64-bit hash of the visible pixels.
+   */
+    [[nodiscard]] static uint64_t HashPixels(const Utils::ImageView& image);
+
+    /**
+   * @return The stored result, or nullopt on a miss. A hit marks the entry as recently used.
+   */
+    std::optional<OCRResult> Get(const std::string& key);
+
+    /**
+   * Store a result, evicting the least recently used entries if the cache grows past its limit.
+   */
+    void Put(const std::string& key, const OCRResult& result);
+
+    void SetMaxBytes(size_t maxBytes);
+    void Clear();
+
+    [[nodiscard]] uint64_t GetHitCount() const { return m_Hits.load(); }
+    [[nodiscard]] uint64_t GetMissCount() const { return m_Misses.load(); }
+    [[nodiscard]] size_t GetSizeBytes() const;
+
+private:
+
+    void EvictLocked();
+
+    sqlite3* m_Database = nullptr;
+    mutable std::mutex m_Mutex;
+    size_t m_MaxBytes;
+    size_t m_SizeBytes = 0;
+    uint64_t m_Clock = 0; // Last-used stamp; increases with every access
+    std::atomic<uint64_t> m_Hits{0};
+    std::atomic<uint64_t> m_Misses{0};
+  };
+
+} // namespace Image2Card::OCR
@@ -0,0 +1,194 @@
+#include "ocr/OCRCascade.h"
+
+#include <exception>
+#include <future>
+#include <memory>
+
+#include "core/Logger.h"
+#include "core/TaskExecutor.h"
+#include "core/Trace.h"
+
+namespace Image2Card::OCR
+{
+
+  namespace
+  {
+    using Clock = std::chrono::steady_clock;
+
+    double MillisecondsSince(Clock::time_point begin)
+    {
+      return std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+    }
+
+    struct FallbackRun
+    {
+      OCRResult result;
+      bool started = false;
+      bool hedged = false; // Started while local OCR was still running
+      double ms = 0.0;
+    };
+
+    // State shared between the local pass and the hedged fallback the timer posts.
+    // Whoever claims it first decides: the timer starts the fallback, or the local pass finished first.
+    struct HedgeState
+    {
+      std::mutex mutex;
+      bool claimed = false;
+      std::promise<void> done; // Set once a fallback started by the timer has ended
+      FallbackRun run;
+      std::exception_ptr error;
+    };
+  } // namespace
+
+  OCRCascade::Outcome OCRCascade::Recognize(const Recognizer& local,
+                                            const Recognizer& fallback,
+                                            const CascadeOptions& options,
+                                            const Core::CancellationToken& cancellation)
+  {
+    AF_TRACE_SCOPE("ocr", "OCR cascade");
+    auto begin = Clock::now();
+
+    auto isConfident = [&options](const OCRResult& result) {
+      return !result.IsEmpty() && result.MeanWordConfidence() >= options.minConfidence;
+    };
+
+    // The fallback gets its own source so a good local result can abandon it without cancelling the scan.
+    Core::CancellationSource fallbackSource = Core::CancellationSource::CreateLinked(cancellation);
+    auto runFallback = [&fallback](const Core::CancellationToken& token, FallbackRun& run) {
+      AF_TRACE_SCOPE("ocr", "OCR cascade fallback");
+      auto start = Clock::now();
+      run.started = true;
+      run.result = fallback(token);
+      run.ms = MillisecondsSince(start);
+    };
+
+    // The hedge is posted when the delay passes rather than parking a worker until then, so the
+    // delay costs no thread that the local passes of other regions could use.
+    bool hedging = options.hedgeDelay.count() > 0;
+    auto hedge = std::make_shared<HedgeState>();
+    std::future<void> hedgeDone = hedge->done.get_future();
+    if (hedging) {
+      // runFallback is only touched after claiming, and this function waits for a claimed hedge to end.
+      auto token = fallbackSource.GetToken();
+      auto startHedge = [&runFallback, hedge, token]() {
+        {
+          std::lock_guard<std::mutex> lock(hedge->mutex);
+          if (hedge->claimed) {
+            return;
+          }
+          hedge->claimed = true;
+        }
+        hedge->run.hedged = true;
+        try {
+          if (!token.IsCancelled()) {
+            runFallback(token, hedge->run);
+          }
+        } catch (...) {
+          hedge->error = std::current_exception();
+        }
+        hedge->done.set_value();
+      };
+      Core::TaskExecutor::Get().PostAfter(Core::TaskPriority::Interactive, options.hedgeDelay, std::move(startHedge));
+    }
+
+    Outcome outcome;
+    std::exception_ptr localError;
+    auto localStart = Clock::now();
+    try {
+      AF_TRACE_SCOPE("ocr", "OCR cascade local");
+      outcome.result = local(cancellation);
+    } catch (...) {
+      localError = std::current_exception();
+    }
+    double localMs = MillisecondsSince(localStart);
+    outcome.localConfidence = outcome.result.MeanWordConfidence();
+
+    bool confident = !localError && isConfident(outcome.result);
+    bool hedgeStarted = false;
+    if (hedging) {
+      std::lock_guard<std::mutex> lock(hedge->mutex);
+      hedgeStarted = hedge->claimed;
+      hedge->claimed = true;
+    }
+    if (confident) {
+      fallbackSource.Cancel();
+    }
+
+    FallbackRun run;
+    std::exception_ptr fallbackError;
+    if (hedgeStarted) {
+      hedgeDone.wait();
+      run = std::move(hedge->run);
+      fallbackError = hedge->error;
+    } else if (!confident && !cancellation.IsCancelled()) {
+      // The local pass beat the delay, so the fallback runs here without waiting for the timer.
+      try {
+        runFallback(fallbackSource.GetToken(), run);
+      } catch (...) {
+        fallbackError = std::current_exception();
+      }
+    }
+
+    if (!confident && run.started && !run.result.IsEmpty()) {
+      outcome.result = std::move(run.result);
+      outcome.escalated = true;
+    } else if (outcome.result.IsEmpty()) {
+      // Nothing local to keep: surface whichever error explains the missing text.
+      if (fallbackError) {
+        std::rethrow_exception(fallbackError);
+      }
+      if (localError) {
+        std::rethrow_exception(localError);
+      }
+    } else if (fallbackError) {
+      AF_WARN("OCR cascade: fallback failed, keeping the local result");
+    }
+    outcome.provisional = !confident && !outcome.escalated;
+
+    Record(outcome, run.hedged, localMs, run.ms, MillisecondsSince(begin));
+    return outcome;
+  }
+
+  CascadeStats OCRCascade::GetStats() const
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Stats;
+  }
+
+  void OCRCascade::Record(const Outcome& outcome, bool hedged, double localMs, double fallbackMs, double totalMs)
+  {
+    CascadeStats stats;
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      ++m_Stats.regions;
+      if (outcome.escalated) {
+        ++m_Stats.escalations;
+      }
+      if (hedged) {
+        ++m_Stats.hedgedStarts;
+        if (!outcome.escalated) {
+          ++m_Stats.wastedHedges;
+        }
+      }
+      m_Stats.totalLocalMs += localMs;
+      m_Stats.totalFallbackMs += fallbackMs;
+      m_Stats.totalMs += totalMs;
+      stats = m_Stats;
+    }
+
+    AF_INFO("OCR cascade: local confidence {:.0f}, {} in {:.0f} ms (local {:.0f} ms, fallback {:.0f} ms)",
+            outcome.localConfidence,
+            outcome.escalated ? "escalated" : "kept local",
+            totalMs,
+            localMs,
+            fallbackMs);
+    AF_INFO("OCR cascade: {} of {} regions escalated ({:.0f}%), {} hedged ({} wasted), average {:.0f} ms",
+            stats.escalations,
+            stats.regions,
+            stats.EscalationRate() * 100.0,
+            stats.hedgedStarts,
+            stats.wastedHedges,
+            stats.AverageMs());
+  }
+
+} // namespace Image2Card::OCR
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+
+#include "core/CancellationToken.h"
+#include "ocr/OCRResult.h"
+
+namespace Image2Card::OCR
+{
+
+  struct CascadeOptions
+  {
+    float minConfidence = 70.0f;            // Mean word confidence (0-100) the local result needs to be kept
+    std::chrono::milliseconds hedgeDelay{0}; // Start the fallback this long into local OCR; 0 waits for it
+  };
+
+  struct CascadeStats
+  {
+    uint64_t regions = 0;
+    uint64_t escalations = 0;   // Regions answered by the fallback
+    uint64_t hedgedStarts = 0;  // Fallback requests started before local OCR finished
+    uint64_t wastedHedges = 0;  // Hedged requests abandoned because the local result was good enough
+    double totalLocalMs = 0.0;
+    double totalFallbackMs = 0.0;
+    double totalMs = 0.0;
+
+    [[nodiscard]] double EscalationRate() const { return regions > 0 ? (double) escalations / regions : 0.0; }
+    [[nodiscard]] double AverageMs() const { return regions > 0 ? totalMs / regions : 0.0; }
+  };
+
+  /**
+ * Runs a cheap local recognizer first and escalates to an expensive fallback
+ * (a vision model) only when the local result's mean word confidence is below
+ * a threshold. With a hedge delay the fallback is started once local OCR has
+ * taken that long, so a slow, uncertain local pass does not add its full
+ * latency in front of the fallback; it is cancelled if the local result turns
+ * out good enough. Keeps running escalation and latency statistics.
+ */
+  class OCRCascade
+  {
+public:
+
+    using Recognizer = std::function<OCRResult(const Core::CancellationToken&)>;
+
+    struct Outcome
+    {
+      OCRResult result;
+      float localConfidence = -1.0f;
+      bool escalated = false;
+      bool provisional = false; // Below the threshold but not escalated (the fallback failed or was cut short)
+    };
+
+    /**
+   * Recognize one region. Blocks until both recognizers that were started have returned.
+   * @param local Fast recognizer run on the calling thread
+   * @param fallback Recognizer used when the local result is not confident enough
+   * @throws Whatever fallback throws when there is no local text to fall back to
+   */
+    Outcome Recognize(const Recognizer& local,
+                      const Recognizer& fallback,
+                      const CascadeOptions& options,
+                      const Core::CancellationToken& cancellation);
+
+    [[nodiscard]] CascadeStats GetStats() const;
+
+private:
+
+    void Record(const Outcome& outcome, bool hedged, double localMs, double fallbackMs, double totalMs);
+
+    mutable std::mutex m_Mutex;
+    CascadeStats m_Stats;
+  };
+
+} // namespace Image2Card::OCR
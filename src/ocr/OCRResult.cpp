@@ -0,0 +1,161 @@
+#include "ocr/OCRResult.h"
+
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+
+namespace Image2Card::OCR
+{
+
+  namespace
+  {
+    size_t Utf8Length(unsigned char lead)
+    {
+      if (lead < 0x80)
+        return 1;
+      if ((lead >> 5) == 0x6)
+        return 2;
+      if ((lead >> 4) == 0xE)
+        return 3;
+      if ((lead >> 3) == 0x1E)
+        return 4;
+      return 1;
+    }
+
+    bool IsSentenceEnd(const std::string& c)
+    {
+      return c == "。" || c == "！" || c == "？" || c == "!" || c == "?" || c == "." || c == "…" || c == "．";
+    }
+
+    // Closing marks stay with the sentence they end (…。」 belongs to the quote).
+    bool IsCloser(const std::string& c)
+    {
+      return c == "」" || c == "』" || c == "）" || c == ")" || c == "\"" || c == "'" || c == "”" || c == "’";
+    }
+
+    std::string Trim(const std::string& text)
+    {
+      size_t begin = text.find_first_not_of(" \t\r\n");
+      if (begin == std::string::npos)
+        return "";
+      size_t end = text.find_last_not_of(" \t\r\n");
+      return text.substr(begin, end - begin + 1);
+    }
+  } // namespace
+
+  OCRResult OCRResult::FromText(const std::string& text, int width, int height)
+  {
+    OCRResult result;
+    OCRBlock block;
+    block.box = {0, 0, width, height};
+
+    std::istringstream stream(text);
+    std::string line;
+    while (std::getline(stream, line)) {
+      line = Trim(line);
+      if (!line.empty()) {
+        block.lines.push_back({line, block.box, -1.0f, {}});
+      }
+    }
+
+    if (!block.lines.empty()) {
+      result.blocks.push_back(std::move(block));
+    }
+    return result;
+  }
+
+  std::string OCRResult::Text() const
+  {
+    std::string text;
+    for (const auto& block : blocks) {
+      if (!text.empty()) {
+        text += "\n\n";
+      }
+      for (size_t i = 0; i < block.lines.size(); ++i) {
+        if (i > 0) {
+          text += '\n';
+        }
+        text += block.lines[i].text;
+      }
+    }
+    return text;
+  }
+
+  std::vector<std::string> OCRResult::Sentences() const
+  {
+    std::vector<std::string> sentences;
+    auto flush = [&sentences](std::string& sentence) {
+      sentence = Trim(sentence);
+      if (!sentence.empty()) {
+        sentences.push_back(sentence);
+      }
+      sentence.clear();
+    };
+
+    for (const auto& block : blocks) {
+      // Lines of a block are joined; only text with spaces between words needs one at the seam.
+      std::string joined;
+      for (const auto& line : block.lines) {
+        if (!joined.empty() && !line.text.empty() && std::isalnum((unsigned char) joined.back()) &&
+            std::isalnum((unsigned char) line.text.front()))
+        {
+          joined += ' ';
+        }
+        joined += line.text;
+      }
+
+      std::string sentence;
+      bool ended = false;
+      for (size_t i = 0; i < joined.size();) {
+        size_t length = std::min(Utf8Length((unsigned char) joined[i]), joined.size() - i);
+        std::string c = joined.substr(i, length);
+        i += length;
+
+        // A '.' followed by a digit is a decimal point, not the end of a sentence.
+        if (ended && c.size() == 1 && std::isdigit((unsigned char) c[0]) && sentence.back() == '.') {
+          ended = false;
+        }
+        if (ended && !IsSentenceEnd(c) && !IsCloser(c)) {
+          flush(sentence);
+          ended = false;
+        }
+        sentence += c;
+        ended = ended || IsSentenceEnd(c);
+      }
+      flush(sentence);
+    }
+    return sentences;
+  }
+
+  const OCRWord* OCRResult::WordAt(int x, int y) const
+  {
+    for (const auto& block : blocks) {
+      for (const auto& line : block.lines) {
+        for (const auto& word : line.words) {
+          if (x >= word.box.x && x < word.box.Right() && y >= word.box.y && y < word.box.Bottom()) {
+            return &word;
+          }
+        }
+      }
+    }
+    return nullptr;
+  }
+
+  float OCRResult::MeanWordConfidence() const
+  {
+    double sum = 0.0;
+    size_t count = 0;
+    for (const auto& block : blocks) {
+      for (const auto& line : block.lines) {
+        for (const auto& word : line.words) {
+          if (word.confidence >= 0.0f) {
+            sum += word.confidence;
+            ++count;
+          }
+        }
+      }
+    }
+    return count > 0 ? static_cast<float>(sum / count) : -1.0f;
+  }
+
+} // namespace Image2Card::OCR
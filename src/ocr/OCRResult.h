@@ -0,0 +1,82 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "utils/Rect.h"
+
+namespace Image2Card::OCR
+{
+
+  // Boxes are in pixels of the image passed to the provider. Confidence is 0-100,
+  // or negative when the provider does not report one.
+
+  struct OCRSymbol
+  {
+    std::string text;
+    Utils::Rect box;
+    float confidence = -1.0f;
+  };
+
+  struct OCRWord
+  {
+    std::string text;
+    Utils::Rect box;
+    float confidence = -1.0f;
+    std::vector<OCRSymbol> symbols;
+  };
+
+  struct OCRLine
+  {
+    std::string text;
+    Utils::Rect box;
+    float confidence = -1.0f;
+    std::vector<OCRWord> words;
+  };
+
+  struct OCRBlock
+  {
+    Utils::Rect box;
+    float confidence = -1.0f;
+    std::vector<OCRLine> lines;
+  };
+
+  /**
+ * Recognized text with its layout: blocks (paragraphs or speech bubbles), lines,
+ * words and symbols, each with a bounding box.
+ */
+  struct OCRResult
+  {
+    std::vector<OCRBlock> blocks;
+
+    /**
+   * Wrap plain text from a provider without layout information. Each line of text
+   * becomes a line covering the whole image.
+   */
+    static OCRResult FromText(const std::string& text, int width, int height);
+
+    /**
+   * All text, lines separated by '\n' and blocks by a blank line.
+   */
+    [[nodiscard]] std::string Text() const;
+
+    /**
+   * Text split into sentences: blocks never share a sentence, and within a block
+   * lines are joined and split after sentence-ending punctuation.
+   */
+    [[nodiscard]] std::vector<std::string> Sentences() const;
+
+    /**
+   * The word whose box contains the point, or nullptr.
+   */
+    [[nodiscard]] const OCRWord* WordAt(int x, int y) const;
+
+    /**
+   * Mean confidence of the words that report one, or a negative value if none do.
+   */
+    [[nodiscard]] float MeanWordConfidence() const;
+
+    [[nodiscard]] bool IsEmpty() const { return blocks.empty(); }
+  };
+
+} // namespace Image2Card::OCR
@@ -0,0 +1,153 @@
+#include "ocr/OrientationDetector.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "core/Logger.h"
+#include "core/Trace.h"
+#include "ocr/ImagePreprocessor.h"
+
+namespace Image2Card::OCR
+{
+
+  namespace
+  {
+    // Profiles are computed on a downscaled copy; text stays a few pixels tall at this size.
+    constexpr int MaxAnalysisSize = 400;
+
+    // Runs along one axis shorter than this fraction of the single run across it are
+    // characters of separate columns (or lines), not characters of one line.
+    constexpr double CharacterRatio = 0.6;
+
+    struct AxisProfile
+    {
+      int runs = 0;
+      double medianRun = 0.0;
+      double medianGap = 0.0;
+      int extent = 0; // From the first to the last inked entry
+    };
+
+    double Median(std::vector<int>& values)
+    {
+      if (values.empty()) {
+        return 0.0;
+      }
+      std::nth_element(values.begin(), values.begin() + values.size() / 2, values.end());
+      return values[values.size() / 2];
+    }
+
+    AxisProfile Analyze(const std::vector<int>& profile, int span)
+    {
+      // An entry is inked if at least 1% of it is ink; shorter runs than 2px are noise.
+      int minInk = std::max(1, span / 100);
+      std::vector<int> runs;
+      std::vector<int> gaps;
+      int first = -1;
+      int previousEnd = -1;
+      int start = -1;
+      for (int i = 0; i <= (int) profile.size(); ++i) {
+        bool inked = i < (int) profile.size() && profile[i] >= minInk;
+        if (inked && start < 0) {
+          start = i;
+        } else if (!inked && start >= 0) {
+          if (i - start >= 2) {
+            if (previousEnd >= 0) {
+              gaps.push_back(start - previousEnd);
+            } else {
+              first = start;
+            }
+            runs.push_back(i - start);
+            previousEnd = i;
+          }
+          start = -1;
+        }
+      }
+
+      AxisProfile result;
+      result.runs = (int) runs.size();
+      result.extent = first < 0 ? 0 : previousEnd - first;
+      result.medianRun = Median(runs);
+      result.medianGap = Median(gaps);
+      return result;
+    }
+  } // namespace
+
+  OrientationEstimate OrientationDetector::Detect(const Utils::ImageView& image)
+  {
+    AF_TRACE_SCOPE("ocr", "Detect orientation");
+    Utils::ImageBuffer gray = ImagePreprocessor::ToGrayscale(image);
+    if (gray.IsEmpty()) {
+      return {};
+    }
+
+    int longest = std::max(gray.width, gray.height);
+    if (longest > MaxAnalysisSize) {
+      Utils::ImageBuffer scaled = ImagePreprocessor::Rescale(gray, (double) MaxAnalysisSize / longest);
+      if (!scaled.IsEmpty()) {
+        gray = std::move(scaled);
+      }
+    }
+
+    ImagePreprocessor::StretchContrast(gray);
+    if (ImagePreprocessor::IsLightOnDark(gray)) {
+      ImagePreprocessor::Invert(gray);
+    }
+
+    int threshold = ImagePreprocessor::InkThreshold(gray);
+    std::vector<int> rowInk(gray.height, 0);
+    std::vector<int> columnInk(gray.width, 0);
+    for (int y = 0; y < gray.height; ++y) {
+      const unsigned char* row = gray.Row(y);
+      for (int x = 0; x < gray.width; ++x) {
+        if (row[x] <= threshold) {
+          ++rowInk[y];
+          ++columnInk[x];
+        }
+      }
+    }
+
+    AxisProfile rows = Analyze(rowInk, gray.width);
+    AxisProfile columns = Analyze(columnInk, gray.height);
+
+    OrientationEstimate estimate;
+    if (rows.runs == 0 || columns.runs == 0) {
+      return estimate;
+    }
+
+    if (rows.runs >= 2 && columns.runs >= 2) {
+      // Gaps between lines are wider, relative to the text, than gaps between characters.
+      double rowScore = rows.medianGap / std::max(1.0, rows.medianRun);
+      double columnScore = columns.medianGap / std::max(1.0, columns.medianRun);
+      estimate.vertical = columnScore > rowScore;
+      double larger = std::max(rowScore, columnScore);
+      estimate.confidence = larger > 0.0 ? (float) (std::abs(rowScore - columnScore) / larger) : 0.0f;
+    } else if (rows.runs == 1 && columns.runs >= 2) {
+      // One band of rows: one line of characters, or columns of several characters each.
+      double ratio = columns.medianRun / std::max(1, rows.extent);
+      estimate.vertical = ratio < CharacterRatio;
+      estimate.confidence = (float) std::min(1.0, std::abs(ratio - CharacterRatio) / CharacterRatio);
+    } else if (columns.runs == 1 && rows.runs >= 2) {
+      double ratio = rows.medianRun / std::max(1, columns.extent);
+      estimate.vertical = ratio >= CharacterRatio;
+      estimate.confidence = (float) std::min(1.0, std::abs(ratio - CharacterRatio) / CharacterRatio);
+    } else {
+      // A single blob: only its shape is left to go by.
+      double aspect = (double) rows.extent / std::max(1, columns.extent);
+      estimate.vertical = aspect > 1.0;
+      estimate.confidence = (float) std::min(0.5, std::abs(std::log(aspect)) / 4.0);
+    }
+
+    AF_DEBUG("Orientation: {} (confidence {:.2f}, rows {}x{:.0f}/{:.0f}, columns {}x{:.0f}/{:.0f})",
+             estimate.vertical ? "vertical" : "horizontal",
+             estimate.confidence,
+             rows.runs,
+             rows.medianRun,
+             rows.medianGap,
+             columns.runs,
+             columns.medianRun,
+             columns.medianGap);
+    return estimate;
+  }
+
+} // namespace Image2Card::OCR
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "utils/ImageView.h"
+
+namespace Image2Card::OCR
+{
+
+  struct OrientationEstimate
+  {
+    bool vertical = false;
+    float confidence = 0.0f; // 0 = a guess, 1 = unambiguous
+  };
+
+  /**
+ * Guesses whether a crop holds horizontal or vertical text from its ink
+ * projection profiles, in a few milliseconds and without running OCR.
+ * Lines are separated by wider gaps than the characters inside a line, so the
+ * axis whose profile has the larger gap-to-run ratio runs across the lines.
+ * A single line or column has no gaps across it; there the size of the runs
+ * along it tells a line of characters from a block of columns.
+ */
+  class OrientationDetector
+  {
+public:
+
+    [[nodiscard]] static OrientationEstimate Detect(const Utils::ImageView& image);
+  };
+
+} // namespace Image2Card::OCR
@@ -0,0 +1,128 @@
+#include "ocr/TesseractEnginePool.h"
+
+#include <algorithm>
+#include <tesseract/baseapi.h>
+#include <thread>
+
+#include "core/Logger.h"
+#include "core/Trace.h"
+
+namespace Image2Card::OCR
+{
+
+  TesseractEnginePool::Lease::Lease(TesseractEnginePool* pool, std::unique_ptr<tesseract::TessBaseAPI> engine)
+      : m_Pool(pool)
+      , m_Engine(std::move(engine))
+  {}
+
+  TesseractEnginePool::Lease::~Lease()
+  {
+    Release();
+  }
+
+  TesseractEnginePool::Lease::Lease(Lease&& other) noexcept
+      : m_Pool(other.m_Pool)
+      , m_Engine(std::move(other.m_Engine))
+  {
+    other.m_Pool = nullptr;
+  }
+
+  TesseractEnginePool::Lease& TesseractEnginePool::Lease::operator=(Lease&& other) noexcept
+  {
+    if (this != &other) {
+      Release();
+      m_Pool = other.m_Pool;
+      m_Engine = std::move(other.m_Engine);
+      other.m_Pool = nullptr;
+    }
+    return *this;
+  }
+
+  void TesseractEnginePool::Lease::Release()
+  {
+    if (m_Pool && m_Engine) {
+      m_Pool->Return(std::move(m_Engine));
+    }
+    m_Pool = nullptr;
+  }
+
+  TesseractEnginePool::TesseractEnginePool(std::string tessDataPath, std::string language, size_t capacity)
+      : m_TessDataPath(std::move(tessDataPath))
+      , m_Language(std::move(language))
+      , m_Capacity(capacity > 0 ? capacity : std::max(1u, std::thread::hardware_concurrency() / 2))
+  {}
+
+  TesseractEnginePool::~TesseractEnginePool()
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    for (auto& engine : m_Idle) {
+      engine->End();
+    }
+  }
+
+  bool TesseractEnginePool::Initialize()
+  {
+    auto lease = Acquire();
+    if (!lease) {
+      return false;
+    }
+    AF_INFO("Tesseract pool ready with language {} (up to {} engines)", m_Language, m_Capacity);
+    return true;
+  }
+
+  TesseractEnginePool::Lease TesseractEnginePool::Acquire()
+  {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    while (true) {
+      if (!m_Idle.empty()) {
+        auto engine = std::move(m_Idle.back());
+        m_Idle.pop_back();
+        return Lease(this, std::move(engine));
+      }
+
+      if (m_EngineCount < m_Capacity) {
+        ++m_EngineCount;
+        lock.unlock();
+
+        auto engine = CreateEngine();
+        if (!engine) {
+          lock.lock();
+          --m_EngineCount;
+          // A waiter may now create an engine in this one's place.
+          m_EngineReturned.notify_one();
+          return {};
+        }
+        return Lease(this, std::move(engine));
+      }
+
+      m_EngineReturned.wait(lock);
+    }
+  }
+
+  size_t TesseractEnginePool::GetEngineCount() const
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_EngineCount;
+  }
+
+  std::unique_ptr<tesseract::TessBaseAPI> TesseractEnginePool::CreateEngine() const
+  {
+    AF_TRACE_SCOPE("ocr", "Tesseract Init");
+    auto engine = std::make_unique<tesseract::TessBaseAPI>();
+    if (engine->Init(m_TessDataPath.c_str(), m_Language.c_str())) {
+      AF_ERROR("Could not initialize Tesseract with language: {} at path: {}", m_Language, m_TessDataPath);
+      return nullptr;
+    }
+    return engine;
+  }
+
+  void TesseractEnginePool::Return(std::unique_ptr<tesseract::TessBaseAPI> engine)
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      m_Idle.push_back(std::move(engine));
+    }
+    m_EngineReturned.notify_one();
+  }
+
+} // namespace Image2Card::OCR
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace tesseract
+{
+  class TessBaseAPI;
+}
+
+namespace Image2Card::OCR
+{
+
+  /**
+ * A bounded set of initialized TessBaseAPI engines shared between threads.
+ * A TessBaseAPI keeps per-recognition state and cannot be used from two threads
+ * at once, so each recognition checks an engine out and returns it afterwards.
+ * Engines are created on first demand, outside the pool lock, so concurrent
+ * checkouts initialize their engines in parallel and startup pays for one Init().
+ */
+  class TesseractEnginePool
+  {
+public:
+
+    /**
+   * Exclusive use of one engine; returns it to the pool when destroyed.
+   */
+    class Lease
+    {
+  public:
+
+      Lease() = default;
+      Lease(TesseractEnginePool* pool, std::unique_ptr<tesseract::TessBaseAPI> engine);
+      ~Lease();
+
+      Lease(Lease&& other) noexcept;
+      Lease& operator=(Lease&& other) noexcept;
+      Lease(const Lease&) = delete;
+      Lease& operator=(const Lease&) = delete;
+
+      tesseract::TessBaseAPI* operator->() const { return m_Engine.get(); }
+      explicit operator bool() const { return m_Engine != nullptr; }
+
+  private:
+
+      void Release();
+
+      TesseractEnginePool* m_Pool = nullptr;
+      std::unique_ptr<tesseract::TessBaseAPI> m_Engine;
+    };
+
+    /**
+   * @param tessDataPath Directory holding the traineddata files
+   * @param language Tesseract language code (e.g. "jpn")
+   * @param capacity Maximum number of engines; 0 picks half the hardware threads
+   */
+    TesseractEnginePool(std::string tessDataPath, std::string language, size_t capacity = 0);
+    ~TesseractEnginePool();
+
+    TesseractEnginePool(const TesseractEnginePool&) = delete;
+    TesseractEnginePool& operator=(const TesseractEnginePool&) = delete;
+
+    /**
+   * Create the first engine, which also validates the data path and language.
+   * @return true if the engine initialized
+   */
+    bool Initialize();
+
+    /**
+   * Check out an engine, creating one if none is idle and the pool is below capacity,
+   * otherwise waiting for one to be returned.
+   * @return The lease, or an empty lease if a new engine failed to initialize
+   */
+    Lease Acquire();
+
+    [[nodiscard]] size_t GetCapacity() const { return m_Capacity; }
+    [[nodiscard]] size_t GetEngineCount() const;
+
+private:
+
+    std::unique_ptr<tesseract::TessBaseAPI> CreateEngine() const;
+    void Return(std::unique_ptr<tesseract::TessBaseAPI> engine);
+
+    std::string m_TessDataPath;
+    std::string m_Language;
+    size_t m_Capacity;
+
+    mutable std::mutex m_Mutex;
+    std::condition_variable m_EngineReturned;
+    std::vector<std::unique_ptr<tesseract::TessBaseAPI>> m_Idle;
+    size_t m_EngineCount = 0; // Engines created or being created, idle or checked out
+  };
+
+} // namespace Image2Card::OCR
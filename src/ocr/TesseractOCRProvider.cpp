@@ -1,37 +1,35 @@
 #include "ocr/TesseractOCRProvider.h"
 
 #include <allheaders.h>
+#include <cctype>
+#include <cmath>
 #include <cstring>
+#include <memory>
 #include <tesseract/baseapi.h>
+#include <tesseract/resultiterator.h>
 
 #include "core/Logger.h"
+#include "core/Trace.h"
+#include "ocr/ImagePreprocessor.h"
+#include "ocr/OrientationDetector.h"
+#include "stb_image.h"
 
 namespace Image2Card::OCR
 {
 
-  TesseractOCRProvider::TesseractOCRProvider()
-      : m_TessAPI(std::make_unique<tesseract::TessBaseAPI>())
+  TesseractOCRProvider::TesseractOCRProvider(size_t engineCount)
+      : m_EngineCount(engineCount)
       , m_IsInitialized(false)
-      , m_Orientation(TesseractOrientation::Horizontal)
   {}
 
-  TesseractOCRProvider::~TesseractOCRProvider()
-  {
-    if (m_TessAPI) {
-      m_TessAPI->End();
-    }
-  }
+  TesseractOCRProvider::~TesseractOCRProvider() = default;
 
   bool TesseractOCRProvider::Initialize(const std::string& tessDataPath, const std::string& language)
   {
-    if (!m_TessAPI) {
-      AF_ERROR("Tesseract API is null");
-      return false;
-    }
-
-    // Initialize tesseract-ocr with the specified language
-    if (m_TessAPI->Init(tessDataPath.c_str(), language.c_str())) {
-      AF_ERROR("Could not initialize Tesseract with language: {} at path: {}", language, tessDataPath);
+    // Only the first engine is created here; the rest are created when concurrent scans need them.
+    m_Pool = std::make_unique<TesseractEnginePool>(tessDataPath, language, m_EngineCount);
+    if (!m_Pool->Initialize()) {
+      m_Pool.reset();
       m_IsInitialized = false;
       return false;
     }
@@ -42,13 +40,10 @@ namespace Image2Card::OCR
     return true;
   }
 
-  void TesseractOCRProvider::SetOrientation(TesseractOrientation orientation)
-  {
-    m_Orientation = orientation;
-  }
-
-  std::string TesseractOCRProvider::ExtractTextFromImage(const std::vector<unsigned char>& imageBuffer)
+  std::string TesseractOCRProvider::ExtractTextFromImage(const std::vector<unsigned char>& imageBuffer,
+                                                         const TesseractOptions& options)
   {
+    AF_TRACE_SCOPE("ocr", "Tesseract OCR");
     if (!m_IsInitialized) {
       AF_ERROR("Tesseract is not initialized");
       return "";
@@ -59,6 +54,21 @@ namespace Image2Card::OCR
       return "";
     }
 
+    // Preprocessing and orientation detection work on pixels, so decode here and take the pixel path.
+    if (options.preprocess || options.orientation == TesseractOrientation::Auto) {
+      int width = 0, height = 0, channels = 0;
+      unsigned char* pixels =
+          stbi_load_from_memory(imageBuffer.data(), (int) imageBuffer.size(), &width, &height, &channels, 4);
+      if (!pixels) {
+        AF_ERROR("Failed to load image from buffer");
+        return "";
+      }
+      std::string result =
+          ExtractTextFromPixels({pixels, width, height, width * 4, Utils::PixelFormat::RGBA32}, options);
+      stbi_image_free(pixels);
+      return result;
+    }
+
     // Load image from memory using Leptonica
     Pix* image = pixReadMem(imageBuffer.data(), imageBuffer.size());
     if (!image) {
@@ -66,23 +76,192 @@ namespace Image2Card::OCR
       return "";
     }
 
+    auto engine = m_Pool->Acquire();
+    if (!engine) {
+      AF_ERROR("No Tesseract engine available");
+      pixDestroy(&image);
+      return "";
+    }
+
     // Clear previous recognition state to ensure clean OCR
-    m_TessAPI->Clear();
+    engine->Clear();
 
     // Set the image for OCR
-    m_TessAPI->SetImage(image);
+    engine->SetImage(image);
+    SetPageSegMode(engine, options.orientation == TesseractOrientation::Vertical);
+
+    std::string result = Recognize(engine);
+
+    // Clean up
+    pixDestroy(&image);
+    return result;
+  }
+
+  std::string TesseractOCRProvider::ExtractTextFromPixels(const Utils::ImageView& image,
+                                                          const TesseractOptions& options)
+  {
+    AF_TRACE_SCOPE("ocr", "Tesseract OCR");
+    if (!m_IsInitialized) {
+      AF_ERROR("Tesseract is not initialized");
+      return "";
+    }
+
+    if (image.IsEmpty()) {
+      AF_ERROR("Image is empty");
+      return "";
+    }
+
+    double scaleX = 1.0;
+    double scaleY = 1.0;
+    auto engine = PrepareEngine(image, options, scaleX, scaleY);
+    if (!engine) {
+      return "";
+    }
+    return Recognize(engine);
+  }
+
+  OCRResult TesseractOCRProvider::ExtractStructuredText(const Utils::ImageView& image, const TesseractOptions& options)
+  {
+    AF_TRACE_SCOPE("ocr", "Tesseract OCR (structured)");
+    if (!m_IsInitialized) {
+      AF_ERROR("Tesseract is not initialized");
+      return {};
+    }
+
+    if (image.IsEmpty()) {
+      AF_ERROR("Image is empty");
+      return {};
+    }
+
+    double scaleX = 1.0;
+    double scaleY = 1.0;
+    auto engine = PrepareEngine(image, options, scaleX, scaleY);
+    if (!engine) {
+      return {};
+    }
+
+    if (engine->Recognize(nullptr) != 0) {
+      AF_ERROR("Tesseract recognition failed");
+      return {};
+    }
+
+    std::unique_ptr<tesseract::ResultIterator> it(engine->GetIterator());
+    if (!it) {
+      return {};
+    }
+
+    // Boxes come back in the coordinates of the preprocessed image.
+    auto boxOf = [&](tesseract::PageIteratorLevel level) {
+      int left = 0, top = 0, right = 0, bottom = 0;
+      it->BoundingBox(level, &left, &top, &right, &bottom);
+      int x = static_cast<int>(std::lround(left * scaleX));
+      int y = static_cast<int>(std::lround(top * scaleY));
+      return Utils::Rect{x,
+                         y,
+                         static_cast<int>(std::lround(right * scaleX)) - x,
+                         static_cast<int>(std::lround(bottom * scaleY)) - y};
+    };
+    auto textOf = [&](tesseract::PageIteratorLevel level) {
+      std::unique_ptr<char[]> text(it->GetUTF8Text(level));
+      std::string result = text ? text.get() : "";
+      while (!result.empty() && std::isspace(static_cast<unsigned char>(result.back()))) {
+        result.pop_back();
+      }
+      return result;
+    };
+
+    OCRResult result;
+    do {
+      if (it->Empty(tesseract::RIL_SYMBOL)) {
+        continue;
+      }
+      if (result.blocks.empty() || it->IsAtBeginningOf(tesseract::RIL_BLOCK)) {
+        result.blocks.push_back({boxOf(tesseract::RIL_BLOCK), it->Confidence(tesseract::RIL_BLOCK), {}});
+      }
+      auto& block = result.blocks.back();
+      if (block.lines.empty() || it->IsAtBeginningOf(tesseract::RIL_TEXTLINE)) {
+        block.lines.push_back({textOf(tesseract::RIL_TEXTLINE),
+                               boxOf(tesseract::RIL_TEXTLINE),
+                               it->Confidence(tesseract::RIL_TEXTLINE),
+                               {}});
+      }
+      auto& line = block.lines.back();
+      if (line.words.empty() || it->IsAtBeginningOf(tesseract::RIL_WORD)) {
+        line.words.push_back(
+            {textOf(tesseract::RIL_WORD), boxOf(tesseract::RIL_WORD), it->Confidence(tesseract::RIL_WORD), {}});
+      }
+      line.words.back().symbols.push_back(
+          {textOf(tesseract::RIL_SYMBOL), boxOf(tesseract::RIL_SYMBOL), it->Confidence(tesseract::RIL_SYMBOL)});
+    } while (it->Next(tesseract::RIL_SYMBOL));
+
+    AF_INFO("Tesseract found {} blocks", result.blocks.size());
+    return result;
+  }
 
-    // Set page segmentation mode based on orientation
-    if (m_Orientation == TesseractOrientation::Vertical) {
+  TesseractEnginePool::Lease
+  TesseractOCRProvider::PrepareEngine(const Utils::ImageView& image,
+                                      const TesseractOptions& options,
+                                      double& scaleX,
+                                      double& scaleY)
+  {
+    // Done before checking out an engine so the engine is held only while recognizing.
+    bool vertical = false;
+    switch (options.orientation) {
+      case TesseractOrientation::Horizontal:
+        break;
+      case TesseractOrientation::Vertical:
+        vertical = true;
+        break;
+      case TesseractOrientation::Auto: {
+        OrientationEstimate estimate = OrientationDetector::Detect(image);
+        vertical = estimate.vertical;
+        AF_INFO("Detected {} text (confidence {:.2f})", vertical ? "vertical" : "horizontal", estimate.confidence);
+        break;
+      }
+    }
+
+    Utils::ImageBuffer prepared;
+    Utils::ImageView input = image;
+    if (options.preprocess) {
+      PreprocessOptions preprocessOptions;
+      preprocessOptions.verticalText = vertical;
+      prepared = ImagePreprocessor::Run(image, preprocessOptions);
+      if (!prepared.IsEmpty()) {
+        input = prepared.View();
+      }
+    }
+    scaleX = static_cast<double>(image.width) / input.width;
+    scaleY = static_cast<double>(image.height) / input.height;
+
+    auto engine = m_Pool->Acquire();
+    if (!engine) {
+      AF_ERROR("No Tesseract engine available");
+      return engine;
+    }
+
+    engine->Clear();
+
+    // Tesseract copies the pixels, so no PNG round trip is needed
+    engine->SetImage(input.data, input.width, input.height, Utils::BytesPerPixel(input.format), input.stride);
+    SetPageSegMode(engine, vertical);
+    return engine;
+  }
+
+  void TesseractOCRProvider::SetPageSegMode(TesseractEnginePool::Lease& engine, bool vertical)
+  {
+    if (vertical) {
       // PSM_SINGLE_BLOCK_VERT_TEXT (5) for vertical text
-      m_TessAPI->SetPageSegMode(tesseract::PSM_SINGLE_BLOCK_VERT_TEXT);
+      engine->SetPageSegMode(tesseract::PSM_SINGLE_BLOCK_VERT_TEXT);
     } else {
       // PSM_AUTO (3) for automatic detection, good for horizontal text
-      m_TessAPI->SetPageSegMode(tesseract::PSM_AUTO);
+      engine->SetPageSegMode(tesseract::PSM_AUTO);
     }
+  }
 
+  std::string TesseractOCRProvider::Recognize(TesseractEnginePool::Lease& engine)
+  {
     // Perform OCR
-    char* outText = m_TessAPI->GetUTF8Text();
+    char* outText = engine->GetUTF8Text();
 
     std::string result;
     if (outText) {
@@ -92,11 +271,6 @@ namespace Image2Card::OCR
       AF_WARN("Tesseract OCR returned null text");
     }
 
-    // Clean up
-    if (image) {
-      pixDestroy(&image);
-    }
-
     AF_INFO("Tesseract OCR extracted {} characters", result.length());
     return result;
   }
@@ -1,33 +1,58 @@
 #pragma once
 
+#include <cstddef>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include "ocr/IOCRProvider.h"
+#include "ocr/TesseractEnginePool.h"
 
 // Forward declare Pix struct from Leptonica
 struct Pix;
 
-namespace tesseract
-{
-  class TessBaseAPI;
-}
-
 namespace Image2Card::OCR
 {
 
   enum class TesseractOrientation
   {
     Horizontal,
-    Vertical
+    Vertical,
+    Auto // Detected per image with OrientationDetector
+  };
+
+  /**
+ * Map a configured orientation ("horizontal", "vertical" or "auto") to the enum.
+ */
+  inline TesseractOrientation ParseTesseractOrientation(const std::string& value)
+  {
+    if (value == "vertical") {
+      return TesseractOrientation::Vertical;
+    }
+    if (value == "auto") {
+      return TesseractOrientation::Auto;
+    }
+    return TesseractOrientation::Horizontal;
+  }
+
+  /**
+ * Settings of one recognition call. They are passed per call rather than
+ * stored in the provider, so concurrent scans cannot change each other's.
+ */
+  struct TesseractOptions
+  {
+    TesseractOrientation orientation = TesseractOrientation::Horizontal;
+    bool preprocess = true; // Clean up the image with ImagePreprocessor before recognition
   };
 
   class TesseractOCRProvider : public IOCRProvider
   {
 public:
 
-    TesseractOCRProvider();
+    /**
+   * @param engineCount Images recognized concurrently; 0 picks half the hardware threads
+   */
+    explicit TesseractOCRProvider(size_t engineCount = 0);
     ~TesseractOCRProvider();
 
     TesseractOCRProvider(const TesseractOCRProvider&) = delete;
@@ -35,20 +60,48 @@ public:
 
     bool Initialize(const std::string& tessDataPath, const std::string& language);
 
-    void SetOrientation(TesseractOrientation orientation);
-    TesseractOrientation GetOrientation() const { return m_Orientation; }
-
     std::string GetName() const override { return "Tesseract (Local)"; }
 
-    std::string ExtractTextFromImage(const std::vector<unsigned char>& imageBuffer) override;
+    // The IOCRProvider entry points use the default options.
+    std::string ExtractTextFromImage(const std::vector<unsigned char>& imageBuffer) override
+    {
+      return ExtractTextFromImage(imageBuffer, TesseractOptions());
+    }
+    std::string ExtractTextFromPixels(const Utils::ImageView& image) override
+    {
+      return ExtractTextFromPixels(image, TesseractOptions());
+    }
+    OCRResult ExtractStructuredText(const Utils::ImageView& image) override
+    {
+      return ExtractStructuredText(image, TesseractOptions());
+    }
+
+    std::string ExtractTextFromImage(const std::vector<unsigned char>& imageBuffer, const TesseractOptions& options);
+    std::string ExtractTextFromPixels(const Utils::ImageView& image, const TesseractOptions& options);
+    OCRResult ExtractStructuredText(const Utils::ImageView& image, const TesseractOptions& options);
 
     bool IsInitialized() const override { return m_IsInitialized; }
 
 private:
 
-    std::unique_ptr<tesseract::TessBaseAPI> m_TessAPI;
+    /**
+   * Resolve the orientation, preprocess the image if enabled, check out an engine
+   * and give it the image with the matching page segmentation mode.
+   * @param scaleX Set to the factor mapping engine x coordinates back to the image
+   * @param scaleY Set to the factor mapping engine y coordinates back to the image
+   * @return The engine, or an empty lease on failure
+   */
+    TesseractEnginePool::Lease
+    PrepareEngine(const Utils::ImageView& image, const TesseractOptions& options, double& scaleX, double& scaleY);
+
+    static void SetPageSegMode(TesseractEnginePool::Lease& engine, bool vertical);
+
+    // Runs recognition on an engine whose image and page segmentation mode are set.
+    std::string Recognize(TesseractEnginePool::Lease& engine);
+
+    size_t m_EngineCount;
+    std::unique_ptr<TesseractEnginePool> m_Pool;
     bool m_IsInitialized;
-    TesseractOrientation m_Orientation;
   };
 
 } // namespace Image2Card::OCR
\ No newline at end of file
@@ -0,0 +1,244 @@
+#include "ocr/TextRegionDetector.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "core/Logger.h"
+#include "core/Trace.h"
+#include "ocr/ImagePreprocessor.h"
+
+namespace Image2Card::OCR
+{
+
+  namespace
+  {
+    // Pages are analysed at most this large; small furigana may be lost, bubble text is not.
+    constexpr int MaxAnalysisSize = 1600;
+
+    // Characters merge into one block when they are closer than this many character sizes.
+    constexpr double GroupingDistance = 0.8;
+
+    constexpr int MinCharacters = 2;
+
+    // Text sits on a light background; denser blocks are artwork.
+    constexpr double MaxBlockInk = 0.45;
+
+    struct Component
+    {
+      int minX = 0;
+      int minY = 0;
+      int maxX = 0;
+      int maxY = 0;
+      int pixels = 0;
+
+      [[nodiscard]] int Width() const { return maxX - minX + 1; }
+      [[nodiscard]] int Height() const { return maxY - minY + 1; }
+    };
+
+    // Labels the 8-connected set pixels of mask; labels holds the component index or -1.
+    std::vector<Component>
+    LabelComponents(const std::vector<unsigned char>& mask, int width, int height, std::vector<int>& labels)
+    {
+      labels.assign(mask.size(), -1);
+      std::vector<Component> components;
+      std::vector<int> stack;
+      for (int start = 0; start < (int) mask.size(); ++start) {
+        if (!mask[start] || labels[start] >= 0) {
+          continue;
+        }
+
+        int id = (int) components.size();
+        Component component{start % width, start / width, start % width, start / width, 0};
+        labels[start] = id;
+        stack.push_back(start);
+        while (!stack.empty()) {
+          int index = stack.back();
+          stack.pop_back();
+          int x = index % width;
+          int y = index / width;
+          component.minX = std::min(component.minX, x);
+          component.maxX = std::max(component.maxX, x);
+          component.minY = std::min(component.minY, y);
+          component.maxY = std::max(component.maxY, y);
+          ++component.pixels;
+
+          for (int ny = std::max(0, y - 1); ny <= std::min(height - 1, y + 1); ++ny) {
+            for (int nx = std::max(0, x - 1); nx <= std::min(width - 1, x + 1); ++nx) {
+              int neighbour = ny * width + nx;
+              if (mask[neighbour] && labels[neighbour] < 0) {
+                labels[neighbour] = id;
+                stack.push_back(neighbour);
+              }
+            }
+          }
+        }
+        components.push_back(component);
+      }
+      return components;
+    }
+
+    // Dilation with a (2 * radius + 1) square kernel, done as a row pass and a column pass over prefix sums.
+    std::vector<unsigned char> Dilate(const std::vector<unsigned char>& mask, int width, int height, int radius)
+    {
+      std::vector<unsigned char> rows(mask.size(), 0);
+      std::vector<unsigned char> result(mask.size(), 0);
+      std::vector<int> prefix((size_t) std::max(width, height) + 1, 0);
+
+      for (int y = 0; y < height; ++y) {
+        const unsigned char* row = mask.data() + (size_t) y * width;
+        for (int x = 0; x < width; ++x) {
+          prefix[x + 1] = prefix[x] + (row[x] ? 1 : 0);
+        }
+        for (int x = 0; x < width; ++x) {
+          int low = std::max(0, x - radius);
+          int high = std::min(width - 1, x + radius);
+          rows[(size_t) y * width + x] = prefix[high + 1] > prefix[low];
+        }
+      }
+
+      for (int x = 0; x < width; ++x) {
+        for (int y = 0; y < height; ++y) {
+          prefix[y + 1] = prefix[y] + (rows[(size_t) y * width + x] ? 1 : 0);
+        }
+        for (int y = 0; y < height; ++y) {
+          int low = std::max(0, y - radius);
+          int high = std::min(height - 1, y + radius);
+          result[(size_t) y * width + x] = prefix[high + 1] > prefix[low];
+        }
+      }
+      return result;
+    }
+  } // namespace
+
+  std::vector<Utils::Rect> TextRegionDetector::Detect(const Utils::ImageView& image)
+  {
+    AF_TRACE_SCOPE("ocr", "Detect text regions");
+    Utils::ImageBuffer gray = ImagePreprocessor::ToGrayscale(image);
+    if (gray.IsEmpty()) {
+      return {};
+    }
+
+    double scale = 1.0;
+    int longest = std::max(gray.width, gray.height);
+    if (longest > MaxAnalysisSize) {
+      Utils::ImageBuffer scaled = ImagePreprocessor::Rescale(gray, (double) MaxAnalysisSize / longest);
+      if (!scaled.IsEmpty()) {
+        scale = (double) scaled.width / gray.width;
+        gray = std::move(scaled);
+        longest = std::max(gray.width, gray.height);
+      }
+    }
+    if (ImagePreprocessor::IsLightOnDark(gray)) {
+      ImagePreprocessor::Invert(gray);
+    }
+
+    int width = gray.width;
+    int height = gray.height;
+    int threshold = ImagePreprocessor::InkThreshold(gray);
+    std::vector<unsigned char> ink((size_t) width * height);
+    for (int y = 0; y < height; ++y) {
+      const unsigned char* row = gray.Row(y);
+      for (int x = 0; x < width; ++x) {
+        ink[(size_t) y * width + x] = row[x] <= threshold;
+      }
+    }
+
+    std::vector<int> labels;
+    std::vector<Component> components = LabelComponents(ink, width, height, labels);
+
+    // Characters are neither specks nor panel-sized; solid blocks and long rules are not text either.
+    int minSize = std::max(3, longest / 300);
+    int maxSize = std::max(minSize + 1, longest / 10);
+    std::vector<Component> characters;
+    for (const Component& component : components) {
+      int size = std::max(component.Width(), component.Height());
+      int thickness = std::min(component.Width(), component.Height());
+      if (size < minSize || size > maxSize || size > thickness * 10) {
+        continue;
+      }
+      double fill = (double) component.pixels / ((double) component.Width() * component.Height());
+      if (thickness > minSize * 2 && fill > 0.85) {
+        continue;
+      }
+      characters.push_back(component);
+    }
+    if ((int) characters.size() < MinCharacters) {
+      return {};
+    }
+
+    std::vector<int> sizes;
+    sizes.reserve(characters.size());
+    for (const Component& character : characters) {
+      sizes.push_back(std::max(character.Width(), character.Height()));
+    }
+    std::nth_element(sizes.begin(), sizes.begin() + sizes.size() / 2, sizes.end());
+    int characterSize = sizes[sizes.size() / 2];
+
+    // Character boxes are filled in and grown, so neighbouring characters touch and label as one block.
+    std::vector<unsigned char> boxes((size_t) width * height, 0);
+    for (const Component& character : characters) {
+      for (int y = character.minY; y <= character.maxY; ++y) {
+        std::fill_n(boxes.begin() + (size_t) y * width + character.minX, character.Width(), 1);
+      }
+    }
+    int radius = std::max(1, (int) std::lround(characterSize * GroupingDistance / 2.0));
+    std::vector<int> blockLabels;
+    std::vector<Component> blocks = LabelComponents(Dilate(boxes, width, height, radius), width, height, blockLabels);
+
+    // Blocks are rebuilt from their characters so the dilation margin is not part of the box.
+    std::vector<Component> extents(blocks.size());
+    std::vector<int> counts(blocks.size(), 0);
+    for (const Component& character : characters) {
+      int block = blockLabels[(size_t) character.minY * width + character.minX];
+      Component& extent = extents[block];
+      if (counts[block]++ == 0) {
+        extent = character;
+      } else {
+        extent.minX = std::min(extent.minX, character.minX);
+        extent.minY = std::min(extent.minY, character.minY);
+        extent.maxX = std::max(extent.maxX, character.maxX);
+        extent.maxY = std::max(extent.maxY, character.maxY);
+      }
+    }
+
+    std::vector<Utils::Rect> regions;
+    int margin = std::max(2, characterSize / 3);
+    for (size_t i = 0; i < extents.size(); ++i) {
+      if (counts[i] < MinCharacters) {
+        continue;
+      }
+
+      const Component& extent = extents[i];
+      if ((double) extent.Width() * extent.Height() > (double) width * height * 0.5) {
+        continue;
+      }
+      int inked = 0;
+      for (int y = extent.minY; y <= extent.maxY; ++y) {
+        const unsigned char* row = ink.data() + (size_t) y * width;
+        inked += (int) std::count(row + extent.minX, row + extent.maxX + 1, 1);
+      }
+      if ((double) inked / ((double) extent.Width() * extent.Height()) > MaxBlockInk) {
+        continue;
+      }
+
+      int x0 = std::max(0, extent.minX - margin);
+      int y0 = std::max(0, extent.minY - margin);
+      int x1 = std::min(width, extent.maxX + 1 + margin);
+      int y1 = std::min(height, extent.maxY + 1 + margin);
+      Utils::Rect region;
+      region.x = (int) std::floor(x0 / scale);
+      region.y = (int) std::floor(y0 / scale);
+      region.width = std::min(image.width, (int) std::ceil(x1 / scale)) - region.x;
+      region.height = std::min(image.height, (int) std::ceil(y1 / scale)) - region.y;
+      regions.push_back(region);
+    }
+
+    AF_DEBUG("Text regions: {} found from {} characters of {} components (character size {}px)",
+             regions.size(),
+             characters.size(),
+             components.size(),
+             characterSize);
+    return regions;
+  }
+
+} // namespace Image2Card::OCR
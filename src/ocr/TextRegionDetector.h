@@ -0,0 +1,29 @@
+#pragma once
+
+#include <vector>
+
+#include "utils/ImageView.h"
+#include "utils/Rect.h"
+
+namespace Image2Card::OCR
+{
+
+  /**
+ * Finds blocks of text (speech bubbles, captions) on a whole page without running OCR.
+ * Ink is split into connected components, character-sized components are kept,
+ * and a morphological dilation merges characters that sit closer together than
+ * about one character into a block. Blocks with too few characters or without a
+ * light background around them (screen tones, hatching) are dropped.
+ */
+  class TextRegionDetector
+  {
+public:
+
+    /**
+   * @param image Page to search
+   * @return Text blocks in image pixels, in no particular order (see Utils::ReadingOrder)
+   */
+    [[nodiscard]] static std::vector<Utils::Rect> Detect(const Utils::ImageView& image);
+  };
+
+} // namespace Image2Card::OCR
@@ -0,0 +1,312 @@
+#include "pipeline/CardPipeline.h"
+
+#include <httplib.h>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+#include "ai/IAudioAIProvider.h"
+#include "ai/ITextAIProvider.h"
+#include "core/Logger.h"
+#include "core/Readiness.h"
+#include "core/Trace.h"
+#include "language/ILanguage.h"
+#include "language/analyzer/SentenceAnalyzer.h"
+#include "language/audio/ForvoClient.h"
+
+namespace Image2Card::Pipeline
+{
+
+  namespace
+  {
+    // Stores the stage's value in out and returns true, or returns false after handing resume to the
+    // run that is computing it; the stage must then return without touching its outputs.
+    template <typename T>
+    bool Memoized(StageMemo* memo,
+                  const StageGraph::Resume& resume,
+                  const std::string& key,
+                  T& out,
+                  const std::function<T()>& compute,
+                  const std::function<bool(const T&)>& keep = {})
+    {
+      if (!memo) {
+        out = compute();
+        return true;
+      }
+      std::optional<T> value = memo->GetOrCompute<T>(key, compute, keep, resume);
+      if (!value) {
+        return false;
+      }
+      out = std::move(*value);
+      return true;
+    }
+
+    bool IsUsableAnalysis(const nlohmann::json& analysis)
+    {
+      return analysis.is_object() && !analysis.contains("error");
+    }
+  } // namespace
+
+  CardPipeline::CardPipeline(CardPipelineServices services)
+      : m_Services(services)
+  {}
+
+  std::string CardPipeline::AudioExtension(const std::string& audioFormat, const std::string& audioProviderId)
+  {
+    if (audioFormat == "opus") {
+      return audioProviderId == "minimax" ? "ogg" : "opus";
+    }
+    return "mp3";
+  }
+
+  CardResult CardPipeline::Run(const CardRequest& request)
+  {
+    if (!m_Services.language) {
+      throw std::runtime_error("No active language selected");
+    }
+
+    auto* analyzer = m_Services.analyzer;
+    auto* provider = m_Services.analysisProvider;
+    // Right after startup the analyzer may still be loading its dictionaries.
+    if (analyzer && m_Services.analyzerReadiness && !m_Services.analyzerReadiness->Wait(m_Cancellation)) {
+      analyzer = nullptr;
+    }
+    bool useLocalAnalyzer = analyzer && analyzer->IsReady();
+    if (!useLocalAnalyzer && !provider) {
+      throw std::runtime_error("No Text AI Provider found for selected analysis model.");
+    }
+
+    CardResult result;
+    Language::Analyzer::SentenceAnalyzer::TargetWord target;
+    nlohmann::json analysis;
+    std::string sentenceFurigana;
+    std::string translation;
+    StageMemo* memo = m_Memo.get();
+
+    // A stage whose memo entry is still being computed by another run returns and is resumed once it
+    // settles, so waiting for it does not hold a worker.
+    using Resume = StageGraph::Resume;
+    StageGraph graph;
+    graph.AddInput("sentence");
+    graph.AddInput("target_input");
+    graph.AddInput("voice");
+
+    if (useLocalAnalyzer) {
+      AF_INFO("Using local sentence analyzer");
+
+      // MeCab alone is enough to know the target word, so vocab audio does not
+      // have to wait for dictionary, pitch and translation lookups.
+      graph.AddStage("target_word", {"sentence", "target_input"}, {"target_word"}, [&](const Resume& resume) {
+        using TargetWord = Language::Analyzer::SentenceAnalyzer::TargetWord;
+        auto key = StageMemo::Key("target_word", {request.sentence, request.targetWord});
+        Memoized<TargetWord>(memo, resume, key, target, [&]() {
+          return analyzer->ResolveTargetWord(request.sentence, request.targetWord);
+        });
+      });
+
+      // Furigana and translation only depend on the sentence, so editing the target word
+      // re-runs just the word stage (and vocab audio) and reuses these from the memo.
+      graph.AddStage("sentence_furigana", {"sentence"}, {"sentence_furigana"}, [&](const Resume& resume) {
+        auto key = StageMemo::Key("sentence_furigana", {request.sentence});
+        Memoized<std::string>(memo, resume, key, sentenceFurigana, [&]() {
+          return analyzer->GenerateSentenceFurigana(request.sentence);
+        });
+      });
+      graph.AddStage("translation", {"sentence"}, {"translation"}, [&](const Resume& resume) {
+        auto key = StageMemo::Key("translation", {analyzer->GetPreferredTranslator(), request.sentence});
+        Memoized<std::string>(
+            memo,
+            resume,
+            key,
+            translation,
+            [&]() { return analyzer->TranslateSentence(request.sentence, m_Cancellation); },
+            [](const std::string& text) { return !text.empty(); });
+      });
+      graph.AddStage("word_analysis", {"sentence_furigana", "target_word"}, {"analysis"}, [&](const Resume& resume) {
+        auto key = StageMemo::Key("word_analysis", {request.sentence, target.surface});
+        Memoized<nlohmann::json>(
+            memo,
+            resume,
+            key,
+            analysis,
+            [&]() { return analyzer->AnalyzeTargetWord(request.sentence, sentenceFurigana, target); },
+            IsUsableAnalysis);
+      });
+    } else {
+      AF_INFO("Using AI for sentence analysis");
+
+      graph.AddStage("analysis", {"sentence", "target_input"}, {"analysis", "target_word"}, [&](const Resume& resume) {
+        auto key = StageMemo::Key("analysis", {"ai", request.languageCode, request.sentence, request.targetWord});
+        bool done = Memoized<nlohmann::json>(
+            memo,
+            resume,
+            key,
+            analysis,
+            [&]() {
+              return provider->AnalyzeSentence(
+                  request.sentence, request.targetWord, *m_Services.language, m_Cancellation);
+            },
+            IsUsableAnalysis);
+        if (done && analysis.is_object()) {
+          target.surface = analysis.value("target_word", "");
+        }
+      });
+    }
+
+    if (request.wantVocabAudio) {
+      graph.AddStage("vocab_audio", {"target_word", "voice"}, {"vocab_audio"}, [&](const Resume& resume) {
+        const std::string& word = target.Headword();
+        if (word.empty()) {
+          return;
+        }
+        try {
+          using Audio = std::pair<std::vector<unsigned char>, std::string>;
+          auto key = StageMemo::Key("vocab_audio", {word, request.voice, request.languageCode, request.audioFormat});
+          Audio audio;
+          bool done = Memoized<Audio>(
+              memo,
+              resume,
+              key,
+              audio,
+              [&]() {
+                Audio fetched;
+                fetched.first = FetchVocabAudio(request, word, &fetched.second);
+                return fetched;
+              },
+              [](const Audio& fetched) { return !fetched.first.empty(); });
+          if (done) {
+            std::tie(result.vocabAudio, result.vocabAudioFilename) = std::move(audio);
+          }
+        } catch (const std::exception& e) {
+          AF_WARN("Vocab audio failed for '{}': {}", word, e.what());
+        }
+      });
+    }
+
+    if (request.wantSentenceAudio) {
+      graph.AddStage("sentence_audio", {"sentence", "voice"}, {"sentence_audio"}, [&](const Resume& resume) {
+        if (!m_Services.audioProvider) {
+          return;
+        }
+        try {
+          auto key = StageMemo::Key(
+              "sentence_audio", {request.sentence, request.voice, request.languageCode, request.audioFormat});
+          bool done = Memoized<std::vector<unsigned char>>(
+              memo,
+              resume,
+              key,
+              result.sentenceAudio,
+              [&]() {
+                AF_INFO("Generating Sentence Audio for: {}", request.sentence);
+                return m_Services.audioProvider->GenerateAudio(
+                    request.sentence, request.voice, request.languageCode, request.audioFormat, m_Cancellation);
+              },
+              [](const std::vector<unsigned char>& audio) { return !audio.empty(); });
+          if (!done) {
+            return;
+          }
+          result.sentenceAudioFilename = "sentence." + request.audioExtension;
+          AF_INFO("Sentence Audio generated, size: {} bytes", result.sentenceAudio.size());
+        } catch (const std::exception& e) {
+          AF_WARN("Sentence audio failed: {}", e.what());
+        }
+      });
+    }
+
+    graph.SetOnStageComplete(m_OnStageComplete);
+    graph.SetCancellationCheck([this]() { return m_Cancellation.IsCancelled(); });
+    graph.SetPriority(m_Priority);
+    graph.Run();
+    m_Timings = graph.GetTimings();
+    if (memo) {
+      AF_DEBUG("CardPipeline: memo served {} stage results, computed {}", memo->GetHitCount(), memo->GetMissCount());
+    }
+
+    if (m_Cancellation.IsCancelled()) {
+      throw std::runtime_error("Processing cancelled");
+    }
+
+    AF_DEBUG("Analysis Response: {}", analysis.dump());
+    if (analysis.is_null() || !analysis.is_object()) {
+      AF_ERROR("Analysis returned null/empty response");
+      throw std::runtime_error("Text analysis failed.");
+    }
+    if (analysis.contains("error")) {
+      throw std::runtime_error(analysis.value("error", "Text analysis failed."));
+    }
+    if (useLocalAnalyzer) {
+      analysis["translation"] = translation;
+    }
+
+    result.sentence = analysis.value("sentence", "");
+    result.translation = analysis.value("translation", "");
+    result.targetWord = analysis.value("target_word", "");
+    result.targetWordFurigana = analysis.value("target_word_furigana", "");
+    result.furigana = analysis.value("furigana", "");
+    result.definition = analysis.value("definition", "");
+    result.pitchAccent = analysis.value("pitch_accent", "");
+
+    return result;
+  }
+
+  std::vector<unsigned char>
+  CardPipeline::FetchVocabAudio(const CardRequest& request, const std::string& word, std::string* filename)
+  {
+    AF_INFO("Generating Vocab Audio for: {}", word);
+
+    auto* forvo = m_Services.forvoClient;
+    if (forvo && forvo->IsAvailable()) {
+      AF_INFO("Searching audio from Forvo");
+      try {
+        auto audioResults = forvo->SearchAudio(word, word, "", m_Cancellation);
+        if (!audioResults.empty()) {
+          std::string audioUrl = audioResults[0].url;
+          if (audioUrl.find("https://") == 0) {
+            audioUrl = audioUrl.substr(8);
+          }
+
+          size_t slashPos = audioUrl.find('/');
+          if (slashPos != std::string::npos) {
+            std::string host = audioUrl.substr(0, slashPos);
+            std::string path = audioUrl.substr(slashPos);
+
+            httplib::SSLClient audioClient(host.c_str());
+            audioClient.set_connection_timeout(m_Cancellation.ClampTimeout(std::chrono::seconds(10)));
+            audioClient.set_read_timeout(m_Cancellation.ClampTimeout(std::chrono::seconds(10)));
+
+            Core::ScopedCancellationCallback stopOnCancel(m_Cancellation, [&audioClient]() { audioClient.stop(); });
+            AF_TRACE_SCOPE("forvo", "Forvo download");
+            auto res = audioClient.Get(path.c_str());
+            if (res && res->status == 200) {
+              AF_INFO(
+                  "Downloaded vocab audio from Forvo: {} ({} bytes)", audioResults[0].filename, res->body.size());
+              *filename = audioResults[0].filename;
+              return std::vector<unsigned char>(res->body.begin(), res->body.end());
+            }
+            AF_WARN("Failed to download vocab audio from: {}", audioUrl);
+          }
+        }
+      } catch (const std::exception& e) {
+        AF_WARN("Forvo audio search failed: {}, falling back to AI", e.what());
+      }
+    }
+
+    if (!m_Services.audioProvider) {
+      return {};
+    }
+
+    if (m_Cancellation.IsCancelled()) {
+      return {};
+    }
+
+    AF_INFO("Using AI for vocab audio generation");
+    auto audio = m_Services.audioProvider->GenerateAudio(
+        word, request.voice, request.languageCode, request.audioFormat, m_Cancellation);
+    AF_INFO("Vocab Audio generated, size: {} bytes", audio.size());
+    *filename = "vocab." + request.audioExtension;
+    return audio;
+  }
+
+} // namespace Image2Card::Pipeline
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/CancellationToken.h"
+#include "pipeline/StageGraph.h"
+#include "pipeline/StageMemo.h"
+
+namespace Image2Card::Core
+{
+  class Readiness;
+}
+
+namespace Image2Card::Language
+{
+  class ILanguage;
+}
+
+namespace Image2Card::Language::Analyzer
+{
+  class SentenceAnalyzer;
+}
+
+namespace Image2Card::Language::Audio
+{
+  class ForvoClient;
+}
+
+namespace Image2Card::AI
+{
+  class ITextAIProvider;
+  class IAudioAIProvider;
+} // namespace Image2Card::AI
+
+namespace Image2Card::Pipeline
+{
+
+  struct CardRequest
+  {
+    std::string sentence;
+    std::string targetWord;
+    std::string voice;
+    std::string languageCode;
+    std::string audioFormat = "mp3";
+    std::string audioExtension = "mp3";
+    bool wantVocabAudio = true;
+    bool wantSentenceAudio = true;
+  };
+
+  struct CardResult
+  {
+    std::string sentence;
+    std::string furigana;
+    std::string translation;
+    std::string targetWord;
+    std::string targetWordFurigana;
+    std::string pitchAccent;
+    std::string definition;
+
+    std::vector<unsigned char> vocabAudio;
+    std::string vocabAudioFilename;
+    std::vector<unsigned char> sentenceAudio;
+    std::string sentenceAudioFilename;
+  };
+
+  struct CardPipelineServices
+  {
+    Language::Analyzer::SentenceAnalyzer* analyzer = nullptr;
+    const Core::Readiness* analyzerReadiness = nullptr; // Waited for before the analyzer is used, if set
+    AI::ITextAIProvider* analysisProvider = nullptr;
+    const Language::ILanguage* language = nullptr;
+    Language::Audio::ForvoClient* forvoClient = nullptr;
+    AI::IAudioAIProvider* audioProvider = nullptr;
+  };
+
+  /**
+ * Builds the content of one card (analysis, translation and audio) from a
+ * sentence. Stages are wired into a StageGraph so that sentence audio and
+ * vocab audio run alongside dictionary, pitch and translation lookups.
+ */
+  class CardPipeline
+  {
+public:
+
+    explicit CardPipeline(CardPipelineServices services);
+
+    /**
+   * Set a callback invoked after each stage finishes.
+   */
+    void SetOnStageComplete(StageGraph::StageCallback callback) { m_OnStageComplete = std::move(callback); }
+
+    /**
+   * Set the token checked between stages and passed to every network call, so a
+   * cancelled run aborts in-flight requests and then throws std::runtime_error.
+   */
+    void SetCancellationToken(Core::CancellationToken cancellation) { m_Cancellation = std::move(cancellation); }
+
+    /**
+   * Executor lane the stages run on (interactive by default).
+   */
+    void SetPriority(Core::TaskPriority priority) { m_Priority = priority; }
+
+    /**
+   * Share stage results with other runs using the same memo. Each stage is keyed
+   * by the request fields it depends on, so a run after an edit only redoes the
+   * stages the edit affects, and a run that overlaps an earlier one waits for
+   * its in-flight requests instead of repeating them.
+   */
+    void SetMemo(std::shared_ptr<StageMemo> memo) { m_Memo = std::move(memo); }
+
+    /**
+   * Run every stage for the request.
+   * @param request Sentence, target word and audio settings
+   * @return Card content; audio is empty when a stage was skipped or failed
+   * @throws std::runtime_error if analysis fails or the run was cancelled
+   */
+    [[nodiscard]] CardResult Run(const CardRequest& request);
+
+    /**
+   * Timings of the stages of the last run.
+   */
+    [[nodiscard]] const std::vector<StageGraph::StageTiming>& GetTimings() const { return m_Timings; }
+
+    /**
+   * File extension Anki should use for generated audio.
+   * @param audioFormat Configured format ("mp3" or "opus")
+   * @param audioProviderId Configured audio provider id
+   */
+    [[nodiscard]] static std::string AudioExtension(const std::string& audioFormat, const std::string& audioProviderId);
+
+private:
+
+    std::vector<unsigned char>
+    FetchVocabAudio(const CardRequest& request, const std::string& word, std::string* filename);
+
+    CardPipelineServices m_Services;
+    StageGraph::StageCallback m_OnStageComplete;
+    Core::CancellationToken m_Cancellation;
+    Core::TaskPriority m_Priority = Core::TaskPriority::Interactive;
+    std::shared_ptr<StageMemo> m_Memo;
+    std::vector<StageGraph::StageTiming> m_Timings;
+  };
+
+} // namespace Image2Card::Pipeline
@@ -0,0 +1,223 @@
+#include "pipeline/StageGraph.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+
+#include "core/Logger.h"
+#include "core/Trace.h"
+
+namespace Image2Card::Pipeline
+{
+
+  void StageGraph::AddInput(const std::string& name)
+  {
+    m_Inputs.push_back(name);
+  }
+
+  void StageGraph::AddStage(std::string name,
+                            std::vector<std::string> inputs,
+                            std::vector<std::string> outputs,
+                            StageFunction function)
+  {
+    AddStage(std::move(name), std::move(inputs), std::move(outputs), [function = std::move(function)](const Resume&) {
+      function();
+    });
+  }
+
+  void StageGraph::AddStage(std::string name,
+                            std::vector<std::string> inputs,
+                            std::vector<std::string> outputs,
+                            ResumableStageFunction function)
+  {
+    m_Stages.push_back({std::move(name), std::move(inputs), std::move(outputs), std::move(function)});
+  }
+
+  void StageGraph::Validate() const
+  {
+    std::set<std::string> produced(m_Inputs.begin(), m_Inputs.end());
+    for (const auto& stage : m_Stages) {
+      for (const auto& output : stage.outputs) {
+        if (!produced.insert(output).second) {
+          throw std::logic_error("StageGraph: value '" + output + "' has more than one producer");
+        }
+      }
+    }
+
+    for (const auto& stage : m_Stages) {
+      for (const auto& input : stage.inputs) {
+        if (!produced.count(input)) {
+          throw std::logic_error("StageGraph: stage '" + stage.name + "' needs '" + input + "' which nothing produces");
+        }
+      }
+    }
+  }
+
+  void StageGraph::Run()
+  {
+    Validate();
+
+    using Clock = std::chrono::steady_clock;
+    const auto runStart = Clock::now();
+
+    std::set<std::string> available(m_Inputs.begin(), m_Inputs.end());
+    std::vector<bool> started(m_Stages.size(), false);
+    std::set<size_t> running;
+    std::map<size_t, Clock::time_point> startTimes;
+
+    std::vector<std::exception_ptr> errors(m_Stages.size());
+
+    std::mutex doneMutex;
+    std::condition_variable doneCondition;
+    std::vector<size_t> finished;
+
+    // Owned by the posted task, so completion is signalled when the task is destroyed: after it has
+    // run, and also if the executor drops it during shutdown without running it.
+    struct CompletionNotifier
+    {
+      size_t index;
+      std::mutex& mutex;
+      std::condition_variable& condition;
+      std::vector<size_t>& finished;
+
+      CompletionNotifier(size_t index,
+                         std::mutex& mutex,
+                         std::condition_variable& condition,
+                         std::vector<size_t>& finished)
+          : index(index)
+          , mutex(mutex)
+          , condition(condition)
+          , finished(finished)
+      {}
+
+      ~CompletionNotifier()
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        finished.push_back(index);
+        condition.notify_one();
+      }
+    };
+
+    // Stages no worker has picked up yet can be run by this thread while it waits.
+    Core::TaskGroup group(m_Priority);
+
+    // A stage that hands its resume callback off keeps the notifier alive through it, so the graph
+    // waits for the rerun without any thread being held until then.
+    std::function<void(size_t, std::shared_ptr<CompletionNotifier>)> launch;
+    launch = [this, &group, &errors, &launch](size_t i, std::shared_ptr<CompletionNotifier> notifier) {
+      // Pre-set so a stage the executor drops at shutdown without running it counts as failed.
+      errors[i] = std::make_exception_ptr(std::runtime_error("StageGraph: stage was dropped before running"));
+      group.Post([this, i, notifier, &errors, &launch]() {
+        AF_TRACE_SCOPE("stage", m_Stages[i].name);
+        errors[i] = nullptr;
+        try {
+          m_Stages[i].function([i, notifier, &launch]() { launch(i, notifier); });
+        } catch (...) {
+          errors[i] = std::current_exception();
+        }
+      });
+    };
+
+    std::exception_ptr firstError;
+    size_t completed = 0;
+    bool stopLaunching = false;
+
+    m_Timings.clear();
+
+    while (true) {
+      if (!stopLaunching && m_IsCancelled && m_IsCancelled()) {
+        AF_INFO("StageGraph: cancellation requested, not starting further stages");
+        stopLaunching = true;
+      }
+
+      if (!stopLaunching) {
+        for (size_t i = 0; i < m_Stages.size(); ++i) {
+          if (started[i]) {
+            continue;
+          }
+
+          bool ready = true;
+          for (const auto& input : m_Stages[i].inputs) {
+            if (!available.count(input)) {
+              ready = false;
+              break;
+            }
+          }
+          if (!ready) {
+            continue;
+          }
+
+          started[i] = true;
+          startTimes[i] = Clock::now();
+          running.insert(i);
+          launch(i, std::make_shared<CompletionNotifier>(i, doneMutex, doneCondition, finished));
+        }
+      }
+
+      if (running.empty()) {
+        break;
+      }
+
+      std::vector<size_t> ready;
+      while (ready.empty()) {
+        {
+          std::lock_guard<std::mutex> lock(doneMutex);
+          ready.swap(finished);
+        }
+
+        // Only this graph's own stages are run here, so the wait never picks up unrelated work.
+        // Once they have all started, the stages left are running elsewhere and will signal.
+        if (ready.empty() && !group.RunPendingTask()) {
+          std::unique_lock<std::mutex> lock(doneMutex);
+          doneCondition.wait(lock, [&finished]() { return !finished.empty(); });
+        }
+      }
+
+      for (size_t index : ready) {
+        auto& stage = m_Stages[index];
+        auto now = Clock::now();
+
+        if (errors[index]) {
+          AF_ERROR("StageGraph: stage '{}' failed", stage.name);
+          if (!firstError) {
+            firstError = errors[index];
+          }
+          stopLaunching = true;
+        } else {
+          available.insert(stage.outputs.begin(), stage.outputs.end());
+        }
+        running.erase(index);
+
+        StageTiming timing;
+        timing.name = stage.name;
+        timing.startMs = std::chrono::duration<double, std::milli>(startTimes[index] - runStart).count();
+        timing.durationMs = std::chrono::duration<double, std::milli>(now - startTimes[index]).count();
+        AF_DEBUG("StageGraph: '{}' finished in {:.1f}ms", timing.name, timing.durationMs);
+        m_Timings.push_back(std::move(timing));
+
+        ++completed;
+        if (m_OnStageComplete) {
+          m_OnStageComplete(stage.name, completed, m_Stages.size());
+        }
+      }
+    }
+
+    if (firstError) {
+      std::rethrow_exception(firstError);
+    }
+
+    if (!stopLaunching && completed < m_Stages.size()) {
+      throw std::logic_error("StageGraph: dependency cycle, some stages could never start");
+    }
+
+    AF_DEBUG("StageGraph: {} stages finished in {:.1f}ms",
+             completed,
+             std::chrono::duration<double, std::milli>(Clock::now() - runStart).count());
+  }
+
+} // namespace Image2Card::Pipeline
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "core/TaskExecutor.h"
+
+namespace Image2Card::Pipeline
+{
+
+  /**
+ * Small dependency-graph executor.
+ * Each stage declares the named values it consumes and produces; a stage
+ * is started as soon as every one of its inputs has been produced, so
+ * independent stages run concurrently and the wall-clock time of a run is
+ * bounded by the longest dependency chain rather than the sum of stages.
+ * Stages are submitted to the shared TaskExecutor as one TaskGroup; while Run
+ * waits it executes this graph's stages no worker has picked up yet, and
+ * nothing else.
+ */
+  class StageGraph
+  {
+public:
+
+    struct StageTiming
+    {
+      std::string name;
+      double startMs = 0.0;
+      double durationMs = 0.0;
+    };
+
+    using StageFunction = std::function<void()>;
+
+    /**
+   * Queues the stage that received it to run again. A resumable stage that has
+   * to wait for something hands this to whoever it waits for and returns at
+   * once; the stage only counts as finished after a run that did not hand it off.
+   */
+    using Resume = std::function<void()>;
+    using ResumableStageFunction = std::function<void(const Resume& resume)>;
+
+    using StageCallback = std::function<void(const std::string& stage, size_t completed, size_t total)>;
+
+    StageGraph() = default;
+
+    /**
+   * Declare a value that is available before any stage runs.
+   * @param name Name of the value
+   */
+    void AddInput(const std::string& name);
+
+    /**
+   * Add a stage to the graph.
+   * @param name Unique stage name (used in logs and timings)
+   * @param inputs Values that must be produced before the stage can start
+   * @param outputs Values this stage produces
+   * @param function Work to run; communicates through state captured by the caller
+   */
+    void AddStage(std::string name,
+                  std::vector<std::string> inputs,
+                  std::vector<std::string> outputs,
+                  StageFunction function);
+
+    /**
+   * Add a stage that can wait for other work without holding a worker.
+   * A run that hands resume off must return without touching the state it shares
+   * with the caller, as its rerun may already have started.
+   */
+    void AddStage(std::string name,
+                  std::vector<std::string> inputs,
+                  std::vector<std::string> outputs,
+                  ResumableStageFunction function);
+
+    /**
+   * Set a callback invoked (from the thread that ran Run) after each stage finishes.
+   */
+    void SetOnStageComplete(StageCallback callback) { m_OnStageComplete = std::move(callback); }
+
+    /**
+   * Set a predicate checked before each stage is started. Once it returns
+   * true no further stages are launched; running stages are awaited.
+   */
+    void SetCancellationCheck(std::function<bool()> isCancelled) { m_IsCancelled = std::move(isCancelled); }
+
+    /**
+   * Set the executor lane stages are submitted to (interactive by default).
+   */
+    void SetPriority(Core::TaskPriority priority) { m_Priority = priority; }
+
+    /**
+   * Execute all stages, blocking until every started stage has finished.
+   * @throws std::logic_error if the graph has missing or duplicate producers or a cycle
+   * @throws The first exception raised by a stage, after running stages have drained
+   */
+    void Run();
+
+    /**
+   * Timings of the stages that ran, in completion order.
+   */
+    [[nodiscard]] const std::vector<StageTiming>& GetTimings() const { return m_Timings; }
+
+private:
+
+    struct Stage
+    {
+      std::string name;
+      std::vector<std::string> inputs;
+      std::vector<std::string> outputs;
+      ResumableStageFunction function;
+    };
+
+    void Validate() const;
+
+    std::vector<std::string> m_Inputs;
+    std::vector<Stage> m_Stages;
+    std::vector<StageTiming> m_Timings;
+
+    StageCallback m_OnStageComplete;
+    std::function<bool()> m_IsCancelled;
+    Core::TaskPriority m_Priority = Core::TaskPriority::Interactive;
+  };
+
+} // namespace Image2Card::Pipeline
@@ -0,0 +1,41 @@
+#include "pipeline/StageMemo.h"
+
+namespace Image2Card::Pipeline
+{
+
+  std::string StageMemo::Key(const std::string& stage, const std::vector<std::string>& inputs)
+  {
+    // Unit separator keeps ("ab", "c") and ("a", "bc") apart.
+    std::string key = stage;
+    for (const auto& input : inputs) {
+      key += '\x1f';
+      key += input;
+    }
+    return key;
+  }
+
+  void StageMemo::Settle(const std::string& key, std::any value)
+  {
+    std::vector<Resume> waiters;
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      auto it = m_Entries.find(key);
+      if (it == m_Entries.end()) {
+        return;
+      }
+      waiters.swap(it->second.waiters);
+      if (value.has_value()) {
+        it->second.value = std::move(value);
+        it->second.settled = true;
+      } else {
+        m_Entries.erase(it);
+      }
+    }
+
+    // Each waiter asks again: it gets the stored value, or the first one to ask computes it anew.
+    for (const auto& resume : waiters) {
+      resume();
+    }
+  }
+
+} // namespace Image2Card::Pipeline
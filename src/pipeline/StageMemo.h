@@ -0,0 +1,99 @@
+#pragma once
+
+#include <any>
+#include <atomic>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace Image2Card::Pipeline
+{
+
+  /**
+ * Shares stage results between pipeline runs over the same input.
+ * Results are keyed by the stage name and every input it depends on, so a run
+ * that reuses a memo only recomputes the stages whose inputs changed. A second
+ * run asking for a key that is still being computed is resumed when the first
+ * one settles instead of starting a duplicate request, and no thread blocks
+ * meanwhile. Failed or rejected results are not stored; a resumed run asking
+ * for such a result computes it itself.
+ */
+  class StageMemo
+  {
+public:
+
+    /**
+   * Build a key from a stage name and the inputs it depends on.
+   */
+    [[nodiscard]] static std::string Key(const std::string& stage, const std::vector<std::string>& inputs);
+
+    using Resume = std::function<void()>;
+
+    /**
+   * Return the memoized value for key, computing it if it is neither stored nor in flight.
+   * @param key Key built with Key()
+   * @param compute Produces the value; runs at most once per stored key
+   * @param keep Decides whether a computed value may be reused (e.g. not an empty or cancelled result)
+   * @param resume Called once another run computing key has settled; the caller should then ask again
+   * @return The value, or nothing if another run is computing it (resume has been registered)
+   * @throws Whatever compute throws, when this call ran it
+   */
+    template <typename T>
+    std::optional<T> GetOrCompute(const std::string& key,
+                                  const std::function<T()>& compute,
+                                  const std::function<bool(const T&)>& keep,
+                                  const Resume& resume)
+    {
+      {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        auto [it, inserted] = m_Entries.try_emplace(key);
+        if (!inserted && it->second.settled) {
+          ++m_Hits;
+          return std::any_cast<T>(it->second.value);
+        }
+        if (!inserted) {
+          it->second.waiters.push_back(resume);
+          return std::nullopt;
+        }
+      }
+
+      ++m_Misses;
+      std::optional<T> value;
+      try {
+        value = compute();
+      } catch (...) {
+        Settle(key, std::any());
+        throw;
+      }
+      Settle(key, keep && !keep(*value) ? std::any() : std::any(*value));
+      return value;
+    }
+
+    [[nodiscard]] size_t GetHitCount() const { return m_Hits.load(); }
+    [[nodiscard]] size_t GetMissCount() const { return m_Misses.load(); }
+
+private:
+
+    struct Entry
+    {
+      bool settled = false; // Value is stored; otherwise the entry is still being computed
+      std::any value;
+      std::vector<Resume> waiters;
+    };
+
+    /**
+   * Store value for key, or drop the entry if value is empty, and resume the
+   * runs waiting for it.
+   */
+    void Settle(const std::string& key, std::any value);
+
+    std::mutex m_Mutex;
+    std::map<std::string, Entry> m_Entries;
+    std::atomic<size_t> m_Hits{0};
+    std::atomic<size_t> m_Misses{0};
+  };
+
+} // namespace Image2Card::Pipeline
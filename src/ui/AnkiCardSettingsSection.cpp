@@ -10,7 +10,8 @@
 #include "api/AnkiConnectClient.h"
 #include "config/ConfigManager.h"
 #include "core/Logger.h"
-#include "utils/Base64Utils.h"
+#include "core/TaskExecutor.h"
+#include "core/Trace.h"
 #include "utils/ImageProcessor.h"
 
 namespace Image2Card::UI
@@ -41,6 +42,14 @@ namespace Image2Card::UI
           m_SelectedDeckIndex = (int) std::distance(m_Decks.begin(), it);
         }
       }
+
+      // Fields known from an earlier session, so cards can be made before Anki answers or without it.
+      if (!m_NoteTypes.empty()) {
+        auto fields = config.AnkiModelFields.find(m_NoteTypes[m_SelectedNoteTypeIndex]);
+        if (fields != config.AnkiModelFields.end()) {
+          BuildFields(fields->first, fields->second);
+        }
+      }
     }
   }
 
@@ -49,13 +58,59 @@ namespace Image2Card::UI
     if (!m_AnkiConnectClient)
       return;
 
-    m_NoteTypes = m_AnkiConnectClient->GetModelNames();
-    m_Decks = m_AnkiConnectClient->GetDeckNames();
+    // One fetch at a time; a call made meanwhile fetches again once it is applied.
+    if (m_DataRefresh.valid() && m_DataRefresh.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+      m_RefreshAgain = true;
+      return;
+    }
+    m_RefreshAgain = false;
+
+    std::string lastNoteType = m_ConfigManager ? m_ConfigManager->GetConfig().LastNoteType : "";
+    m_DataRefresh = Core::TaskExecutor::Get().Submit(
+        Core::TaskPriority::Interactive,
+        [this, lastNoteType = std::move(lastNoteType), cancellation = m_Cancellation.GetToken()]() {
+          AF_TRACE_SCOPE("anki", "Fetch decks and note types");
+          auto noteTypes = m_AnkiConnectClient->GetModelNames(cancellation);
+          auto decks = m_AnkiConnectClient->GetDeckNames(cancellation);
+
+          // Fields of the note type that will be selected, so applying the lists needs no request.
+          std::string fieldsOf;
+          std::vector<std::string> fieldNames;
+          if (!noteTypes.empty()) {
+            auto it = std::find(noteTypes.begin(), noteTypes.end(), lastNoteType);
+            fieldsOf = it != noteTypes.end() ? *it : noteTypes.front();
+            fieldNames = m_AnkiConnectClient->GetModelFieldNames(fieldsOf, cancellation);
+          }
 
-    if (m_ConfigManager) {
-      m_ConfigManager->GetConfig().AnkiNoteTypes = m_NoteTypes;
-      m_ConfigManager->GetConfig().AnkiDecks = m_Decks;
-      m_ConfigManager->Save();
+          m_Completions.Post([this,
+                              noteTypes = std::move(noteTypes),
+                              decks = std::move(decks),
+                              fieldsOf = std::move(fieldsOf),
+                              fieldNames = std::move(fieldNames)]() mutable {
+            ApplyData(std::move(noteTypes), std::move(decks), fieldsOf, std::move(fieldNames));
+            if (m_RefreshAgain)
+              RefreshData();
+          });
+        });
+  }
+
+  void AnkiCardSettingsSection::ApplyData(std::vector<std::string> noteTypes,
+                                          std::vector<std::string> decks,
+                                          const std::string& fieldsOf,
+                                          std::vector<std::string> fieldNames)
+  {
+    // Without an answer the lists saved last time stay, so cards can still be made and queued.
+    bool offline = noteTypes.empty() && decks.empty();
+    if (offline) {
+      AF_WARN("AnkiConnect did not answer, using the saved decks and note types");
+    } else {
+      m_NoteTypes = std::move(noteTypes);
+      m_Decks = std::move(decks);
+      if (m_ConfigManager) {
+        m_ConfigManager->GetConfig().AnkiNoteTypes = m_NoteTypes;
+        m_ConfigManager->GetConfig().AnkiDecks = m_Decks;
+        m_ConfigManager->Save();
+      }
     }
 
     m_SelectedNoteTypeIndex = 0;
@@ -79,24 +134,59 @@ namespace Image2Card::UI
 
     if (!m_NoteTypes.empty()) {
       std::string currentNoteType = m_NoteTypes[m_SelectedNoteTypeIndex];
-      auto fieldNames = m_AnkiConnectClient->GetModelFieldNames(currentNoteType);
-      for (const auto& name : fieldNames) {
-        bool enabled = false;
-        int toolIdx = 0;
-
-        if (m_ConfigManager) {
-          const auto& config = m_ConfigManager->GetConfig();
-          if (config.FieldMappings.count(currentNoteType) && config.FieldMappings.at(currentNoteType).count(name)) {
-            auto& pair = config.FieldMappings.at(currentNoteType).at(name);
-            enabled = pair.first;
-            toolIdx = pair.second;
-          }
+      if (offline || currentNoteType != fieldsOf) {
+        fieldNames.clear();
+      }
+      if (m_ConfigManager) {
+        auto& savedFields = m_ConfigManager->GetConfig().AnkiModelFields;
+        if (!fieldNames.empty() && savedFields[currentNoteType] != fieldNames) {
+          savedFields[currentNoteType] = fieldNames;
+          m_ConfigManager->Save();
+        } else if (fieldNames.empty() && savedFields.count(currentNoteType)) {
+          fieldNames = savedFields.at(currentNoteType);
         }
+      }
+      BuildFields(currentNoteType, fieldNames);
+    }
 
-        m_Fields.push_back(std::make_unique<CardField>(name));
-        m_Fields.back()->SetToolEnabled(enabled);
-        m_Fields.back()->SetSelectedToolIndex(toolIdx);
+    // Reading a large deck into the duplicate index takes a while, so it starts before the first add needs it.
+    bool refreshing =
+        m_IndexRefresh.valid() && m_IndexRefresh.wait_for(std::chrono::seconds(0)) != std::future_status::ready;
+    std::vector<std::string> criteria;
+    for (const auto& field : m_Fields) {
+      if (IsDuplicateCriterion(*field))
+        criteria.push_back(field->GetName());
+    }
+    if (m_DuplicateIndex && !offline && !refreshing && !criteria.empty() && !m_NoteTypes.empty() && !m_Decks.empty()) {
+      m_IndexRefresh = Core::TaskExecutor::Get().Submit(
+          Core::TaskPriority::Batch,
+          [this, deck = m_Decks[m_SelectedDeckIndex], model = m_NoteTypes[m_SelectedNoteTypeIndex],
+           criteria = std::move(criteria), cancellation = m_Cancellation.GetToken()]() {
+            m_DuplicateIndex->Refresh(*m_AnkiConnectClient, deck, model, criteria,
+                                      API::DuplicateIndex::RefreshInterval, cancellation);
+          });
+    }
+  }
+
+  void AnkiCardSettingsSection::BuildFields(const std::string& noteType, const std::vector<std::string>& fieldNames)
+  {
+    m_Fields.clear();
+    for (const auto& name : fieldNames) {
+      bool enabled = false;
+      int toolIdx = 0;
+
+      if (m_ConfigManager) {
+        const auto& config = m_ConfigManager->GetConfig();
+        if (config.FieldMappings.count(noteType) && config.FieldMappings.at(noteType).count(name)) {
+          auto& pair = config.FieldMappings.at(noteType).at(name);
+          enabled = pair.first;
+          toolIdx = pair.second;
+        }
       }
+
+      m_Fields.push_back(std::make_unique<CardField>(name));
+      m_Fields.back()->SetToolEnabled(enabled);
+      m_Fields.back()->SetSelectedToolIndex(toolIdx);
     }
   }
 
@@ -149,12 +239,33 @@ namespace Image2Card::UI
     }
   }
 
-  AnkiCardSettingsSection::~AnkiCardSettingsSection() {}
+  AnkiCardSettingsSection::~AnkiCardSettingsSection()
+  {
+    // The request in flight captures this section, so it has to end before the section does.
+    m_Cancellation.Cancel();
+    if (m_Request.valid()) {
+      m_Request.wait();
+    }
+    if (m_DataRefresh.valid()) {
+      m_DataRefresh.wait();
+    }
+    if (m_IndexRefresh.valid()) {
+      m_IndexRefresh.wait();
+    }
+    m_Completions.Clear();
+  }
+
+  void AnkiCardSettingsSection::Update()
+  {
+    m_Completions.Drain();
+  }
 
   void AnkiCardSettingsSection::Render()
   {
     ImGui::BeginChild("FieldsRegion", ImVec2(0, -40), false, 0);
 
+    // The card being sent is cleared when it succeeds, so it must not change meanwhile.
+    ImGui::BeginDisabled(m_Busy);
     for (auto& field : m_Fields) {
       bool wasEnabled = field->IsToolEnabled();
       int oldTool = field->GetSelectedToolIndex();
@@ -173,17 +284,17 @@ namespace Image2Card::UI
 
       ImGui::Spacing();
     }
+    ImGui::EndDisabled();
     ImGui::EndChild();
 
     ImGui::Separator();
     ImGui::Spacing();
 
+    ImGui::BeginDisabled(m_Busy);
     if (ImGui::Button(ICON_FA_TRASH " Clear", ImVec2(100, 0))) {
-      for (auto& field : m_Fields) {
-        field->SetValue("");
-        field->SetBinaryData({}, "");
-      }
+      ClearFields();
     }
+    ImGui::EndDisabled();
 
     ImGui::SameLine();
 
@@ -196,41 +307,88 @@ namespace Image2Card::UI
       ImGui::SameLine();
     }
 
+    size_t queued = m_OfflineOutbox ? m_OfflineOutbox->GetPendingCount() : 0;
+    if (queued > 0) {
+      ImGui::AlignTextToFramePadding();
+      ImGui::TextDisabled(ICON_FA_CLOUD_ARROW_UP " %zu queued", queued);
+      if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Cards added while Anki was unreachable.\nThey are sent as soon as AnkiConnect answers.");
+      }
+      ImGui::SameLine();
+    }
+
+    size_t pending = m_StagingOutbox ? m_StagingOutbox->GetPendingCount() : 0;
+    float spacing = ImGui::GetStyle().ItemSpacing.x;
+    float rightWidth = 200 + spacing + (pending > 0 ? 110 + spacing : 0);
     float availWidth = ImGui::GetContentRegionAvail().x;
-    ImGui::SetCursorPosX(ImGui::GetCursorPosX() + availWidth - 100);
+    ImGui::SetCursorPosX(ImGui::GetCursorPosX() + availWidth - rightWidth);
+
+    ImGui::BeginDisabled(m_Busy);
+    if (pending > 0) {
+      std::string flushLabel = ICON_FA_UPLOAD " Flush (" + std::to_string(pending) + ")";
+      if (ImGui::Button(flushLabel.c_str(), ImVec2(110, 0))) {
+        FlushOutbox();
+      }
+      if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Send all staged cards to Anki in one request");
+      }
+      ImGui::SameLine();
+    }
+
+    ImGui::BeginDisabled(!m_StagingOutbox);
+    if (ImGui::Button(ICON_FA_INBOX " Stage", ImVec2(100, 0))) {
+      CheckDuplicatesAndAdd(true);
+    }
+    ImGui::EndDisabled();
+    if (ImGui::IsItemHovered()) {
+      ImGui::SetTooltip("Keep this card in the outbox and add it later with the others");
+    }
+    ImGui::SameLine();
+
     ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.13f, 0.59f, 0.13f, 1.0f));
     ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4(0.18f, 0.69f, 0.18f, 1.0f));
     ImGui::PushStyleColor(ImGuiCol_ButtonActive, ImVec4(0.10f, 0.49f, 0.10f, 1.0f));
     if (ImGui::Button(ICON_FA_PLUS " Add", ImVec2(100, 0))) {
-      CheckDuplicatesAndAdd();
+      CheckDuplicatesAndAdd(false);
     }
     ImGui::PopStyleColor(3);
+    ImGui::EndDisabled();
 
     RenderDuplicateModal();
   }
 
-  void AnkiCardSettingsSection::CheckDuplicatesAndAdd()
+  bool AnkiCardSettingsSection::IsDuplicateCriterion(const CardField& field)
   {
-    if (!m_AnkiConnectClient || m_NoteTypes.empty() || m_Decks.empty())
-      return;
+    // Check if this field is mapped to Sentence (0) or Vocab Word (3)
+    // Or if the field name itself suggests it (fallback)
+    bool isSentence = (field.IsToolEnabled() && field.GetSelectedToolIndex() == 0) || field.GetName() == "Sentence" ||
+                      field.GetName() == "Expression";
+    bool isVocab = (field.IsToolEnabled() && field.GetSelectedToolIndex() == 3) || field.GetName() == "Target Word" ||
+                   field.GetName() == "Vocab Word";
+    return isSentence || isVocab;
+  }
 
-    std::string deckName = m_Decks[m_SelectedDeckIndex];
-    std::string modelName = m_NoteTypes[m_SelectedNoteTypeIndex];
+  std::optional<AnkiCardSettingsSection::CardSnapshot> AnkiCardSettingsSection::SnapshotCard() const
+  {
+    if (m_NoteTypes.empty() || m_Decks.empty())
+      return std::nullopt;
+
+    CardSnapshot card;
+    card.deckName = m_Decks[m_SelectedDeckIndex];
+    card.modelName = m_NoteTypes[m_SelectedNoteTypeIndex];
 
     // Construct query to check for duplicates
     // We check for Sentence or Vocab Word
-    std::string query = "deck:\"" + deckName + "\" note:\"" + modelName + "\" (";
+    std::string query = "deck:\"" + card.deckName + "\" note:\"" + card.modelName + "\" (";
     bool hasCriteria = false;
+    bool anyFieldFilled = false;
 
     for (const auto& field : m_Fields) {
-      // Check if this field is mapped to Sentence (0) or Vocab Word (3)
-      // Or if the field name itself suggests it (fallback)
-      bool isSentence = (field->IsToolEnabled() && field->GetSelectedToolIndex() == 0) ||
-                        field->GetName() == "Sentence" || field->GetName() == "Expression";
-      bool isVocab = (field->IsToolEnabled() && field->GetSelectedToolIndex() == 3) ||
-                     field->GetName() == "Target Word" || field->GetName() == "Vocab Word";
-
-      if ((isSentence || isVocab) && !field->GetValue().empty()) {
+      card.fields.push_back({field->GetName(), field->GetValue(), field->GetBinaryData(), field->GetType()});
+      if (!field->GetValue().empty())
+        anyFieldFilled = true;
+
+      if (IsDuplicateCriterion(*field) && !field->GetValue().empty()) {
         if (hasCriteria)
           query += " OR ";
         // Escape quotes in value
@@ -243,35 +401,109 @@ namespace Image2Card::UI
         }
 
         query += "\"" + field->GetName() + ":" + escapedValue + "\"";
+        card.duplicateValues[field->GetName()] = field->GetValue();
         hasCriteria = true;
       }
     }
     query += ")";
 
-    if (!hasCriteria) {
-      // No fields to check, just add? Or warn?
-      // Let's just add for now, or maybe show validation error if no fields are filled at all
-      bool anyFieldFilled = false;
-      for (const auto& field : m_Fields)
-        if (!field->GetValue().empty())
-          anyFieldFilled = true;
+    // Without identifying fields there is nothing to check; an empty card is not sent at all.
+    if (!anyFieldFilled)
+      return std::nullopt;
+    if (hasCriteria)
+      card.duplicateQuery = query;
 
-      if (anyFieldFilled)
-        PerformAdd();
+    return card;
+  }
 
+  void AnkiCardSettingsSection::CheckDuplicatesAndAdd(bool stage)
+  {
+    if (m_Busy || !m_AnkiConnectClient)
       return;
+
+    auto card = SnapshotCard();
+    if (!card)
+      return;
+
+    m_StageAfterCheck = stage;
+    m_CommittingFields = card->fields;
+    m_Busy = true;
+    ReportProgress(0.0f, stage ? "Preparing card..." : "Adding card...");
+
+    RunInBackground([this, stage, card = std::move(*card)](const Core::CancellationToken& cancellation) {
+      auto start = std::chrono::steady_clock::now();
+
+      size_t duplicates = CountDuplicates(card, cancellation);
+      if (cancellation.IsCancelled())
+        return;
+      ReportProgress(0.2f, "Encoding media...");
+
+      API::AnkiNote note = PrepareNote(card);
+      if (cancellation.IsCancelled())
+        return;
+
+      // Staged cards and duplicates go back to the main thread; a plain add goes straight out.
+      if (stage || duplicates > 0) {
+        m_Completions.Post([this, note = std::move(note), duplicates]() mutable {
+          OnNotePrepared(std::move(note), duplicates);
+        });
+        return;
+      }
+
+      ReportProgress(0.5f, "Uploading card...");
+      API::AddNoteResult result = SendNote(note, cancellation);
+      double milliseconds =
+          std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+      m_Completions.Post([this, result, milliseconds]() { FinishAdd(result, milliseconds); });
+    });
+  }
+
+  size_t AnkiCardSettingsSection::CountDuplicates(const CardSnapshot& card, const Core::CancellationToken& cancellation)
+  {
+    if (card.duplicateQuery.empty())
+      return 0;
+
+    auto start = std::chrono::steady_clock::now();
+    if (m_DuplicateIndex) {
+      auto duplicates = m_DuplicateIndex->FindDuplicates(
+          *m_AnkiConnectClient, card.deckName, card.modelName, card.duplicateValues, cancellation);
+      if (duplicates) {
+        AF_DEBUG("Duplicate check answered by the index in {:.1f} ms",
+                 std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        return duplicates->size();
+      }
     }
 
-    AF_INFO("Checking for duplicates with query: {}", query);
-    auto notes = m_AnkiConnectClient->FindNotes(query);
+    AF_INFO("Checking for duplicates with query: {}", card.duplicateQuery);
+    return m_AnkiConnectClient->FindNotes(card.duplicateQuery, cancellation).size();
+  }
+
+  API::AddNoteResult AnkiCardSettingsSection::SendNote(const API::AnkiNote& note,
+                                                       const Core::CancellationToken& cancellation)
+  {
+    // Media and note go out in a single request
+    auto results = m_AnkiConnectClient->AddNotes({note}, cancellation);
+    API::AddNoteResult result = results.empty() ? API::AddNoteResult{} : results.front();
+    if (result.Succeeded() && m_DuplicateIndex) {
+      m_DuplicateIndex->Add(note.deckName, note.modelName, result.noteId, note.fields);
+    } else if (result.unreachable && m_OfflineOutbox) {
+      // Kept until Anki is back; FinishAdd treats the card as done.
+      m_OfflineOutbox->Stage(note);
+    }
+    return result;
+  }
 
-    if (!notes.empty()) {
-      m_DuplicateMessage =
-          "Found " + std::to_string(notes.size()) + " duplicate note(s) in deck '" + deckName + "'.\nAdd anyway?";
+  void AnkiCardSettingsSection::OnNotePrepared(API::AnkiNote note, size_t duplicates)
+  {
+    m_PendingNote = std::move(note);
+    if (duplicates > 0) {
+      m_DuplicateMessage = "Found " + std::to_string(duplicates) + " duplicate note(s) in deck '" +
+                           m_PendingNote->deckName + "'.\nAdd anyway?";
       m_ShowDuplicateModal = true;
       m_OpenDuplicateModal = true;
+      ReportProgress(-1.0f, "Duplicate found.");
     } else {
-      PerformAdd();
+      CommitCard();
     }
   }
 
@@ -286,8 +518,8 @@ namespace Image2Card::UI
       ImGui::Text("%s", m_DuplicateMessage.c_str());
       ImGui::Separator();
 
-      if (ImGui::Button("Add Anyway", ImVec2(120, 0))) {
-        PerformAdd();
+      if (ImGui::Button(m_StageAfterCheck ? "Stage Anyway" : "Add Anyway", ImVec2(120, 0))) {
+        CommitCard();
         m_ShowDuplicateModal = false;
         ImGui::CloseCurrentPopup();
       }
@@ -299,20 +531,40 @@ namespace Image2Card::UI
       }
       ImGui::EndPopup();
     }
+
+    // Closing the prompt any other way than "Add Anyway" drops the prepared card.
+    if (!m_ShowDuplicateModal && m_PendingNote) {
+      m_PendingNote.reset();
+      FinishRequest("");
+    }
   }
 
-  void AnkiCardSettingsSection::PerformAdd()
+  void AnkiCardSettingsSection::CommitCard()
   {
-    if (!m_AnkiConnectClient || m_NoteTypes.empty() || m_Decks.empty())
+    if (!m_PendingNote)
       return;
 
-    std::string deckName = m_Decks[m_SelectedDeckIndex];
-    std::string modelName = m_NoteTypes[m_SelectedNoteTypeIndex];
-    std::map<std::string, std::string> fieldsMap;
+    API::AnkiNote note = std::move(*m_PendingNote);
+    m_PendingNote.reset();
+    if (m_StageAfterCheck) {
+      StageCard(std::move(note));
+    } else {
+      PerformAdd(std::move(note));
+    }
+  }
 
-    for (const auto& field : m_Fields) {
-      std::string fieldValue = field->GetValue();
-      const auto& binaryData = field->GetBinaryData();
+  API::AnkiNote AnkiCardSettingsSection::PrepareNote(const CardSnapshot& card)
+  {
+    AF_TRACE_SCOPE("anki", "Prepare note");
+
+    API::AnkiNote note;
+    note.deckName = card.deckName;
+    note.modelName = card.modelName;
+    note.tags = {"image2card"};
+
+    for (const auto& field : card.fields) {
+      std::string fieldValue = field.value;
+      const auto& binaryData = field.binaryData;
 
       if (!binaryData.empty()) {
         auto now = std::chrono::system_clock::now();
@@ -322,7 +574,7 @@ namespace Image2Card::UI
         // Process binary data based on field type
         std::vector<unsigned char> processedData = binaryData;
 
-        if (field->GetType() == CardFieldType::Image) {
+        if (field.type == CardFieldType::Image) {
           // Compress image to WebP format, scaling to fit 320x320
           AF_INFO("Compressing image to WebP format (max 320x320)...");
           processedData = Utils::ImageProcessor::ScaleAndCompressToWebP(binaryData, 320, 320, 75);
@@ -340,41 +592,165 @@ namespace Image2Card::UI
           AF_INFO("Image compressed: {} bytes -> {} bytes", binaryData.size(), processedData.size());
         }
 
-        std::string base64Data = Image2Card::Utils::Base64Utils::Encode(processedData);
+        // Media is uploaded together with the note when it is sent
+        note.media.push_back({uniqueFilename, std::move(processedData)});
 
-        if (m_AnkiConnectClient->StoreMediaFile(uniqueFilename, base64Data)) {
-          if (field->GetType() == CardFieldType::Image) {
-            fieldValue = "<img src=\"" + uniqueFilename + "\">";
-          } else if (field->GetType() == CardFieldType::Audio) {
-            fieldValue = "[sound:" + uniqueFilename + "]";
-          }
-        } else {
-          AF_ERROR("Failed to upload media file: {}", uniqueFilename);
-          continue;
+        if (field.type == CardFieldType::Image) {
+          fieldValue = "<img src=\"" + uniqueFilename + "\">";
+        } else if (field.type == CardFieldType::Audio) {
+          fieldValue = "[sound:" + uniqueFilename + "]";
         }
       }
 
       if (!fieldValue.empty()) {
-        fieldsMap[field->GetName()] = fieldValue;
+        note.fields[field.name] = fieldValue;
       }
     }
 
-    int64_t noteId = m_AnkiConnectClient->AddNote(deckName, modelName, fieldsMap, {"image2card"});
-    if (noteId > 0) {
-      m_LastCardId = noteId;
-      AF_INFO("Note added successfully. Card ID: {}", noteId);
-      if (m_OnStatusMessage)
-        m_OnStatusMessage("Note added successfully.");
+    return note;
+  }
+
+  void AnkiCardSettingsSection::ClearFields()
+  {
+    for (auto& field : m_Fields) {
+      field->SetValue("");
+      field->SetBinaryData({}, "");
+    }
+  }
 
-      for (auto& field : m_Fields) {
-        field->SetValue("");
-        field->SetBinaryData({}, "");
+  void AnkiCardSettingsSection::ClearCommittedFields()
+  {
+    // A scan that finished while the card was in flight may have filled fields for the next card; those stay.
+    for (auto& field : m_Fields) {
+      for (const auto& committed : m_CommittingFields) {
+        if (committed.name == field->GetName() && committed.value == field->GetValue() &&
+            committed.binaryData == field->GetBinaryData()) {
+          field->SetValue("");
+          field->SetBinaryData({}, "");
+          break;
+        }
       }
+    }
+    m_CommittingFields.clear();
+  }
+
+  void AnkiCardSettingsSection::PerformAdd(API::AnkiNote note)
+  {
+    ReportProgress(0.5f, "Uploading card...");
+    RunInBackground([this, note = std::move(note)](const Core::CancellationToken& cancellation) {
+      auto start = std::chrono::steady_clock::now();
+      API::AddNoteResult result = SendNote(note, cancellation);
+      double milliseconds =
+          std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+      m_Completions.Post([this, result, milliseconds]() { FinishAdd(result, milliseconds); });
+    });
+  }
+
+  void AnkiCardSettingsSection::FinishAdd(const API::AddNoteResult& result, double milliseconds)
+  {
+    if (result.Succeeded()) {
+      m_LastCardId = result.noteId;
+      AF_INFO("Note added in {:.0f} ms. Card ID: {}", milliseconds, result.noteId);
+      if (result.error.empty()) {
+        FinishRequest("Note added successfully.");
+      } else {
+        AF_WARN("Note {} is missing media: {}", result.noteId, result.error);
+        FinishRequest(result.error + ".");
+      }
+
+      ClearCommittedFields();
+
+      if (m_OnCardCommitted)
+        m_OnCardCommitted();
+    } else if (result.unreachable && m_OfflineOutbox) {
+      size_t queued = m_OfflineOutbox->GetPendingCount();
+      AF_WARN("AnkiConnect unreachable, card queued ({} waiting)", queued);
+      FinishRequest("Anki unreachable, card queued (" + std::to_string(queued) + " waiting).");
+
+      ClearCommittedFields();
+
+      if (m_OnCardCommitted)
+        m_OnCardCommitted();
     } else {
-      AF_ERROR("Failed to add note.");
-      if (m_OnStatusMessage)
-        m_OnStatusMessage("Failed to add note.");
+      AF_ERROR("Failed to add note: {}", result.error);
+      FinishRequest("Failed to add note.");
     }
   }
 
+  void AnkiCardSettingsSection::StageCard(API::AnkiNote note)
+  {
+    m_StagingOutbox->Stage(std::move(note));
+    size_t pending = m_StagingOutbox->GetPendingCount();
+    AF_INFO("Card staged, {} in outbox", pending);
+    FinishRequest("Card staged (" + std::to_string(pending) + " in outbox).");
+
+    ClearCommittedFields();
+
+    if (m_OnCardCommitted)
+      m_OnCardCommitted();
+  }
+
+  void AnkiCardSettingsSection::FlushOutbox()
+  {
+    if (m_Busy || !m_AnkiConnectClient || !m_StagingOutbox)
+      return;
+
+    m_Busy = true;
+    ReportProgress(0.0f, "Sending staged cards...");
+    RunInBackground([this](const Core::CancellationToken& cancellation) {
+      auto report = m_StagingOutbox->Flush(*m_AnkiConnectClient, cancellation);
+      m_Completions.Post([this, report = std::move(report)]() {
+        for (auto it = report.results.rbegin(); it != report.results.rend(); ++it) {
+          if (it->Succeeded()) {
+            m_LastCardId = it->noteId;
+            break;
+          }
+        }
+
+        std::string message = "Added " + std::to_string(report.added) + " staged card(s).";
+        if (report.rejected > 0) {
+          message += " Anki rejected " + std::to_string(report.rejected) + ": " + report.rejectedError + ".";
+        }
+        if (report.failed > report.rejected) {
+          message += " " + std::to_string(report.failed - report.rejected) + " could not be sent and remain staged.";
+        }
+        FinishRequest(message);
+      });
+    });
+  }
+
+  void AnkiCardSettingsSection::FinishRequest(const std::string& status)
+  {
+    m_Busy = false;
+    if (m_OnProgress)
+      m_OnProgress(-1.0f);
+    if (!status.empty() && m_OnStatusMessage)
+      m_OnStatusMessage(status);
+  }
+
+  void AnkiCardSettingsSection::RunInBackground(std::function<void(const Core::CancellationToken&)> work)
+  {
+    Core::CancellationToken cancellation = m_Cancellation.GetToken();
+    auto& executor = Core::TaskExecutor::Get();
+    m_Request = executor.Submit(Core::TaskPriority::Interactive, [this, work = std::move(work), cancellation]() {
+      try {
+        work(cancellation);
+      } catch (const std::exception& e) {
+        AF_ERROR("Anki request failed: {}", e.what());
+        m_Completions.Post([this]() { FinishRequest("Failed to send the card to Anki."); });
+      }
+    });
+  }
+
+  void AnkiCardSettingsSection::ReportProgress(float progress, const std::string& status)
+  {
+    // Called from the worker as well, so the callbacks run wherever Update runs.
+    m_Completions.Post([this, progress, status]() {
+      if (m_OnProgress)
+        m_OnProgress(progress);
+      if (m_OnStatusMessage)
+        m_OnStatusMessage(status);
+    });
+  }
+
 } // namespace Image2Card::UI
@@ -1,20 +1,22 @@
 #pragma once
 
 #include <functional>
+#include <future>
+#include <map>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
+#include "api/CardOutbox.h"
+#include "api/DuplicateIndex.h"
+#include "core/CancellationToken.h"
+#include "core/MainThreadDispatcher.h"
 #include "ui/UIComponent.h"
 #include "ui/fields/CardField.h"
 
 struct SDL_Renderer;
 
-namespace Image2Card::API
-{
-  class AnkiConnectClient;
-}
-
 namespace Image2Card::Config
 {
   class ConfigManager;
@@ -23,6 +25,12 @@ namespace Image2Card::Config
 namespace Image2Card::UI
 {
 
+  /**
+ * Fields of the card being edited, and the buttons that send it to Anki.
+ * Adding, staging and flushing run on the task executor: the fields are copied
+ * when a button is pressed, media is encoded and uploaded in the background,
+ * and the outcome is reported back on the main thread by Update().
+ */
   class AnkiCardSettingsSection : public UIComponent
   {
 public:
@@ -32,19 +40,77 @@ public:
                                      Config::ConfigManager* configManager);
     ~AnkiCardSettingsSection() override;
 
+    /**
+   * Run the main-thread continuations of finished background requests. Called once per frame.
+   */
+    void Update();
+
     void Render() override;
+
+    /**
+   * Fetch the decks, note types and fields from AnkiConnect in the background and
+   * apply them on a later Update. Main thread only.
+   */
     void RefreshData();
     void SetField(const std::string& name, const std::string& value);
     void SetFieldByTool(int toolIndex, const std::string& value);
     void SetFieldByTool(int toolIndex, const std::vector<unsigned char>& data, const std::string& filename);
 
     void SetOnStatusMessageCallback(std::function<void(const std::string&)> callback) { m_OnStatusMessage = callback; }
+    // Called when a card leaves the editor, either added to Anki or staged in the outbox.
+    void SetOnCardCommittedCallback(std::function<void()> callback) { m_OnCardCommitted = callback; }
+    // Answers duplicate checks locally when set; without it every check is a findNotes query.
+    void SetDuplicateIndex(API::DuplicateIndex* index) { m_DuplicateIndex = index; }
+    // Takes cards added while AnkiConnect does not answer; without it such an add just fails.
+    void SetOfflineOutbox(API::CardOutbox* outbox) { m_OfflineOutbox = outbox; }
+    // Holds staged cards until they are flushed; without it the Stage button is disabled.
+    void SetStagingOutbox(API::CardOutbox* outbox) { m_StagingOutbox = outbox; }
+    // Progress of the request in flight, 0 to 1, or -1 once it is done.
+    void SetOnProgressCallback(std::function<void(float)> callback) { m_OnProgress = callback; }
 
 private:
 
+    struct FieldSnapshot
+    {
+      std::string name;
+      std::string value;
+      std::vector<unsigned char> binaryData;
+      CardFieldType type = CardFieldType::Text;
+    };
+
+    // Copy of everything needed to build the note, so the worker never reads the live fields.
+    struct CardSnapshot
+    {
+      std::string deckName;
+      std::string modelName;
+      std::string duplicateQuery;                         // Empty when no field identifies the card
+      std::map<std::string, std::string> duplicateValues; // The identifying fields the query matches
+      std::vector<FieldSnapshot> fields;
+    };
+
+    void ApplyData(std::vector<std::string> noteTypes,
+                   std::vector<std::string> decks,
+                   const std::string& fieldsOf,
+                   std::vector<std::string> fieldNames);
+    void BuildFields(const std::string& noteType, const std::vector<std::string>& fieldNames);
     void RenderDuplicateModal();
-    void CheckDuplicatesAndAdd();
-    void PerformAdd();
+    void CheckDuplicatesAndAdd(bool stage);
+    size_t CountDuplicates(const CardSnapshot& card, const Core::CancellationToken& cancellation);
+    API::AddNoteResult SendNote(const API::AnkiNote& note, const Core::CancellationToken& cancellation);
+    void OnNotePrepared(API::AnkiNote note, size_t duplicates);
+    void CommitCard();
+    void PerformAdd(API::AnkiNote note);
+    void FinishAdd(const API::AddNoteResult& result, double milliseconds);
+    void StageCard(API::AnkiNote note);
+    void FlushOutbox();
+    void FinishRequest(const std::string& status);
+    void RunInBackground(std::function<void(const Core::CancellationToken&)> work);
+    void ReportProgress(float progress, const std::string& status);
+    static bool IsDuplicateCriterion(const CardField& field);
+    std::optional<CardSnapshot> SnapshotCard() const;
+    static API::AnkiNote PrepareNote(const CardSnapshot& card);
+    void ClearFields();
+    void ClearCommittedFields();
 
     // State
     int m_SelectedNoteTypeIndex = 0;
@@ -59,12 +125,29 @@ private:
     bool m_ShowDuplicateModal = false;
     bool m_OpenDuplicateModal = false;
     std::string m_DuplicateMessage;
+    bool m_StageAfterCheck = false;
+    std::optional<API::AnkiNote> m_PendingNote; // Prepared card held while the duplicate prompt is open
+    std::vector<FieldSnapshot> m_CommittingFields; // Field values of the card in flight, as they were snapshotted
+
+    // Background requests, one at a time. Continuations are queued by the worker and run in Update.
+    bool m_Busy = false;
+    std::future<void> m_Request;
+    std::future<void> m_DataRefresh;  // Fetches the lists for RefreshData
+    bool m_RefreshAgain = false;      // RefreshData was called while m_DataRefresh was running
+    std::future<void> m_IndexRefresh; // Brings the duplicate index up to date after RefreshData
+    Core::CancellationSource m_Cancellation;
+    Core::MainThreadDispatcher m_Completions;
 
     SDL_Renderer* m_Renderer;
     API::AnkiConnectClient* m_AnkiConnectClient;
+    API::DuplicateIndex* m_DuplicateIndex = nullptr;
+    API::CardOutbox* m_OfflineOutbox = nullptr;
+    API::CardOutbox* m_StagingOutbox = nullptr;
     Config::ConfigManager* m_ConfigManager;
 
     std::function<void(const std::string&)> m_OnStatusMessage;
+    std::function<void()> m_OnCardCommitted;
+    std::function<void(float)> m_OnProgress;
 
     int64_t m_LastCardId = 0;
   };
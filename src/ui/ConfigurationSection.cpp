@@ -3,13 +3,14 @@
 #include <imgui.h>
 #include <imgui_stdlib.h>
 
-#include <thread>
+#include <algorithm>
 
 #include "ai/IAudioAIProvider.h"
 #include "ai/ITextAIProvider.h"
 #include "api/AnkiConnectClient.h"
 #include "config/ConfigManager.h"
 #include "core/Logger.h"
+#include "core/TaskExecutor.h"
 #include "language/ILanguage.h"
 #include "language/services/ILanguageService.h"
 
@@ -55,12 +56,23 @@ namespace Image2Card::UI
       m_ConfigManager->Save();
     }
 
+    if (ImGui::Checkbox("Pass Media as Files", &config.AnkiLocalMediaPaths)) {
+      m_ConfigManager->Save();
+      if (m_AnkiConnectClient) {
+        m_AnkiConnectClient->SetLocalMediaPaths(config.AnkiLocalMediaPaths);
+      }
+    }
+    if (ImGui::IsItemHovered()) {
+      ImGui::SetTooltip("When Anki runs on this computer, let it read images and audio from temporary files\n"
+                        "instead of sending their data in the request.");
+    }
+
     ImGui::Spacing();
 
     if (ImGui::Button("Connect")) {
       m_AnkiConnectError.clear();
       if (m_AnkiConnectClient) {
-        std::thread([this, url = config.AnkiConnectUrl]() {
+        Core::TaskExecutor::Get().Post(Core::TaskPriority::Interactive, [this, url = config.AnkiConnectUrl]() {
           m_AnkiConnectClient->SetUrl(url);
           m_AnkiConnectConnected = m_AnkiConnectClient->Ping();
           if (m_AnkiConnectConnected) {
@@ -70,7 +82,7 @@ namespace Image2Card::UI
           } else {
             m_AnkiConnectError = "Connection failed. Ensure Anki is open and AnkiConnect is installed.";
           }
-        }).detach();
+        });
       }
     }
 
@@ -150,6 +162,7 @@ namespace Image2Card::UI
     bool isTesseract = (config.OCRMethod == "Tesseract");
     bool isNative = (config.OCRMethod == "Native");
     bool isAI = (config.OCRMethod == "AI");
+    bool isCascade = (config.OCRMethod == "Cascade");
 
 #ifdef __APPLE__
     if (ImGui::RadioButton("Native OS (macOS Vision Framework)", isNative)) {
@@ -173,15 +186,78 @@ namespace Image2Card::UI
       m_ConfigManager->Save();
     }
 
+    if (ImGui::RadioButton("Cascade (Tesseract, AI when unsure)", isCascade)) {
+      config.OCRMethod = "Cascade";
+      m_ConfigManager->Save();
+    }
+
+    ImGui::Spacing();
+    if (ImGui::Checkbox("Cache Results", &config.OCRCacheEnabled)) {
+      m_ConfigManager->Save();
+    }
+    if (ImGui::IsItemHovered()) {
+      ImGui::SetTooltip("Reuse the result when the same crop is scanned again with the same settings.");
+    }
+    if (config.OCRCacheEnabled) {
+      ImGui::SameLine();
+      int cacheSize = config.OCRCacheSizeMB;
+      ImGui::SetNextItemWidth(120);
+      if (ImGui::InputInt("Cache Size (MB)", &cacheSize)) {
+        config.OCRCacheSizeMB = std::clamp(cacheSize, 1, 1024);
+        m_ConfigManager->Save();
+      }
+      ImGui::SameLine();
+      if (ImGui::Button("Clear Cache") && m_OnClearOCRCacheCallback) {
+        m_OnClearOCRCacheCallback();
+      }
+      if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Forget every cached result, e.g. after updating Tesseract data or the vision model.");
+      }
+    }
+
     ImGui::Spacing();
 
-    if (isTesseract) {
+    if (isCascade) {
+      ImGui::Text("Escalation");
+      ImGui::Spacing();
+
+      ImGui::SetNextItemWidth(200);
+      if (ImGui::SliderFloat("Min Confidence", &config.CascadeMinConfidence, 0.0f, 100.0f, "%.0f")) {
+        m_ConfigManager->Save();
+      }
+      if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Regions whose mean Tesseract word confidence is below this are sent to the vision model.");
+      }
+
+      int hedgeDelay = config.CascadeHedgeDelayMs;
+      ImGui::SetNextItemWidth(120);
+      if (ImGui::InputInt("Hedge Delay (ms)", &hedgeDelay, 100)) {
+        config.CascadeHedgeDelayMs = std::clamp(hedgeDelay, 0, 10000);
+        m_ConfigManager->Save();
+      }
+      if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Start the vision model request if Tesseract is still running after this long.\n"
+                          "It is cancelled when Tesseract turns out confident. 0 waits for Tesseract.");
+      }
+      ImGui::Spacing();
+    }
+
+    if (isTesseract || isCascade) {
       ImGui::Text("Text Orientation");
       ImGui::Spacing();
 
+      bool isAuto = (config.TesseractOrientation == "auto");
       bool isHorizontal = (config.TesseractOrientation == "horizontal");
       bool isVertical = (config.TesseractOrientation == "vertical");
 
+      if (ImGui::RadioButton("Detect", isAuto)) {
+        config.TesseractOrientation = "auto";
+        m_ConfigManager->Save();
+      }
+      if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Detect the orientation of every region. Images can override it in the toolbar.");
+      }
+      ImGui::SameLine();
       if (ImGui::RadioButton("Horizontal", isHorizontal)) {
         config.TesseractOrientation = "horizontal";
         m_ConfigManager->Save();
@@ -191,9 +267,27 @@ namespace Image2Card::UI
         config.TesseractOrientation = "vertical";
         m_ConfigManager->Save();
       }
+
+      ImGui::Spacing();
+      if (ImGui::Checkbox("Preprocess Images", &config.TesseractPreprocess)) {
+        m_ConfigManager->Save();
+      }
+      if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Convert to grayscale, scale text to a readable size and binarize before OCR.");
+      }
+
+      int engineCount = config.TesseractEngineCount;
+      ImGui::SetNextItemWidth(120);
+      if (ImGui::InputInt("Parallel Engines", &engineCount)) {
+        config.TesseractEngineCount = std::clamp(engineCount, 0, 16);
+        m_ConfigManager->Save();
+      }
+      if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Regions recognized at once. 0 uses half the CPU threads. Applies after restart.");
+      }
     }
 
-    if (isAI) {
+    if (isAI || isCascade) {
       ImGui::Spacing();
       ImGui::Text("Vision Model");
       ImGui::Separator();
@@ -243,6 +337,14 @@ namespace Image2Card::UI
         }
         ImGui::EndCombo();
       }
+
+      ImGui::Spacing();
+      if (ImGui::Checkbox("Optimize Uploads", &config.AIUploadOptimize)) {
+        m_ConfigManager->Save();
+      }
+      if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Downscale crops to what the model reads and send them as WebP or JPEG instead of PNG.");
+      }
     }
   }
 
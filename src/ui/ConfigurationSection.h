@@ -63,6 +63,7 @@ public:
     {
       m_OnAudioProviderChangedCallback = callback;
     }
+    void SetOnClearOCRCacheCallback(std::function<void()> callback) { m_OnClearOCRCacheCallback = callback; }
 
     void SetAudioProvider(AI::IAudioAIProvider* provider) { m_AudioAIProvider = provider; }
 
@@ -89,6 +90,7 @@ private:
     std::function<void(const std::string&)> m_OnTranslatorChangedCallback;
     std::function<void()> m_OnNoteTypeOrDeckChangedCallback;
     std::function<void(const std::string&)> m_OnAudioProviderChangedCallback;
+    std::function<void()> m_OnClearOCRCacheCallback;
   };
 
 } // namespace Image2Card::UI
@@ -10,10 +10,18 @@
 
 #include <imgui.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
 #include "IconsFontAwesome6.h"
 #include "core/Logger.h"
 #include "core/sdl/SDLWrappers.h"
+#include "ocr/OrientationDetector.h"
+#include "ocr/TextRegionDetector.h"
 #include "stb_image_write.h"
+#include "utils/ImageProcessor.h"
+#include "utils/ReadingOrder.h"
 
 namespace Image2Card::UI
 {
@@ -26,12 +34,7 @@ namespace Image2Card::UI
       , m_Languages(languages)
       , m_ActiveLanguage(activeLanguage)
       , m_ConfigManager(configManager)
-  {
-    // Load tesseract orientation from config
-    if (m_ConfigManager) {
-      m_TesseractOrientation = m_ConfigManager->GetConfig().TesseractOrientation;
-    }
-  }
+  {}
 
   ImageSection::~ImageSection()
   {
@@ -81,6 +84,42 @@ namespace Image2Card::UI
     m_IsSelecting = false;
     m_SelectionStart = {0.0f, 0.0f};
     m_SelectionEnd = {0.0f, 0.0f};
+    m_Selections.clear();
+  }
+
+  void ImageSection::CommitSelection()
+  {
+    float x1 = std::min(m_SelectionStart.x, m_SelectionEnd.x);
+    float y1 = std::min(m_SelectionStart.y, m_SelectionEnd.y);
+    float x2 = std::max(m_SelectionStart.x, m_SelectionEnd.x);
+    float y2 = std::max(m_SelectionStart.y, m_SelectionEnd.y);
+    m_SelectionStart = {0.0f, 0.0f};
+    m_SelectionEnd = {0.0f, 0.0f};
+
+    // A click without a drag adds nothing; with no regions left the whole image is scanned.
+    if ((x2 - x1) < 1.0f || (y2 - y1) < 1.0f || m_CurrentImageIndex >= m_Images.size()) {
+      return;
+    }
+
+    const ImageData& image = m_Images[m_CurrentImageIndex];
+    float scaleX = (float) image.width / m_ImageScreenSize.x;
+    float scaleY = (float) image.height / m_ImageScreenSize.y;
+
+    Utils::Rect region;
+    region.x = std::max(0, (int) ((x1 - m_ImageScreenPos.x) * scaleX));
+    region.y = std::max(0, (int) ((y1 - m_ImageScreenPos.y) * scaleY));
+    region.width = std::min(image.width - region.x, (int) ((x2 - x1) * scaleX));
+    region.height = std::min(image.height - region.y, (int) ((y2 - y1) * scaleY));
+
+    if (!region.IsEmpty()) {
+      m_Selections.push_back(region);
+    }
+  }
+
+  ImVec2 ImageSection::ImageToScreen(const ImageData& image, float x, float y) const
+  {
+    return ImVec2(m_ImageScreenPos.x + x * m_ImageScreenSize.x / (float) image.width,
+                  m_ImageScreenPos.y + y * m_ImageScreenSize.y / (float) image.height);
   }
 
   void ImageSection::LoadImageFromFile(const std::string& path)
@@ -131,6 +170,52 @@ namespace Image2Card::UI
 
   void ImageSection::Update() {}
 
+  size_t ImageSection::DetectTextRegions()
+  {
+    if (m_Images.empty() || m_CurrentImageIndex >= m_Images.size())
+      return 0;
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<Utils::Rect> regions = OCR::TextRegionDetector::Detect(SurfaceView(m_Images[m_CurrentImageIndex]));
+    AF_INFO("Detected {} text region(s) in {} ms",
+            regions.size(),
+            std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
+
+    if (regions.empty())
+      return 0;
+
+    // Kept as ordinary selections, so the blocks are shown and can be adjusted before scanning again.
+    ClearSelection();
+    m_Selections = std::move(regions);
+    return m_Selections.size();
+  }
+
+  std::string ImageSection::GetTesseractOrientation() const
+  {
+    if (!m_Images.empty() && m_CurrentImageIndex < m_Images.size() &&
+        !m_Images[m_CurrentImageIndex].orientation.empty()) {
+      return m_Images[m_CurrentImageIndex].orientation;
+    }
+    return m_ConfigManager ? m_ConfigManager->GetConfig().TesseractOrientation : "auto";
+  }
+
+  bool ImageSection::IsVerticalText()
+  {
+    std::string orientation = GetTesseractOrientation();
+    if (orientation != "auto") {
+      return orientation == "vertical";
+    }
+    if (m_Images.empty() || m_CurrentImageIndex >= m_Images.size()) {
+      return false;
+    }
+
+    ImageData& image = m_Images[m_CurrentImageIndex];
+    if (!image.detectedVertical) {
+      image.detectedVertical = OCR::OrientationDetector::Detect(SurfaceView(image)).vertical;
+    }
+    return *image.detectedVertical;
+  }
+
   void ImageSection::Render()
   {
     ImGui::Begin("Image Section", nullptr, ImGuiWindowFlags_NoScrollbar);
@@ -159,46 +244,42 @@ namespace Image2Card::UI
     // Orientation buttons for Tesseract OCR
     if (m_ConfigManager) {
       auto& config = m_ConfigManager->GetConfig();
-      if (config.OCRMethod == "Tesseract") {
+      if (config.OCRMethod == "Tesseract" || config.OCRMethod == "Cascade") {
         ImGui::SameLine();
         ImGui::SetCursorPosX(ImGui::GetCursorPosX() + 20);
         ImGui::AlignTextToFramePadding();
         ImGui::TextDisabled("OCR:");
         ImGui::SameLine();
 
-        bool isHorizontal = (m_TesseractOrientation == "horizontal");
-        bool isVertical = (m_TesseractOrientation == "vertical");
+        // The buttons override the configured orientation for the current image only.
+        std::string orientation = GetTesseractOrientation();
+        ImageData* image = m_Images.empty() ? nullptr : &m_Images[m_CurrentImageIndex];
+        auto OrientationButton = [&](const char* icon, const char* value, const char* tooltip) {
+          bool active = (orientation == value);
+          if (active) {
+            ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.26f, 0.59f, 0.98f, 1.0f));
+          }
+          if (ImGui::Button(icon, ImVec2(30, 0)) && image) {
+            image->orientation = value;
+          }
+          if (active) {
+            ImGui::PopStyleColor();
+          }
+          if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("%s", tooltip);
+          }
+        };
 
-        if (isHorizontal) {
-          ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.26f, 0.59f, 0.98f, 1.0f));
-        }
-        if (ImGui::Button(ICON_FA_ARROWS_LEFT_RIGHT, ImVec2(30, 0))) {
-          m_TesseractOrientation = "horizontal";
-          config.TesseractOrientation = "horizontal";
-          m_ConfigManager->Save();
+        if (!image) {
+          ImGui::BeginDisabled();
         }
-        if (isHorizontal) {
-          ImGui::PopStyleColor();
-        }
-        if (ImGui::IsItemHovered()) {
-          ImGui::SetTooltip("Horizontal text");
-        }
-
+        OrientationButton(ICON_FA_COMPASS, "auto", "Detect orientation per region");
         ImGui::SameLine();
-
-        if (isVertical) {
-          ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.26f, 0.59f, 0.98f, 1.0f));
-        }
-        if (ImGui::Button(ICON_FA_ARROWS_UP_DOWN, ImVec2(30, 0))) {
-          m_TesseractOrientation = "vertical";
-          config.TesseractOrientation = "vertical";
-          m_ConfigManager->Save();
-        }
-        if (isVertical) {
-          ImGui::PopStyleColor();
-        }
-        if (ImGui::IsItemHovered()) {
-          ImGui::SetTooltip("Vertical text");
+        OrientationButton(ICON_FA_ARROWS_LEFT_RIGHT, "horizontal", "Horizontal text");
+        ImGui::SameLine();
+        OrientationButton(ICON_FA_ARROWS_UP_DOWN, "vertical", "Vertical text");
+        if (!image) {
+          ImGui::EndDisabled();
         }
       }
     }
@@ -239,7 +320,8 @@ namespace Image2Card::UI
 
       ImGui::Image((ImTextureID) currentImage->texture, imageSize);
 
-      m_ImageScreenPos = ImVec2(cursorX, cursorY);
+      // Mouse positions are in screen space, so map against the item rect rather than the window-local cursor.
+      m_ImageScreenPos = ImGui::GetItemRectMin();
       m_ImageScreenSize = imageSize;
 
       ImGuiIO& io = ImGui::GetIO();
@@ -247,6 +329,9 @@ namespace Image2Card::UI
       bool isHovered = ImGui::IsItemHovered();
 
       if (isHovered && ImGui::IsMouseClicked(ImGuiMouseButton_Left)) {
+        if (!io.KeyShift && !io.KeyCtrl) {
+          m_Selections.clear();
+        }
         m_IsSelecting = true;
         m_SelectionStart = mousePos;
         m_SelectionEnd = mousePos;
@@ -265,10 +350,31 @@ namespace Image2Card::UI
           m_SelectionEnd.y = m_ImageScreenPos.y + m_ImageScreenSize.y;
       } else if (m_IsSelecting && ImGui::IsMouseReleased(ImGuiMouseButton_Left)) {
         m_IsSelecting = false;
+        CommitSelection();
+      }
+
+      if (isHovered && !m_IsSelecting) {
+        ImGui::SetTooltip("Drag to select text, Shift+drag to add more regions");
+      }
+
+      ImDrawList* drawList = ImGui::GetWindowDrawList();
+
+      // Number the regions in the order they will be scanned.
+      auto order = Utils::ReadingOrder::Sort(m_Selections, IsVerticalText());
+      for (size_t position = 0; position < order.size(); ++position) {
+        const Utils::Rect& region = m_Selections[order[position]];
+        ImVec2 min = ImageToScreen(*currentImage, (float) region.x, (float) region.y);
+        ImVec2 max = ImageToScreen(*currentImage, (float) region.Right(), (float) region.Bottom());
+        drawList->AddRect(min, max, IM_COL32(0, 255, 0, 255), 0.0f, 0, 2.0f);
+        drawList->AddRectFilled(min, max, IM_COL32(0, 255, 0, 50));
+        if (order.size() > 1) {
+          std::string label = std::to_string(position + 1);
+          drawList->AddRectFilled(min, ImVec2(min.x + 18.0f, min.y + 18.0f), IM_COL32(0, 120, 0, 220));
+          drawList->AddText(ImVec2(min.x + 4.0f, min.y + 2.0f), IM_COL32(255, 255, 255, 255), label.c_str());
+        }
       }
 
       if (m_SelectionStart.x != m_SelectionEnd.x || m_SelectionStart.y != m_SelectionEnd.y) {
-        ImDrawList* drawList = ImGui::GetWindowDrawList();
         drawList->AddRect(m_SelectionStart, m_SelectionEnd, IM_COL32(0, 255, 0, 255), 0.0f, 0, 2.0f);
         drawList->AddRectFilled(m_SelectionStart, m_SelectionEnd, IM_COL32(0, 255, 0, 50));
       }
@@ -309,7 +415,18 @@ namespace Image2Card::UI
         AF_WARN("Scan requested (no callback)");
       }
     }
+    ImGui::SameLine();
+    if (ImGui::Button(ICON_FA_FILE_LINES " Scan Page", ImVec2(120, 0))) {
+      if (m_OnScanPageCallback) {
+        m_OnScanPageCallback();
+      } else {
+        AF_WARN("Page scan requested (no callback)");
+      }
+    }
     ImGui::PopStyleColor(3);
+    if (ImGui::IsItemHovered()) {
+      ImGui::SetTooltip("Find every speech bubble and caption on the page and scan them all");
+    }
 
     if (m_Images.size() > 1) {
       std::string countText = std::to_string(m_CurrentImageIndex + 1) + "/" + std::to_string(m_Images.size());
@@ -360,75 +477,78 @@ namespace Image2Card::UI
     ImGui::End();
   }
 
-  static void StbiWriteFunc(void* context, void* data, int size)
+  Utils::ImageView ImageSection::SurfaceView(const ImageData& image)
   {
-    auto* vec = static_cast<std::vector<unsigned char>*>(context);
-    const unsigned char* bytes = static_cast<const unsigned char*>(data);
-    vec->insert(vec->end(), bytes, bytes + size);
+    // Images are loaded as RGBA32; anything else is not read directly.
+    if (!image.surface || image.surface->format != SDL_PIXELFORMAT_RGBA32)
+      return {};
+
+    return {static_cast<const unsigned char*>(image.surface->pixels),
+            image.surface->w,
+            image.surface->h,
+            image.surface->pitch,
+            Utils::PixelFormat::RGBA32};
   }
 
-  std::vector<unsigned char> ImageSection::GetSelectedImageBytes()
+  Utils::ImageBuffer ImageSection::CropRegion(const ImageData& image, const Utils::Rect& region) const
   {
-    if (m_Images.empty() || m_CurrentImageIndex >= m_Images.size())
+    Utils::ImageView source = SurfaceView(image);
+    if (source.IsEmpty())
       return {};
 
-    ImageData& currentImg = m_Images[m_CurrentImageIndex];
-    if (!currentImg.surface)
+    int x0 = std::clamp(region.x, 0, source.width);
+    int y0 = std::clamp(region.y, 0, source.height);
+    int x1 = std::clamp(region.Right(), 0, source.width);
+    int y1 = std::clamp(region.Bottom(), 0, source.height);
+    if (x1 <= x0 || y1 <= y0)
       return {};
 
-    float x1 = std::min(m_SelectionStart.x, m_SelectionEnd.x);
-    float y1 = std::min(m_SelectionStart.y, m_SelectionEnd.y);
-    float x2 = std::max(m_SelectionStart.x, m_SelectionEnd.x);
-    float y2 = std::max(m_SelectionStart.y, m_SelectionEnd.y);
-
-    if ((x2 - x1) < 1.0f || (y2 - y1) < 1.0f) {
-      x1 = m_ImageScreenPos.x;
-      y1 = m_ImageScreenPos.y;
-      x2 = m_ImageScreenPos.x + m_ImageScreenSize.x;
-      y2 = m_ImageScreenPos.y + m_ImageScreenSize.y;
+    // Rows are copied straight out of the surface; nothing is encoded here.
+    Utils::ImageBuffer crop(x1 - x0, y1 - y0);
+    size_t rowBytes = (size_t) crop.Stride();
+    for (int y = 0; y < crop.height; ++y) {
+      std::memcpy(crop.Row(y), source.Row(y0 + y) + (size_t) x0 * 4, rowBytes);
     }
+    return crop;
+  }
 
-    float relX1 = x1 - m_ImageScreenPos.x;
-    float relY1 = y1 - m_ImageScreenPos.y;
-    float relX2 = x2 - m_ImageScreenPos.x;
-    float relY2 = y2 - m_ImageScreenPos.y;
-
-    float scaleX = (float) currentImg.width / m_ImageScreenSize.x;
-    float scaleY = (float) currentImg.height / m_ImageScreenSize.y;
-
-    SDL_Rect cropRect;
-    cropRect.x = (int) (relX1 * scaleX);
-    cropRect.y = (int) (relY1 * scaleY);
-    cropRect.w = (int) ((relX2 - relX1) * scaleX);
-    cropRect.h = (int) ((relY2 - relY1) * scaleY);
-
-    if (cropRect.x < 0)
-      cropRect.x = 0;
-    if (cropRect.y < 0)
-      cropRect.y = 0;
-    if (cropRect.x + cropRect.w > currentImg.width)
-      cropRect.w = currentImg.width - cropRect.x;
-    if (cropRect.y + cropRect.h > currentImg.height)
-      cropRect.h = currentImg.height - cropRect.y;
-
-    if (cropRect.w <= 0 || cropRect.h <= 0)
+  std::vector<unsigned char> ImageSection::GetSelectedImageBytes()
+  {
+    if (m_Images.empty() || m_CurrentImageIndex >= m_Images.size())
       return {};
 
-    auto croppedSurface = SDL::MakeSurface(cropRect.w, cropRect.h, currentImg.surface->format);
-    if (!croppedSurface)
-      return {};
+    const ImageData& currentImg = m_Images[m_CurrentImageIndex];
+    if (m_Selections.empty()) {
+      return Utils::ImageProcessor::EncodePNG(SurfaceView(currentImg));
+    }
+
+    auto order = Utils::ReadingOrder::Sort(m_Selections, IsVerticalText());
+    return Utils::ImageProcessor::EncodePNG(CropRegion(currentImg, m_Selections[order.front()]).View());
+  }
 
-    if (!SDL_BlitSurface(currentImg.surface, &cropRect, croppedSurface.get(), nullptr)) {
+  std::vector<Utils::ImageBuffer> ImageSection::GetSelectionImages(bool verticalText)
+  {
+    if (m_Images.empty() || m_CurrentImageIndex >= m_Images.size())
       return {};
-    }
 
-    std::vector<unsigned char> buffer;
+    const ImageData& currentImg = m_Images[m_CurrentImageIndex];
 
-    // We loaded the image as RGBA (4 channels)
-    stbi_write_png_to_func(
-        StbiWriteFunc, &buffer, croppedSurface->w, croppedSurface->h, 4, croppedSurface->pixels, croppedSurface->pitch);
+    std::vector<Utils::ImageBuffer> crops;
+    if (m_Selections.empty()) {
+      auto crop = CropRegion(currentImg, {0, 0, currentImg.width, currentImg.height});
+      if (!crop.IsEmpty()) {
+        crops.push_back(std::move(crop));
+      }
+      return crops;
+    }
 
-    return buffer;
+    for (size_t index : Utils::ReadingOrder::Sort(m_Selections, verticalText)) {
+      auto crop = CropRegion(currentImg, m_Selections[index]);
+      if (!crop.IsEmpty()) {
+        crops.push_back(std::move(crop));
+      }
+    }
+    return crops;
   }
 
   std::vector<unsigned char> ImageSection::GetFullImageBytes()
@@ -436,22 +556,7 @@ namespace Image2Card::UI
     if (m_Images.empty() || m_CurrentImageIndex >= m_Images.size())
       return {};
 
-    ImageData& currentImg = m_Images[m_CurrentImageIndex];
-    if (!currentImg.surface)
-      return {};
-
-    std::vector<unsigned char> buffer;
-
-    // We loaded the image as RGBA (4 channels)
-    stbi_write_png_to_func(StbiWriteFunc,
-                           &buffer,
-                           currentImg.surface->w,
-                           currentImg.surface->h,
-                           4,
-                           currentImg.surface->pixels,
-                           currentImg.surface->pitch);
-
-    return buffer;
+    return Utils::ImageProcessor::EncodePNG(SurfaceView(m_Images[m_CurrentImageIndex]));
   }
 
 } // namespace Image2Card::UI
@@ -4,10 +4,13 @@
 
 #include <functional>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
 #include "ui/UIComponent.h"
+#include "utils/ImageView.h"
+#include "utils/Rect.h"
 
 struct SDL_Texture;
 struct SDL_Renderer;
@@ -32,6 +35,8 @@ namespace Image2Card::UI
     SDL_Surface* surface = nullptr;
     int width = 0;
     int height = 0;
+    std::string orientation;              // "auto", "horizontal" or "vertical"; empty follows the config
+    std::optional<bool> detectedVertical; // Orientation detected on the whole image, for reading order
   };
 
   class ImageSection : public UIComponent
@@ -48,44 +53,80 @@ public:
     void Update() override;
 
     void SetOnScanCallback(std::function<void()> callback) { m_OnScanCallback = callback; }
+    void SetOnScanPageCallback(std::function<void()> callback) { m_OnScanPageCallback = callback; }
 
     void LoadImageFromFile(const std::string& path);
+
+    /**
+   * PNG of the first selection in reading order, or of the whole image if nothing is selected.
+   */
     std::vector<unsigned char> GetSelectedImageBytes();
+
+    /**
+   * Raw RGBA pixels of each selection rectangle, in reading order, or of the whole image
+   * if nothing is selected. Nothing is encoded, so OCR engines can read the pixels directly.
+   * @param verticalText Order columns right to left (manga) instead of left to right
+   */
+    std::vector<Utils::ImageBuffer> GetSelectionImages(bool verticalText);
+
     std::vector<unsigned char> GetFullImageBytes();
 
+    [[nodiscard]] size_t GetSelectionCount() const { return m_Selections.size(); }
+
+    /**
+   * Replace the selections with the text blocks (speech bubbles, captions) found on the
+   * current image, so a whole page can be scanned in one go.
+   * @return Number of blocks found
+   */
+    size_t DetectTextRegions();
+
 private:
 
     void ClearImages();
     void RemoveCurrentImage();
     void ClearSelection();
+    void CommitSelection();
+    static Utils::ImageView SurfaceView(const ImageData& image);
+    Utils::ImageBuffer CropRegion(const ImageData& image, const Utils::Rect& region) const;
+    ImVec2 ImageToScreen(const ImageData& image, float x, float y) const;
 
     SDL_Renderer* m_Renderer;
 
     std::vector<ImageData> m_Images;
     size_t m_CurrentImageIndex = 0;
 
-    // Cropping State
+    // Cropping State: the rectangle being dragged (screen coordinates) and the
+    // finished ones (image pixels). Shift or Ctrl while dragging adds a rectangle.
     bool m_IsSelecting = false;
     ImVec2 m_SelectionStart = {0.0f, 0.0f};
     ImVec2 m_SelectionEnd = {0.0f, 0.0f};
+    std::vector<Utils::Rect> m_Selections;
 
     // Screen coordinates of the image for mapping mouse clicks
     ImVec2 m_ImageScreenPos = {0.0f, 0.0f};
     ImVec2 m_ImageScreenSize = {0.0f, 0.0f};
 
     std::function<void()> m_OnScanCallback;
+    std::function<void()> m_OnScanPageCallback;
 
     // Language System
     std::vector<std::unique_ptr<Language::ILanguage>>* m_Languages;
     Language::ILanguage** m_ActiveLanguage;
     Config::ConfigManager* m_ConfigManager;
 
-    // Tesseract Orientation
-    std::string m_TesseractOrientation = "horizontal";
-
 public:
 
-    std::string GetTesseractOrientation() const { return m_TesseractOrientation; }
+    /**
+   * Orientation for the current image: its own override, or the configured default.
+   * @return "auto", "horizontal" or "vertical"
+   */
+    std::string GetTesseractOrientation() const;
+
+    /**
+   * Whether the current image's regions are read as vertical text (right to left
+   * columns). With "auto" this is detected once on the whole image.
+   */
+    bool IsVerticalText();
   };
 
 } // namespace Image2Card::UI
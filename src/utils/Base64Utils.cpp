@@ -1,5 +1,7 @@
 #include "utils/Base64Utils.h"
 
+#include "core/Trace.h"
+
 namespace Image2Card::Utils
 {
 
@@ -14,6 +16,7 @@ namespace Image2Card::Utils
 
   std::string Base64Utils::Encode(const std::vector<unsigned char>& data)
   {
+    AF_TRACE_SCOPE("base64", "Base64 encode");
     std::string ret;
     int i = 0;
     int j = 0;
@@ -57,6 +60,7 @@ namespace Image2Card::Utils
 
   std::vector<unsigned char> Base64Utils::Decode(const std::string& encoded_string)
   {
+    AF_TRACE_SCOPE("base64", "Base64 decode");
     size_t in_len = encoded_string.size();
     int i = 0;
     int j = 0;
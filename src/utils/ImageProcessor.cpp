@@ -11,6 +11,7 @@
 
 #define STB_IMAGE_RESIZE_IMPLEMENTATION
 #include "core/Logger.h"
+#include "core/Trace.h"
 #include "core/sdl/SDLWrappers.h"
 #include "stb_image_resize2.h"
 
@@ -19,6 +20,7 @@ namespace Image2Card::Utils
 
   SDL_Surface* ImageProcessor::LoadImageFromBuffer(const std::vector<unsigned char>& imageBuffer)
   {
+    AF_TRACE_SCOPE("webp", "Image decode");
     if (imageBuffer.empty()) {
       AF_ERROR("Image buffer is empty");
       return nullptr;
@@ -75,6 +77,7 @@ namespace Image2Card::Utils
 
   std::vector<unsigned char> ImageProcessor::SurfaceToWebP(SDL_Surface* surface, int qualityPercent)
   {
+    AF_TRACE_SCOPE("webp", "WebP encode");
     if (!surface) {
       AF_ERROR("Surface is null");
       return {};
@@ -177,4 +180,134 @@ namespace Image2Card::Utils
     return result;
   }
 
+  std::vector<unsigned char> ImageProcessor::EncodePNG(const ImageView& image)
+  {
+    AF_TRACE_SCOPE("image", "PNG encode");
+    if (image.IsEmpty()) {
+      AF_ERROR("Image to encode is empty");
+      return {};
+    }
+
+    std::vector<unsigned char> buffer;
+    auto write = [](void* context, void* data, int size) {
+      auto* out = static_cast<std::vector<unsigned char>*>(context);
+      const auto* bytes = static_cast<const unsigned char*>(data);
+      out->insert(out->end(), bytes, bytes + size);
+    };
+
+    if (!stbi_write_png_to_func(
+            write, &buffer, image.width, image.height, BytesPerPixel(image.format), image.data, image.stride)) {
+      AF_ERROR("Failed to encode {}x{} image as PNG", image.width, image.height);
+      return {};
+    }
+    return buffer;
+  }
+
+  std::vector<unsigned char> ImageProcessor::EncodeWebP(const ImageView& image, int qualityPercent)
+  {
+    AF_TRACE_SCOPE("webp", "WebP encode");
+    if (image.IsEmpty() || image.format != PixelFormat::RGBA32) {
+      AF_ERROR("WebP encoding needs a non-empty RGBA image");
+      return {};
+    }
+
+    uint8_t* output = nullptr;
+    size_t outputSize =
+        WebPEncodeRGBA(image.data, image.width, image.height, image.stride, (float) qualityPercent, &output);
+    if (outputSize == 0) {
+      AF_ERROR("WebP encoding failed");
+      if (output)
+        WebPFree(output);
+      return {};
+    }
+
+    std::vector<unsigned char> result(output, output + outputSize);
+    WebPFree(output);
+    return result;
+  }
+
+  std::vector<unsigned char> ImageProcessor::EncodeJPEG(const ImageView& image, int qualityPercent)
+  {
+    AF_TRACE_SCOPE("image", "JPEG encode");
+    if (image.IsEmpty()) {
+      AF_ERROR("Image to encode is empty");
+      return {};
+    }
+
+    std::vector<unsigned char> buffer;
+    auto write = [](void* context, void* data, int size) {
+      auto* out = static_cast<std::vector<unsigned char>*>(context);
+      const auto* bytes = static_cast<const unsigned char*>(data);
+      out->insert(out->end(), bytes, bytes + size);
+    };
+
+    // stb writes JPEG from tightly packed rows only.
+    int bytesPerPixel = BytesPerPixel(image.format);
+    std::vector<unsigned char> packed;
+    const unsigned char* pixels = image.data;
+    if (image.stride != image.width * bytesPerPixel) {
+      size_t rowBytes = (size_t) image.width * bytesPerPixel;
+      packed.resize(rowBytes * image.height);
+      for (int y = 0; y < image.height; ++y) {
+        std::memcpy(packed.data() + rowBytes * y, image.Row(y), rowBytes);
+      }
+      pixels = packed.data();
+    }
+
+    if (!stbi_write_jpg_to_func(write, &buffer, image.width, image.height, bytesPerPixel, pixels, qualityPercent)) {
+      AF_ERROR("Failed to encode {}x{} image as JPEG", image.width, image.height);
+      return {};
+    }
+    return buffer;
+  }
+
+  ImageBuffer ImageProcessor::DownscaleToFit(const ImageView& image, int maxDimension)
+  {
+    AF_TRACE_SCOPE("image", "Downscale");
+    if (image.IsEmpty() || image.format != PixelFormat::RGBA32 ||
+        (image.width <= maxDimension && image.height <= maxDimension)) {
+      return {};
+    }
+
+    int newWidth{}, newHeight{};
+    CalculateScaledDimensions(image.width, image.height, maxDimension, maxDimension, newWidth, newHeight);
+
+    ImageBuffer scaled(newWidth, newHeight);
+    if (!stbir_resize_uint8_srgb(image.data,
+                                 image.width,
+                                 image.height,
+                                 image.stride,
+                                 scaled.pixels.data(),
+                                 newWidth,
+                                 newHeight,
+                                 scaled.Stride(),
+                                 STBIR_RGBA)) {
+      AF_ERROR("Failed to downscale {}x{} image to {}x{}", image.width, image.height, newWidth, newHeight);
+      return {};
+    }
+    return scaled;
+  }
+
+  ImageBuffer ImageProcessor::Decode(const std::vector<unsigned char>& imageBuffer)
+  {
+    AF_TRACE_SCOPE("image", "Image decode");
+    if (imageBuffer.empty()) {
+      AF_ERROR("Image buffer is empty");
+      return {};
+    }
+
+    int width{}, height{}, channels{};
+    unsigned char* data =
+        stbi_load_from_memory(imageBuffer.data(), (int) imageBuffer.size(), &width, &height, &channels, 4);
+    if (!data) {
+      AF_ERROR("Failed to load image from buffer: {}", stbi_failure_reason());
+      return {};
+    }
+
+    ImageBuffer image(width, height);
+    std::memcpy(image.pixels.data(), data, image.pixels.size());
+    stbi_image_free(data);
+    return image;
+  }
+
 } // namespace Image2Card::Utils
\ No newline at end of file
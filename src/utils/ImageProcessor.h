@@ -4,6 +4,8 @@
 #include <string>
 #include <vector>
 
+#include "utils/ImageView.h"
+
 struct SDL_Surface;
 
 namespace Image2Card::Utils
@@ -36,6 +38,43 @@ public:
     static std::vector<unsigned char> CompressToWebP(const std::vector<unsigned char>& imageBuffer,
                                                      int qualityPercent = 75);
 
+    /**
+     * Encode raw pixels as PNG, for consumers that need compressed bytes (AI OCR, card images)
+     * @param image Pixels to encode
+     * @return PNG file contents, empty on failure
+     */
+    static std::vector<unsigned char> EncodePNG(const ImageView& image);
+
+    /**
+     * Encode raw RGBA pixels as lossy WebP
+     * @param image Pixels to encode
+     * @param qualityPercent Quality for WebP compression (1-100)
+     * @return WebP file contents, empty on failure
+     */
+    static std::vector<unsigned char> EncodeWebP(const ImageView& image, int qualityPercent);
+
+    /**
+     * Encode raw pixels as JPEG, for consumers that do not accept WebP
+     * @param image Pixels to encode
+     * @param qualityPercent JPEG quality (1-100)
+     * @return JPEG file contents, empty on failure
+     */
+    static std::vector<unsigned char> EncodeJPEG(const ImageView& image, int qualityPercent);
+
+    /**
+     * Downscale so the longer side is at most maxDimension, maintaining aspect ratio
+     * @param image RGBA pixels to scale
+     * @param maxDimension Upper bound for width and height
+     * @return Scaled copy, or an empty buffer if the image already fits or could not be scaled
+     */
+    static ImageBuffer DownscaleToFit(const ImageView& image, int maxDimension);
+
+    /**
+     * Decode an image file (PNG, JPEG, ...) to RGBA pixels
+     * @return Decoded pixels, empty on failure
+     */
+    static ImageBuffer Decode(const std::vector<unsigned char>& imageBuffer);
+
 private:
 
     /**
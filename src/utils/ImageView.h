@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace Image2Card::Utils
+{
+
+  enum class PixelFormat
+  {
+    RGBA32, // 4 bytes per pixel, R G B A in memory order
+    Gray8
+  };
+
+  [[nodiscard]] inline int BytesPerPixel(PixelFormat format)
+  {
+    return format == PixelFormat::RGBA32 ? 4 : 1;
+  }
+
+  /**
+   * Non-owning view of uncompressed pixels. Rows are stride bytes apart.
+   */
+  struct ImageView
+  {
+    const unsigned char* data = nullptr;
+    int width = 0;
+    int height = 0;
+    int stride = 0;
+    PixelFormat format = PixelFormat::RGBA32;
+
+    [[nodiscard]] bool IsEmpty() const { return !data || width <= 0 || height <= 0; }
+    [[nodiscard]] const unsigned char* Row(int y) const { return data + (size_t) y * stride; }
+  };
+
+  /**
+   * Uncompressed pixels with tightly packed rows.
+   */
+  struct ImageBuffer
+  {
+    std::vector<unsigned char> pixels;
+    int width = 0;
+    int height = 0;
+    PixelFormat format = PixelFormat::RGBA32;
+
+    ImageBuffer() = default;
+    ImageBuffer(int w, int h, PixelFormat pixelFormat = PixelFormat::RGBA32)
+        : pixels((size_t) w * h * BytesPerPixel(pixelFormat))
+        , width(w)
+        , height(h)
+        , format(pixelFormat)
+    {}
+
+    [[nodiscard]] bool IsEmpty() const { return pixels.empty(); }
+    [[nodiscard]] int Stride() const { return width * BytesPerPixel(format); }
+    [[nodiscard]] unsigned char* Row(int y) { return pixels.data() + (size_t) y * Stride(); }
+    [[nodiscard]] ImageView View() const { return {pixels.data(), width, height, Stride(), format}; }
+  };
+
+} // namespace Image2Card::Utils
@@ -0,0 +1,39 @@
+#include "utils/ReadingOrder.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace Image2Card::Utils
+{
+
+  std::vector<size_t> ReadingOrder::Sort(const std::vector<Rect>& regions, bool verticalText)
+  {
+    std::vector<size_t> byTop(regions.size());
+    std::iota(byTop.begin(), byTop.end(), 0);
+    std::stable_sort(
+        byTop.begin(), byTop.end(), [&regions](size_t a, size_t b) { return regions[a].y < regions[b].y; });
+
+    std::vector<size_t> order;
+    order.reserve(regions.size());
+
+    size_t tierStart = 0;
+    while (tierStart < byTop.size()) {
+      int tierBottom = regions[byTop[tierStart]].Bottom();
+      size_t tierEnd = tierStart + 1;
+      while (tierEnd < byTop.size() && regions[byTop[tierEnd]].CenterY() < tierBottom) {
+        tierBottom = std::max(tierBottom, regions[byTop[tierEnd]].Bottom());
+        ++tierEnd;
+      }
+
+      std::stable_sort(byTop.begin() + tierStart, byTop.begin() + tierEnd, [&](size_t a, size_t b) {
+        return verticalText ? regions[a].CenterX() > regions[b].CenterX()
+                            : regions[a].CenterX() < regions[b].CenterX();
+      });
+      order.insert(order.end(), byTop.begin() + tierStart, byTop.begin() + tierEnd);
+      tierStart = tierEnd;
+    }
+
+    return order;
+  }
+
+} // namespace Image2Card::Utils
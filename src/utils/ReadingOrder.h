@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "utils/Rect.h"
+
+namespace Image2Card::Utils
+{
+
+  class ReadingOrder
+  {
+public:
+
+    /**
+     * Order text regions (e.g. speech bubbles) the way a reader would visit them.
+     * Regions are grouped into tiers from top to bottom; a region joins a tier when
+     * its vertical center lies within the tier. Within a tier, vertical text is read
+     * right to left (manga) and horizontal text left to right.
+     * @param regions Regions in any order
+     * @param verticalText Whether the text is written in vertical columns
+     * @return Indices into regions in reading order
+     */
+    static std::vector<size_t> Sort(const std::vector<Rect>& regions, bool verticalText);
+  };
+
+} // namespace Image2Card::Utils
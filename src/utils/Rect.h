@@ -0,0 +1,23 @@
+#pragma once
+
+namespace Image2Card::Utils
+{
+
+  /**
+   * Axis-aligned rectangle in image pixels.
+   */
+  struct Rect
+  {
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+
+    [[nodiscard]] bool IsEmpty() const { return width <= 0 || height <= 0; }
+    [[nodiscard]] int Right() const { return x + width; }
+    [[nodiscard]] int Bottom() const { return y + height; }
+    [[nodiscard]] float CenterX() const { return x + width * 0.5f; }
+    [[nodiscard]] float CenterY() const { return y + height * 0.5f; }
+  };
+
+} // namespace Image2Card::Utils